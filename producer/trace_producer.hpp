@@ -0,0 +1,560 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX 1
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <intrin.h>
+#include <process.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#include "framing.hpp"
+#include "spsc_ring.hpp"
+#include "wire_binary.hpp"
+
+// =============== Producer instrumentation (header-only) ===============
+// Emits spans to trace_viewer over the live protocol UdpClient speaks:
+//   DISCOVER_DEMO -> OFFER port=.. name=.. proto=bin1
+//   PING <id>[ proto=bin1] -> PONG <id>[ proto=bin1] t2=.. t3=..   (clock sync stamps)
+//   data: framed (framing.hpp) bin1 (wire_binary.hpp) or JSON batches
+//
+//   tracer::Config cfg; cfg.port = 9000; cfg.name = "game";
+//   tracer::start(cfg);
+//   { TRACE_SCOPE("update", "frame"); ... }
+//   tracer::stop();
+//
+// Async operations (coroutines, asio handler chains): a tracer::AsyncSpan gets a process
+// unique id and sends one fragment per active slice, the viewer stitches them back into
+// one track by id (suspended time = gaps between fragments):
+//   asio::awaitable<void> session(tcp::socket sock)
+//   {
+//       tracer::AsyncSpan op("session", "net");
+//       for (;;)
+//       {
+//           size_t n = TRACE_CO_AWAIT(op, sock.async_read_some(buf, asio::use_awaitable));
+//           ...
+//       }
+//   }
+//
+// Hot path: two timestamps (rdtsc on x86-64, steady_clock elsewhere or with
+// TRACER_NO_RDTSC) and a push into a per-thread SPSC ring; no lock, no allocation,
+// no syscall. A background thread drains the rings, converts the ticks to wall clock
+// microseconds, batches into datagrams and answers discovery / PINGs. A full ring
+// drops the span and counts it.
+// name / cat are kept by pointer: they must outlive the flush (string literals).
+namespace tracer
+{
+    /// @brief Config — class/struct documentation.
+    struct Config
+    {
+        uint16_t    port = 9000;                        // in the viewer scan range
+        std::string name = "producer";
+        size_t      threadCapacity = 1u << 16;          // spans per thread ring
+        size_t      batchBytes = 32 * 1024;             // message size before flush
+        size_t      datagram = framing::kDefaultDatagram;
+        uint32_t    flushIntervalMs = 5;
+        uint64_t    clientTimeoutUs = 5'000'000;        // no PING for that long: stop sending
+        bool        allowBinary = true;                 // false: JSON only
+    };
+
+    /// @brief Stats — class/struct documentation.
+    struct Stats
+    {
+        uint64_t spans = 0;       // drained from the thread rings
+        uint64_t sent = 0;        // spans sent to a viewer
+        uint64_t dropped = 0;     // thread ring full
+        uint64_t datagrams = 0;
+        uint64_t bytes = 0;
+        bool     connected = false;
+    };
+
+    // ---------- clock ----------
+    // raw ticks on the hot path, converted by the flusher
+    inline uint64_t ticks()
+    {
+#if !defined(TRACER_NO_RDTSC) && (defined(__x86_64__) || defined(_M_X64))
+        return __rdtsc();
+#else
+        return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    namespace detail
+    {
+        /// @brief SpanRecord — class/struct documentation.
+        struct SpanRecord
+        {
+            const char* name;
+            const char* cat;
+            uint64_t    start;   // ticks
+            uint64_t    end;
+            uint64_t    id;
+        };
+
+        /// @brief ThreadBuffer — class/struct documentation.
+        struct ThreadBuffer
+        {
+            explicit ThreadBuffer(size_t capacity, uint32_t t) : ring(capacity), tid(t) {}
+            SpscRing<SpanRecord>  ring;
+            uint32_t              tid;
+            std::atomic<uint64_t> dropped{ 0 };
+            std::atomic<bool>     exited{ false };
+        };
+
+        // ticks -> wall clock us since epoch (viewer "ts" base); rescaled as time goes on
+        class TickClock
+        {
+        public:
+            void calibrate()
+            {
+                using namespace std::chrono;
+                _t0 = ticks();
+                _s0 = steady_clock::now();
+                _epoch0Us = double(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+                // ~2 ms of spin for a first ratio, refined by refine()
+                while (steady_clock::now() - _s0 < milliseconds(2)) {}
+                refine();
+            }
+            void refine()
+            {
+                using namespace std::chrono;
+                const uint64_t t = ticks();
+                const double us = duration<double, std::micro>(steady_clock::now() - _s0).count();
+                if (t > _t0 && us > 0.0) _usPerTick = us / double(t - _t0);
+            }
+            uint64_t toEpochUs(uint64_t t) const
+            {
+                const double dt = (double(int64_t(t - _t0))) * _usPerTick;
+                return uint64_t(_epoch0Us + dt);
+            }
+            double usPerTick() const { return _usPerTick; }
+
+        private:
+            uint64_t _t0 = 0;
+            std::chrono::steady_clock::time_point _s0{};
+            double _epoch0Us = 0.0;
+            double _usPerTick = 1e-3;
+        };
+
+        inline uint64_t wall_us()
+        {
+            using namespace std::chrono;
+            return uint64_t(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+        }
+    }
+
+    // =============== Tracer ===============
+    class Tracer
+    {
+    public:
+        static Tracer& instance()
+        {
+            static Tracer t;
+            return t;
+        }
+        ~Tracer() { stop(); }
+
+        bool start(const Config& cfg, std::string* err = nullptr)
+        {
+            if (_active.load(std::memory_order_relaxed)) return true;
+            _cfg = cfg;
+#ifdef _WIN32
+            WSADATA w{};
+            if (WSAStartup(MAKEWORD(2, 2), &w) != 0) { if (err) *err = "WSAStartup failed"; return false; }
+#endif
+            _sock = ::socket(AF_INET, SOCK_DGRAM, 0);
+            int yes = 1;
+            setsockopt(_sock, SOL_SOCKET, SO_REUSEADDR, (char*)&yes, sizeof(yes));
+            sockaddr_in local{};
+            local.sin_family = AF_INET;
+            local.sin_port = htons(_cfg.port);
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+            if (bind(_sock, (sockaddr*)&local, sizeof(local)) < 0)
+            {
+                closeSocket_();
+                if (err) *err = "Unable to bind udp/" + std::to_string(_cfg.port);
+                return false;
+            }
+#ifdef _WIN32
+            _pid = uint32_t(_getpid());
+#else
+            _pid = uint32_t(::getpid());
+#endif
+            _session = uint32_t(detail::wall_us() * 2654435761u) ^ _pid;
+            _clock.calibrate();
+            _running.store(true);
+            _active.store(true, std::memory_order_release);
+            _thread = std::thread([this] { run_(); });
+            return true;
+        }
+
+        void stop()
+        {
+            if (!_running.exchange(false)) return;
+            _active.store(false, std::memory_order_relaxed);
+            if (_thread.joinable()) _thread.join();
+            closeSocket_();
+        }
+
+        bool active() const { return _active.load(std::memory_order_relaxed); }
+
+        Stats stats() const
+        {
+            Stats s;
+            s.spans = _spans.load(std::memory_order_relaxed);
+            s.sent = _sent.load(std::memory_order_relaxed);
+            s.datagrams = _datagrams.load(std::memory_order_relaxed);
+            s.bytes = _bytes.load(std::memory_order_relaxed);
+            s.connected = _connected.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lk(_mtx);
+            s.dropped = _droppedExited;
+            for (const auto& b : _buffers) s.dropped += b->dropped.load(std::memory_order_relaxed);
+            return s;
+        }
+
+        // hot path
+        void record(const char* name, const char* cat, uint64_t start, uint64_t end, uint64_t id)
+        {
+            detail::ThreadBuffer* b = t_buffer;
+            if (!b) [[unlikely]] b = attach_();
+            if (!b->ring.try_push(detail::SpanRecord{ name, cat, start, end, id })) [[unlikely]]
+                b->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+    private:
+        Tracer() = default;
+
+        // ---------- thread registration (first span of a thread) ----------
+        /// @brief ThreadExit — class/struct documentation.
+        struct ThreadExit
+        {
+            std::shared_ptr<detail::ThreadBuffer> buf;
+            ~ThreadExit() { if (buf) buf->exited.store(true, std::memory_order_release); t_buffer = nullptr; }
+        };
+        static inline thread_local detail::ThreadBuffer* t_buffer = nullptr;
+
+        detail::ThreadBuffer* attach_()
+        {
+            static thread_local ThreadExit exitHook;
+            std::lock_guard<std::mutex> lk(_mtx);
+            exitHook.buf = std::make_shared<detail::ThreadBuffer>(_cfg.threadCapacity, ++_nextTid);
+            _buffers.push_back(exitHook.buf);
+            t_buffer = exitHook.buf.get();
+            return t_buffer;
+        }
+
+        // ---------- flusher ----------
+        void run_()
+        {
+            wire::Encoder enc{ _session };
+            std::string json;
+            size_t pending = 0;
+            std::vector<std::shared_ptr<detail::ThreadBuffer>> buffers;
+            auto lastRefine = std::chrono::steady_clock::now();
+
+            auto begin = [&] {
+                pending = 0;
+                if (_binary) enc.begin();
+                else json = "[";
+            };
+            auto flush = [&] {
+                if (!pending) return;
+                std::string_view msg;
+                if (_binary) msg = enc.finish();
+                else { json.back() = ']'; msg = json; }
+                framing::fragment(_session, _seq++, msg, _cfg.datagram, [&](const char* p, size_t n) {
+                    sendto(_sock, p, (int)n, 0, (sockaddr*)&_client, sizeof(_client));
+                    _bytes.fetch_add(n, std::memory_order_relaxed);
+                    _datagrams.fetch_add(1, std::memory_order_relaxed);
+                });
+                begin();
+            };
+            begin();
+
+            for (bool last = false; !last;)
+            {
+                last = !_running.load();
+                if (!last) waitControl_(_cfg.flushIntervalMs);
+                if (handleControl_()) begin();
+                if (_haveClient && detail::wall_us() - _lastPingUs > _cfg.clientTimeoutUs)
+                {
+                    _haveClient = false;
+                    _connected.store(false, std::memory_order_relaxed);
+                }
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now - lastRefine >= std::chrono::seconds(1)) { _clock.refine(); lastRefine = now; }
+
+                {
+                    std::lock_guard<std::mutex> lk(_mtx);
+                    buffers = _buffers;
+                }
+                uint64_t drained = 0, sent = 0;
+                for (const auto& b : buffers)
+                {
+                    detail::SpanRecord r;
+                    const size_t avail = b->ring.size();
+                    for (size_t i = 0; i < avail && b->ring.try_pop(r); ++i)
+                    {
+                        ++drained;
+                        if (!_haveClient) continue;
+                        const uint64_t ts = _clock.toEpochUs(r.start);
+                        const uint64_t te = _clock.toEpochUs(r.end);
+                        const uint64_t dur = te > ts ? te - ts : 0;
+                        if (_binary)
+                            enc.event(r.name, r.cat, ts, dur, {}, {}, _pid, b->tid, r.id);
+                        else
+                            appendJson_(json, r, ts, dur, b->tid);
+                        ++pending;
+                        ++sent;
+                        if ((_binary ? enc.size() : json.size()) >= _cfg.batchBytes) flush();
+                    }
+                }
+                flush();
+                _spans.fetch_add(drained, std::memory_order_relaxed);
+                _sent.fetch_add(sent, std::memory_order_relaxed);
+                reapExited_();
+            }
+        }
+
+        void waitControl_(uint32_t timeoutMs)
+        {
+            fd_set rd;
+            FD_ZERO(&rd);
+            FD_SET(_sock, &rd);
+            timeval tv{ 0, long(timeoutMs) * 1000 };
+            select((int)_sock + 1, &rd, nullptr, nullptr, &tv);
+        }
+
+        // returns true when the encoding changed (pending batch restarted)
+        bool handleControl_()
+        {
+            bool restart = false;
+            char buf[1024];
+            for (;;)
+            {
+                sockaddr_in from{};
+                socklen_t fl = sizeof(from);
+#ifdef _WIN32
+                u_long avail = 0;
+                if (ioctlsocket(_sock, FIONREAD, &avail) != 0 || avail == 0) break;
+                const int r = recvfrom(_sock, buf, (int)sizeof(buf) - 1, 0, (sockaddr*)&from, &fl);
+#else
+                const int r = (int)recvfrom(_sock, buf, sizeof(buf) - 1, MSG_DONTWAIT, (sockaddr*)&from, &fl);
+#endif
+                if (r <= 0) break;
+                const uint64_t rxUs = detail::wall_us();
+                buf[r] = '\0';
+                std::string_view m(buf, size_t(r));
+                if (m.starts_with("DISCOVER_DEMO"))
+                {
+                    // built as a string: the name is the caller's, of any length
+                    std::string offer = "OFFER port=" + std::to_string(_cfg.port) + " name=" + _cfg.name;
+                    if (_cfg.allowBinary) offer += " proto=bin1";
+                    sendto(_sock, offer.data(), (int)offer.size(), 0, (sockaddr*)&from, fl);
+                }
+                else if (m.starts_with("PING"))
+                {
+                    const bool wantBin = _cfg.allowBinary && m.find(wire::kProtoTag) != std::string_view::npos;
+                    if (!_haveClient || wantBin != _binary)
+                    {
+                        _binary = wantBin;
+                        restart = true;
+                    }
+                    _haveClient = true;
+                    _connected.store(true, std::memory_order_relaxed);
+                    _client = from;
+                    _lastPingUs = rxUs;
+                    unsigned ping = 0;
+                    std::sscanf(buf + 4, "%u", &ping);
+                    char pong[128];
+                    const int n = std::snprintf(pong, sizeof(pong), "PONG %u%s t2=%llu t3=%llu", ping, _binary ? " proto=bin1" : "",
+                        (unsigned long long)rxUs, (unsigned long long)detail::wall_us());
+                    sendto(_sock, pong, n, 0, (sockaddr*)&from, fl);
+                }
+            }
+            return restart;
+        }
+
+        void appendJson_(std::string& json, const detail::SpanRecord& r, uint64_t ts, uint64_t dur, uint32_t tid) const
+        {
+            char ev[384];
+            const int n = std::snprintf(ev, sizeof(ev), "{\"type\":\"event\",\"name\":\"%s\",\"cat\":\"%s\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":%u,\"id\":%llu},",
+                r.name ? r.name : "", r.cat ? r.cat : "", (unsigned long long)ts, (unsigned long long)dur, _pid, tid, (unsigned long long)r.id);
+            if (n > 0) json.append(ev, size_t(std::min<int>(n, int(sizeof(ev)) - 1)));
+        }
+
+        // buffers of exited threads go once drained
+        void reapExited_()
+        {
+            std::lock_guard<std::mutex> lk(_mtx);
+            std::erase_if(_buffers, [this](const std::shared_ptr<detail::ThreadBuffer>& b) {
+                if (!b->exited.load(std::memory_order_acquire) || b->ring.size() != 0) return false;
+                _droppedExited += b->dropped.load(std::memory_order_relaxed);
+                return true;
+            });
+        }
+
+        void closeSocket_()
+        {
+#ifdef _WIN32
+            if (_sock != INVALID_SOCKET) { closesocket(_sock); WSACleanup(); }
+            _sock = INVALID_SOCKET;
+#else
+            if (_sock >= 0) ::close(_sock);
+            _sock = -1;
+#endif
+        }
+
+    private:
+#ifdef _WIN32
+        SOCKET _sock = INVALID_SOCKET;
+#else
+        int _sock = -1;
+#endif
+        Config _cfg;
+        std::atomic<bool> _active{ false };
+        std::atomic<bool> _running{ false };
+        std::thread _thread;
+        detail::TickClock _clock;
+        uint32_t _pid = 0;
+        uint32_t _session = 0;
+        uint32_t _seq = 0;
+
+        mutable std::mutex _mtx;
+        std::vector<std::shared_ptr<detail::ThreadBuffer>> _buffers;
+        uint32_t _nextTid = 0;
+        uint64_t _droppedExited = 0;
+
+        // flusher thread only
+        bool _haveClient = false;
+        bool _binary = false;
+        sockaddr_in _client{};
+        uint64_t _lastPingUs = 0;
+
+        std::atomic<uint64_t> _spans{ 0 };
+        std::atomic<uint64_t> _sent{ 0 };
+        std::atomic<uint64_t> _datagrams{ 0 };
+        std::atomic<uint64_t> _bytes{ 0 };
+        std::atomic<bool> _connected{ false };
+    };
+
+    inline bool start(const Config& cfg = {}, std::string* err = nullptr) { return Tracer::instance().start(cfg, err); }
+    inline void stop() { Tracer::instance().stop(); }
+    inline Stats stats() { return Tracer::instance().stats(); }
+
+    // =============== Async span ===============
+    // Active from construction to destruction except between suspend() and resume(); each
+    // active slice is recorded as a span carrying id() (resumption may happen on another
+    // thread, the fragment then lands in that thread's buffer).
+    class AsyncSpan
+    {
+    public:
+        AsyncSpan(const char* name, const char* cat)
+            : _name(name), _cat(cat), _id(nextId())
+        {
+            resume();
+        }
+        ~AsyncSpan() { suspend(); }
+        AsyncSpan(const AsyncSpan&) = delete;
+        AsyncSpan& operator=(const AsyncSpan&) = delete;
+
+        // closes the current slice (before a co_await / when handing off to a callback)
+        void suspend()
+        {
+            if (_start)
+                Tracer::instance().record(_name, _cat, _start, ticks(), _id);
+            _start = 0;
+        }
+        // opens a new slice
+        void resume()
+        {
+            if (!_start && Tracer::instance().active())
+                _start = ticks();
+        }
+        uint64_t id() const { return _id; }
+
+        // suspended for the lifetime of the object (the full expression of a co_await)
+        /// @brief Suspension — class/struct documentation.
+        struct Suspension
+        {
+            explicit Suspension(AsyncSpan& op) : _op(op) { _op.suspend(); }
+            ~Suspension() { _op.resume(); }
+            Suspension(const Suspension&) = delete;
+            Suspension& operator=(const Suspension&) = delete;
+        private:
+            AsyncSpan& _op;
+        };
+
+        static uint64_t nextId()
+        {
+            static std::atomic<uint64_t> next{ 1 };
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+    private:
+        const char* _name;
+        const char* _cat;
+        uint64_t    _id;
+        uint64_t    _start = 0;
+    };
+
+    // =============== Span (RAII) ===============
+    class Span
+    {
+    public:
+        Span(const char* name, const char* cat, uint64_t id = 0)
+            : _name(name), _cat(cat), _id(id)
+        {
+            if (Tracer::instance().active()) [[likely]]
+                _start = ticks();
+        }
+        ~Span()
+        {
+            if (_start) [[likely]]
+                Tracer::instance().record(_name, _cat, _start, ticks(), _id);
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* _name;
+        const char* _cat;
+        uint64_t    _id;
+        uint64_t    _start = 0;
+    };
+}
+
+#define TRACER_CONCAT_(a, b) a##b
+#define TRACER_CONCAT(a, b) TRACER_CONCAT_(a, b)
+#define TRACE_SCOPE(name, cat) ::tracer::Span TRACER_CONCAT(tracer_span_, __LINE__){ name, cat }
+// co_await expr with op suspended until the coroutine resumes (the temporary lives until
+// the end of the full expression); evaluates to the co_await result, void included
+#define TRACE_CO_AWAIT(op, ...) (::tracer::AsyncSpan::Suspension{ op }, co_await (__VA_ARGS__))
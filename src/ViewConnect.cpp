@@ -148,7 +148,7 @@ void ConnectView::requestImmediateRefresh()
 
 void ConnectView::scan()
 {
-    std::vector<std::string> data;
+    std::vector<LivePayload> data;
     _client.tick(data);
 
     auto now = std::chrono::steady_clock::now();
@@ -210,6 +210,17 @@ void ConnectView::draw(ImVec2 available, OnConnect onConnect, OnUseFile onUseFil
         }
         ImGui::EndTable();
     }
+    // sharded services: every listed server in one merged live session
+    const auto listed = std::ranges::count_if(_servers, match);
+    ImGui::BeginDisabled(listed < 2);
+    char all[48];
+    std::snprintf(all, sizeof(all), "Connect all (%d)", int(listed));
+    if (ImGui::Button(all) && onConnect)
+    {
+        for (const auto& s : _servers | std::views::filter(match))
+            onConnect(s);
+    }
+    ImGui::EndDisabled();
 
     ImGui::Separator();
     ImGui::TextDisabled("Manual connection");
@@ -251,7 +262,7 @@ void ConnectView::draw(ImVec2 available, OnConnect onConnect, OnUseFile onUseFil
     ImGui::BeginChild("connect_right", ImVec2(rightW, avail.y), true);
 
     ImGui::TextUnformatted("File path");
-    ImGui::TextDisabled("Please enter file path or just drag and drop.");
+    ImGui::TextDisabled("Please enter file path or just drag and drop (.json trace, .tcap session capture).");
     ImGui::SetNextItemWidth(-120);
     ImGui::InputText("##filePath", _filePath, sizeof(_filePath));
     ImGui::SameLine();
@@ -276,6 +287,7 @@ void ConnectView::draw(ImVec2 available, OnConnect onConnect, OnUseFile onUseFil
     }
 
     auto [hovered, rect] = FancyDropZone("##drop_zone");
+    _dropHovered = hovered;
     for (int i = 0; i < 16; ++i) {
         if (auto dropped = dnd::pop()) {
             if (hovered) {
@@ -23,6 +23,8 @@ public:
 
     void draw(ImVec2 available, OnConnect onConnect, OnUseFile onUseFile);
     void requestImmediateRefresh();
+    // hovered drop zone (animated border)
+    bool animating() const { return _dropHovered; }
 private:
     void scan();
 private:
@@ -36,6 +38,7 @@ private:
     int     _manualPort;
     char    _filter[128];
     bool    _needImmediateRefresh;
+    bool    _dropHovered = false;
     char    _filePath[512];
     float   _splitRatio = 0.55f;
 };
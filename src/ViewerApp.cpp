@@ -1,12 +1,17 @@
 #include "ViewerApp.hpp"
 #include "parser.hpp"
-#include "color_helper.hpp"
 #include "utils.hpp"
+#include "kway_merge.hpp"
 #include <imgui_internal.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <filesystem>
+#include <fstream>
+#include <map>
 #include <regex>
 
 // === Local helpers (performance & dedup) =====================================
@@ -34,35 +39,6 @@ namespace
         return { tmin, tmax };
     }
 
-    /// Normalize [ts, ts+dur] to [0,1] range given absolute [tmin, tmax].
-    /// Precomputes inverse denominator to avoid divisions in loops.
-    template <class Range>
-    inline void normalizeEvents(Range& rng, std::uint64_t tmin, std::uint64_t tmax) noexcept {
-        const double denom = static_cast<double>(tmax - tmin);
-        const double invDen = denom > 0.0 ? (1.0 / denom) : 1.0;
-        for (auto& e : rng) {
-            const double s = (static_cast<double>(e.ts) - static_cast<double>(tmin)) * invDen;
-            const double en = (static_cast<double>(e.ts + e.dur) - static_cast<double>(tmin)) * invDen;
-            e.normStart = std::clamp(s, 0.0, 1.0);
-            e.normEnd = std::clamp(en, 0.0, 1.0);
-        }
-    }
-
-    /// Normalize events starting at a given index (partial refresh path).
-    template <class Vec>
-    inline void normalizeEventsFrom(Vec& v, std::size_t beginIdx, std::uint64_t tmin, std::uint64_t tmax) noexcept {
-        if (beginIdx >= v.size()) return;
-        const double denom = static_cast<double>(tmax - tmin);
-        const double invDen = denom > 0.0 ? (1.0 / denom) : 1.0;
-        for (std::size_t i = beginIdx; i < v.size(); ++i) {
-            auto& e = v[i];
-            const double s = (static_cast<double>(e.ts) - static_cast<double>(tmin)) * invDen;
-            const double en = (static_cast<double>(e.ts + e.dur) - static_cast<double>(tmin)) * invDen;
-            e.normStart = std::clamp(s, 0.0, 1.0);
-            e.normEnd = std::clamp(en, 0.0, 1.0);
-        }
-    }
-
     inline void draw_grid_background(
         ImDrawList* dl,
         const ImVec2& canvasMin,
@@ -141,6 +117,7 @@ void ViewerApp::compileDataFilterIfNeeded()
         _filter_cached = patt;
         _filter_case_cached = cs;
         _filter_regex_cached = rx;
+        PROFILE_SCOPE("filter compile");
         _compiledFilter.compile(_filter_cached, cs, rx);
     }
 }
@@ -168,6 +145,388 @@ bool ViewerApp::passDataFilter(const Event& e)
     }
 }
 
+// ---------- Ingest index ----------
+void ViewerApp::resetEventIndex()
+{
+    _kindIds.clear();
+    _kinds.clear();
+    _histograms.clear();
+    _brushed.clear();
+    _asyncChains.clear();
+    _colors.clear();
+    _labels.clear();
+    _rangeT0 = _rangeT1 = 0;
+    _rangeDragging = false;
+    ++_eventsGen;
+}
+
+void ViewerApp::indexEventsFrom(size_t beginIdx)
+{
+    for (size_t i = beginIdx; i < _events.size(); ++i)
+    {
+        Event& e = _events[i];
+        auto [it, inserted] = _kindIds.try_emplace(EventKindKey{ e.category, e.name }, uint32_t(_kinds.size()));
+        if (inserted)
+        {
+            _kinds.push_back(it->first);
+            _histograms.emplace_back();
+        }
+        e.kind = it->second;
+        e.paint = _colors.intern(e);
+        _histograms[e.kind].add(e.dur);
+        e.chain = _asyncChains.add(e);
+    }
+    _asyncChains.sortPending();
+}
+
+void ViewerApp::indexMetricsFrom(size_t beginIdx)
+{
+    _cpuIdx.indexFrom(_metrics, beginIdx);
+    _cpuTotalIdx.indexFrom(_metrics, beginIdx);
+    _ramIdx.indexFrom(_metrics, beginIdx);
+}
+
+// the graph shows one source at a time (_metrics): the first one that reports, until
+// another is picked; the others accumulate aside
+std::vector<Metric>& ViewerApp::metricsOf(uint16_t source)
+{
+    if (!_metricSourceSet)
+    {
+        _metricSource = source;
+        _metricSourceSet = true;
+    }
+    if (source == _metricSource)
+        return _metrics;
+    if (source >= _sourceMetrics.size())
+        _sourceMetrics.resize(size_t(source) + 1);
+    return _sourceMetrics[source];
+}
+
+void ViewerApp::selectMetricSource(uint16_t source)
+{
+    if (_metricSourceSet && source == _metricSource)
+        return;
+    if (std::max(source, _metricSource) >= _sourceMetrics.size())
+        _sourceMetrics.resize(size_t(std::max(source, _metricSource)) + 1);
+    std::swap(_metrics, _sourceMetrics[_metricSource]);
+    std::swap(_metrics, _sourceMetrics[source]);
+    _metricSource = source;
+    _metricSourceSet = true;
+    const auto byTs = [](const Metric& a, const Metric& b) { return a.ts < b.ts; };
+    if (!std::is_sorted(_metrics.begin(), _metrics.end(), byTs))
+        std::stable_sort(_metrics.begin(), _metrics.end(), byTs);
+    indexMetricsFrom(0);
+}
+
+// ---------- Retention ----------
+void ViewerApp::onEvictChunk(const EventStore::Chunk& chunk)
+{
+    if (chunk.events.empty()) return;
+    // chunk is the store front: anything up to its last seq goes away
+    if (_selected && _selected->seq <= chunk.events.back().seq)
+    {
+        _selected = nullptr;
+        _showSelectedPanel = false;
+    }
+    if (_retention.spillToDisk && _spill.write(chunk))
+    {
+        // still reachable through the spill file: aggregates stay untouched
+        _evicted.events += chunk.events.size();
+        _evicted.tsMin = std::min(_evicted.tsMin, chunk.tsMin);
+        _evicted.tsMax = std::max(_evicted.tsMax, chunk.tsMax);
+        return;
+    }
+    if (_retention.spillToDisk)
+        _lastError = _spill.lastError();
+    if (!_retention.keepAggregates)
+    {
+        for (const Event& e : chunk.events)
+            _histograms[e.kind].remove(e.dur);
+    }
+    _evicted.events += chunk.events.size();
+    _evicted.tsMin = std::min(_evicted.tsMin, chunk.tsMin);
+    _evicted.tsMax = std::max(_evicted.tsMax, chunk.tsMax);
+}
+
+// Drops expired front chunks (O(1) each) then shifts _timeMin, keeping the visible
+// absolute window. Metrics are erased in amortized batches.
+bool ViewerApp::applyRetention()
+{
+    if (!_retention.enabled) return false;
+
+    const uint64_t windowUs = uint64_t(std::max(0.0, _retention.maxWindowSec) * 1e6);
+    const uint64_t cutoff = (windowUs && _timeMax > windowUs) ? _timeMax - windowUs : 0;
+
+    size_t dropped = 0;
+    while (_events.chunks().size() > 1)
+    {
+        const EventStore::Chunk& front = *_events.chunks().front();
+        const bool tooOld = cutoff && front.tsMax < cutoff;
+        const bool tooMany = _retention.maxEvents && _events.size() > _retention.maxEvents;
+        const bool tooBig = _retention.maxBytes && _events.bytes() > _retention.maxBytes;
+        if (!tooOld && !tooMany && !tooBig)
+            break;
+        onEvictChunk(front);
+        dropped += front.events.size();
+        _events.popFrontChunk();
+    }
+    // spilled sessions keep the whole time range, the metric track (small) and the async
+    // chains (the spilled fragments keep their Event::chain)
+    const bool spilling = _retention.spillToDisk && !_spill.empty();
+    if (dropped && !spilling)
+        _asyncChains.evictBefore(_events.base());
+
+    uint64_t eventsMin = UINT64_MAX;
+    for (const auto& c : _events.chunks())
+        eventsMin = std::min(eventsMin, c->tsMin);
+
+    if (spilling)
+    {
+        if (dropped) _brushed.dropFront(dropped);
+        return dropped != 0;
+    }
+
+    // metrics older than the window / the oldest retained event
+    uint64_t mCut = cutoff;
+    if (_evicted.events && eventsMin != UINT64_MAX) mCut = std::max(mCut, eventsMin);
+    const size_t stale = size_t(std::lower_bound(_metrics.begin(), _metrics.end(), mCut,
+        [](const Metric& m, uint64_t t) { return m.ts < t; }) - _metrics.begin());
+    const bool dropMetrics = stale && stale >= std::max<size_t>(EventStore::kChunkEvents, _metrics.size() / 4);
+    if (dropMetrics)
+    {
+        _metrics.erase(_metrics.begin(), _metrics.begin() + (ptrdiff_t)stale);
+        _evicted.metrics += stale;
+        indexMetricsFrom(0);
+        for (auto& other : _sourceMetrics)
+            _evicted.metrics += std::erase_if(other, [mCut](const Metric& m) { return m.ts < mCut; });
+    }
+
+    if (!dropped && !dropMetrics)
+        return false;
+
+    if (dropped)
+        _brushed.dropFront(dropped);
+
+    uint64_t tmin = eventsMin;
+    if (!_metrics.empty()) tmin = std::min(tmin, _metrics.front().ts);
+    if (tmin != UINT64_MAX && tmin > _timeMin && tmin < _timeMax)
+    {
+        // constant absolute visible window
+        const double oldTotal = std::max(1.0, double(_timeMax - _timeMin));
+        const double leftAbs = double(_timeMin) + _vp.offset * oldTotal;
+        const double absSpan = oldTotal / std::max(1e-15, double(_vp.zoom));
+        _timeMin = tmin;
+        const double newTotal = std::max(1.0, double(_timeMax - _timeMin));
+        const double spanN = std::clamp(absSpan / newTotal, 1e-18, 1.0);
+        _vp.zoom = float(1.0 / spanN);
+        _vp.offset = std::clamp((leftAbs - double(_timeMin)) / newTotal, 0.0, std::max(0.0, 1.0 - spanN));
+    }
+    return true;
+}
+
+// Out-of-core view: spilled chunks overlapping the viewport are paged in (LRU resident set)
+// while they fit, otherwise groups of chunks collapse to one summary box per kind.
+void ViewerApp::collectSpilled(uint64_t t0, uint64_t t1, SourceGroups& bySrc)
+{
+    _spillLod.clear();
+    if (_spill.empty()) return;
+    _spill.overlapping(t0, t1, _spillOverlap);
+    if (_spillOverlap.empty()) return;
+
+    if (_spillOverlap.size() <= _spill.residentCapacity())
+    {
+        for (size_t idx : _spillOverlap)
+        {
+            EventStore::Chunk* c = _spill.page(idx, _kinds);
+            if (!c) { _lastError = _spill.lastError(); continue; }
+            for (Event& e : c->events)
+            {
+                // the slot may have been reused if spilling was turned off meanwhile
+                const AsyncChain* ch = _asyncChains.chain(e.chain);
+                if (e.chain && (!ch || ch->id != e.id || ch->pid != e.pid || ch->source != e.source))
+                    e.chain = 0;
+                groupEvent(bySrc, e);
+            }
+        }
+        return;
+    }
+
+    constexpr size_t kLodGroups = 256;
+    const size_t n = _spillOverlap.size();
+    const size_t per = (n + kLodGroups - 1) / kLodGroups;
+    std::vector<SpillFile::KindSpan> acc;
+    for (size_t g = 0; g < n; g += per)
+    {
+        acc.clear();
+        for (size_t j = g; j < std::min(n, g + per); ++j)
+        {
+            for (const SpillFile::KindSpan& k : _spill.chunks()[_spillOverlap[j]].lod)
+            {
+                auto it = std::find_if(acc.begin(), acc.end(), [&](const SpillFile::KindSpan& a) { return a.kind == k.kind && a.source == k.source; });
+                if (it == acc.end()) { acc.push_back(k); continue; }
+                it->count += k.count;
+                it->tsMin = std::min(it->tsMin, k.tsMin);
+                it->tsMax = std::max(it->tsMax, k.tsMax);
+            }
+        }
+        for (const SpillFile::KindSpan& k : acc)
+        {
+            if (k.kind >= _kinds.size()) continue;
+            Event e;
+            e.category = _kinds[k.kind].category;
+            e.name = _kinds[k.kind].name;
+            e.data = std::to_string(k.count) + " spilled events (zoom in to page them in)";
+            e.color = "#64748B";
+            e.paint = _colors.internColor(e.color);
+            e.ts = k.tsMin;
+            e.dur = k.tsMax - k.tsMin;
+            e.kind = k.kind;
+            e.source = k.source;
+            e.seq = UINT64_MAX;
+            _spillLod.push_back(std::move(e));
+        }
+    }
+    for (Event& e : _spillLod) groupEvent(bySrc, e);
+}
+
+void ViewerApp::groupEvent(SourceGroups& bySrc, Event& e)
+{
+    if (e.source >= bySrc.size())
+        bySrc.resize(size_t(e.source) + 1);
+    bySrc[e.source][e.category].push_back(&e);
+}
+
+std::string ViewerApp::sourceLabel(uint16_t source) const
+{
+    std::string name = _client.source_name(source);
+    if (name.empty()) name = "source";
+    return name + " (" + std::to_string(source) + ")";
+}
+
+// Event* still backed by the store or the spill resident set
+bool ViewerApp::ownsEvent(const Event* e) const
+{
+    auto in = [e](const std::vector<Event>& v) {
+        return !v.empty() && std::less_equal<const Event*>()(v.data(), e) && std::less<const Event*>()(e, v.data() + v.size());
+    };
+    for (const auto& c : _events.chunks())
+        if (in(c->events)) return true;
+    return _spill.isResident(e);
+}
+
+// Bitset of events falling in the brushed histogram buckets; rebuilt only when the
+// brush/kind/dataset changes, otherwise extended with the newly ingested tail.
+void ViewerApp::updateBrushSelection()
+{
+    if (!_showHistogramPanel || !_histPanel.hasBrush() || _histKind >= _kinds.size())
+    {
+        _brushed.clear();
+        _brushedKind = UINT32_MAX;
+        return;
+    }
+    const int a = _histPanel.brushFirst();
+    const int b = _histPanel.brushLast();
+    if (a != _brushedFirst || b != _brushedLast || _histKind != _brushedKind || _brushedGen != _eventsGen || _brushed.size > _events.size())
+    {
+        _brushed.clear();
+        _brushedFirst = a; _brushedLast = b;
+        _brushedKind = _histKind;
+        _brushedGen = _eventsGen;
+    }
+    const size_t from = _brushed.size;
+    if (from == _events.size()) return;
+    _brushed.resize(_events.size());
+    for (size_t i = from; i < _events.size(); ++i)
+    {
+        const Event& e = _events[i];
+        if (e.kind != _brushedKind) continue;
+        const int bk = DurationHistogram::bucketOf(e.dur);
+        if (bk >= a && bk <= b) _brushed.set(i);
+    }
+}
+
+// ---------- Flame graph ----------
+// Spans of the range are copied from the store a slice of chunks per frame (chunks outside the
+// range are skipped on their bounds), the sort and sweep run on the FlameBuilder thread.
+// Instants and async fragments are left out: they do not nest.
+void ViewerApp::updateFlameGraph(bool force)
+{
+    PROFILE_SCOPE("flame graph");
+    uint64_t t0 = _timeMin, t1 = _timeMax;
+    if (_flamePanel.range() == ViewerFlamePanel::Range::Visible)
+    {
+        const double totalUs = std::max(1.0, double(_timeMax - _timeMin));
+        t0 = _timeMin + uint64_t(std::clamp(_vp.offset, 0.0, 1.0) * totalUs);
+        t1 = _timeMin + uint64_t(std::clamp(_vp.offset + 1.0 / double(_vp.zoom), 0.0, 1.0) * totalUs);
+    }
+    else if (_flamePanel.range() == ViewerFlamePanel::Range::Selection && _rangeT1 > _rangeT0)
+    {
+        t0 = _rangeT0;
+        t1 = _rangeT1;
+    }
+    t1 = std::max(t1, t0 + 1);
+
+    FlameCollect& c = _flameCollect;
+    const uint64_t baseChunk = _events.base() / EventStore::kChunkEvents;
+    const FlameKey key{ _eventsGen, _events.size(), _events.base(), t0, t1, _flamePanel.byThread() };
+    // live sessions change every tick: one rebuild per second at most
+    const bool settled = _view != AppView::Live || ImGui::GetTime() - _flameCollectedAt >= 1.0;
+    if (force || (!c.active && _flamePanel.autoRefresh() && !(key == _flameKey) && settled))
+    {
+        _flameKey = key;
+        c.active = true;
+        c.gen = _eventsGen;
+        c.first = c.next = baseChunk;
+        c.end = baseChunk + _events.chunks().size();
+        c.t0 = t0;
+        c.t1 = t1;
+        c.byThread = key.byThread;
+        c.spans.clear();
+    }
+    if (!c.active)
+        return;
+    if (c.gen != _eventsGen)
+    {
+        // store replaced: start over on the new one
+        c.gen = _eventsGen;
+        c.first = c.next = baseChunk;
+        c.end = baseChunk + _events.chunks().size();
+        c.spans.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        const auto& chunks = _events.chunks();
+        c.next = std::max(c.next, baseChunk);   // evicted meanwhile
+        size_t copied = 0;
+        while (c.next < c.end && c.next - baseChunk < chunks.size() && copied < FlameCollect::kEventsPerFrame)
+        {
+            const EventStore::Chunk& chunk = *chunks[size_t(c.next - baseChunk)];
+            ++c.next;
+            if (chunk.tsMax <= c.t0 || chunk.tsMin >= c.t1)
+                continue;
+            for (const Event& e : chunk.events)
+            {
+                if (e.dur == 0 || e.chain || e.ts >= c.t1 || e.ts + e.dur <= c.t0)
+                    continue;
+                // spans nest per thread; pid > 2^24 may share a key with another source
+                const uint64_t thread = (uint64_t(e.source) << 56) ^ (uint64_t(e.pid) << 32) ^ e.tid;
+                c.spans.push_back({ e.ts, e.ts + e.dur, thread, e.kind, e.paint });
+            }
+            copied += chunk.events.size();
+        }
+    }
+    if (c.next < c.end && c.next - baseChunk < _events.chunks().size())
+    {
+        _frames.request(FrameScheduler::Loader);
+        return;
+    }
+    c.active = false;
+    _flameCollectedAt = ImGui::GetTime();
+    _flame.submit({ std::move(c.spans), c.t0, c.t1, c.byThread });
+    c.spans = {};
+}
+
 // ---------- ViewerApp ----------
 ViewerApp::ViewerApp()
     : _events{}, _globalStats{}, _metrics{}
@@ -190,14 +549,21 @@ ViewerApp::ViewerApp()
     , _dataFilterCaseSensitive{ false }, _dataFilterRegex{ false }
     , _filteredVisible{ 0 }
 {
+    _client.set_stats(&_ingest);
+    _client.set_wake(&_frames);
+    _flame.set_wake(&_frames);
 }
 ViewerApp::~ViewerApp() {}
 
 void ViewerApp::cleanup()
 {
-    _events = {};
+    _events.clear();
     _globalStats = {};
+    _evicted = {};
+    _spill.reset();
+    _spillLod.clear();
     _metrics = {};
+    indexMetricsFrom(0);
     _timeMin = 0;
     _timeMax = 1;
     _selected = nullptr;
@@ -205,52 +571,113 @@ void ViewerApp::cleanup()
     _parsing = false;
     _parsedCount = 0;
     _lastError = {};
+    resetEventIndex();
+    _showHistogramPanel = false;
     _view = AppView::Startup;
-    if (_client.connected())
-        _client.stop_session();
+    _client.stop_session();
+    _sourceRuns.clear();
+    _sourceMetrics.clear();
+    _shmMetrics.clear();
+    _metricSource = 0;
+    _metricSourceSet = false;
+    _recorder.stop();
+    _replay.close();
+    _wire.reset();
+    _ingest.reset();
+    _ingestRates = {};
+}
+
+// Streams a trace file into the cleared store: events come in batches of one chunk,
+// appended and indexed as they are parsed, so neither the JSON document nor a second
+// copy of the events is ever held. With spilling, a batch is ts sorted (tight chunk
+// ranges) and retention runs after each one, so memory stays bounded by the resident
+// window. On a parse error whatever was read so far stays loaded.
+bool ViewerApp::streamFile(const char* path, uint64_t durMinUs, std::string& err)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        err = "Failed to open file";
+        return false;
+    }
+    _selected = nullptr;
+    _spill.reset();
+    _spillLod.clear();
+    _evicted = {};
+    _events.clear();
+    _globalStats.clear();
+    _metrics.clear();
+    resetEventIndex();
+
+    const bool spill = _retention.enabled && _retention.spillToDisk;
+    uint64_t tmin = UINT64_MAX, tmax = 0;
+    std::vector<Event> batch;
+    batch.reserve(EventStore::kChunkEvents);
+    const auto flush = [&]
+    {
+        if (batch.empty()) return;
+        if (spill)
+            std::stable_sort(batch.begin(), batch.end(), [](const Event& a, const Event& b) { return a.ts < b.ts; });
+        for (const Event& e : batch)
+        {
+            tmin = std::min(tmin, e.ts);
+            tmax = std::max(tmax, e.ts + e.dur);
+        }
+        const size_t from = _events.size();
+        _events.append(std::move(batch));
+        indexEventsFrom(from);
+        if (spill)
+        {
+            _timeMin = tmin; _timeMax = std::max(tmax, tmin + 1);   // retention window so far
+            applyRetention();
+        }
+        batch.reserve(EventStore::kChunkEvents);
+    };
+
+    const bool ok = parse_trace_stream(in,
+        [&](Event&& e)
+        {
+            batch.push_back(std::move(e));
+            if (batch.size() == EventStore::kChunkEvents) flush();
+        },
+        [&](const Metric& m) { _metrics.push_back(m); },
+        [&](const std::string& name, const EventStats& st) { _globalStats[name] = st; },
+        durMinUs, &err);
+    flush();
+
+    // spilled events included
+    if (tmin == UINT64_MAX) { _timeMin = 0; _timeMax = 1; }
+    else { _timeMin = tmin; _timeMax = std::max(tmax, tmin + 1); }
+
+    std::sort(_metrics.begin(), _metrics.end(), [](const Metric& a, const Metric& b) { return a.ts < b.ts; });
+    indexMetricsFrom(0);
+    if (!ok && err.empty())
+        err = "Failed to parse file";
+    return ok;
 }
 
 bool ViewerApp::loadFile(const char* path, uint64_t durMinUs)
 {
+    PROFILE_SCOPE("loadFile");
     if (!path || !*path) return false;
 
     _parsing = true;
-    std::vector<Event> newEvents;
-    std::unordered_map<std::string, EventStats> newStats;
     std::string err;
-    std::string data;
-    if (!read_file(path, data))
+    bool ok;
     {
-        _lastError = err.empty() ? "Failed to open file" : err;
-        _parsing = false;
-        return false;
+        std::lock_guard<std::mutex> lk(_mtx);
+        ok = streamFile(path, durMinUs, err);
+        _vp.zoom = 1.f; _vp.offset = 0.0; _vp.panY = 0.f;
+        _parsedCount = _events.size() + size_t(_spill.events());
     }
-    if (!parse_trace_payload(data, newEvents, newStats, _metrics, durMinUs, &err))
+    _parsing = false;
+    _frames.request(FrameScheduler::Loader, FrameScheduler::kSettleFrames);
+    if (!ok)
     {
-        _lastError = err.empty() ? "Failed to parse file" : err;
-        _parsing = false;
+        _lastError = err;
         return false;
     }
-
-    {
-        std::lock_guard<std::mutex> lk(_mtx);
-        _events.swap(newEvents);
-        _globalStats.swap(newStats);
-
-        auto [tmin, tmax] = computeTimeBounds(_events);
-        _timeMin = tmin; _timeMax = tmax;
-
-
-        normalizeEvents(_events, _timeMin, _timeMax);
-
-
-        std::sort(_metrics.begin(), _metrics.end(), [](const Metric& a, const Metric& b) { return a.ts < b.ts; });
-
-        _vp.zoom = 1.f; _vp.offset = 0.0; _vp.panY = 0.f;
-        _selected = nullptr;
-        _parsedCount = _events.size();
-    }
-    _parsing = false; _lastError.clear();
+    _lastError.clear();
     std::snprintf(_filepath, sizeof(_filepath), "%s", path);
 
     if (std::filesystem::exists(path)) _fileMTime = std::filesystem::last_write_time(path);
@@ -259,27 +686,18 @@ bool ViewerApp::loadFile(const char* path, uint64_t durMinUs)
 
 bool ViewerApp::reloadFilePreserveView(uint64_t durMinUs) {
     if (_filepath[0] == '\0') return false;
-    std::vector<Event> tmp; std::unordered_map<std::string, EventStats> tmpStats; std::string err;
-    if (!parse_trace_payload(_filepath, tmp, tmpStats, _metrics, durMinUs, &err)) { _lastError = err; return false; }
-
     auto keep = _vp;
+    std::string err;
+    bool ok;
     {
         std::lock_guard<std::mutex> lk(_mtx);
-        _events.swap(tmp);
-        _globalStats.swap(tmpStats);
-
-        auto [tmin, tmax] = computeTimeBounds(_events);
-        _timeMin = tmin; _timeMax = tmax;
-
-
-        normalizeEvents(_events, _timeMin, _timeMax);
-
-
-        std::sort(_metrics.begin(), _metrics.end(), [](const Metric& a, const Metric& b) { return a.ts < b.ts; });
-
-        _parsedCount = _events.size();
+        ok = streamFile(_filepath, durMinUs, err);
+        _parsedCount = _events.size() + size_t(_spill.events());
     }
-    _vp = keep; _lastError.clear();
+    _vp = keep;
+    _frames.request(FrameScheduler::Loader, FrameScheduler::kSettleFrames);
+    if (!ok) { _lastError = err; return false; }
+    _lastError.clear();
 
     if (std::filesystem::exists(_filepath)) _fileMTime = std::filesystem::last_write_time(_filepath);
     return true;
@@ -299,12 +717,15 @@ void ViewerApp::updateAutoReload(const char* path) {
 }
 
 // tiny draw helpers
-void ViewerApp::drawEventBox(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, ImU32 color, bool hovered, bool selected)
+static ImU32 event_box_fill(const Swatch& sw, bool hovered, bool selected)
+{
+    if (selected) return IM_COL32(255, 255, 255, 40);
+    return hovered ? sw.hovered : sw.fill;
+}
+
+void ViewerApp::drawEventBox(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, const Swatch& sw, bool hovered, bool selected)
 {
-    ImU32 fill = color;
-    if (hovered)   fill = color::AdjustRGB(color, +20);
-    if (selected)  fill = IM_COL32(255, 255, 255, 40);
-    dl->AddRectFilled(p1, p2, fill, 5.0f);
+    dl->AddRectFilled(p1, p2, event_box_fill(sw, hovered, selected), 5.0f);
     dl->AddRect(p1, p2, IM_COL32(0, 0, 0, 140), 5.0f, 0, 1.0f);
 }
 
@@ -314,20 +735,20 @@ void ViewerApp::drawTopBottomAccent(ImDrawList* dl, const ImVec2& p1, const ImVe
     dl->AddRectFilled(ImVec2(p1.x, p2.y - 2.f), ImVec2(p2.x, p2.y), bottomColor);
 }
 
-void ViewerApp::drawCenteredLabel(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, const char* text, ImU32 color)
+void ViewerApp::drawCenteredLabel(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, std::string_view text, const LabelCache::Fit& fit, ImU32 color)
 {
     float textHeight = ImGui::GetTextLineHeight();
-    float textWidth = ImGui::CalcTextSize(text).x;
-    if (p2.x - p1.x <= 8.f) return;
+    if (p2.x - p1.x <= 8.f || fit.empty()) return;
     ImVec2 pos;
-    pos.x = p1.x + (p2.x - p1.x - textWidth) * 0.5f;
+    pos.x = p1.x + (p2.x - p1.x - fit.width) * 0.5f;
     pos.y = p1.y + (p2.y - p1.y - textHeight) * 0.5f;
-    dl->AddText(pos, color, text);
+    LabelCache::draw(dl, pos, color, text, fit);
 }
 
 // =============== metrics bottom (CPU/RAM) ===============
 void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax, float leftPad, float contentW, float startY, double normStart, double normEnd)
 {
+    PROFILE_SCOPE("drawMetricsBottom");
     if (_metrics.empty()) return;
 
     constexpr float kTrackH = 78.f;
@@ -349,25 +770,35 @@ void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const
     auto xx = [&](double absUs)->float {
         return xFromAbsUs(absUs, canvasMin, leftPad, contentW, normStart, normEnd, _timeMin, _timeMax);
         };
+    // inverse of xx
+    auto tsAtX = [&](float x)->double {
+        return visStart + double(x - (canvasMin.x + leftPad)) / double(std::max(1.0f, contentW)) * (visEnd - visStart);
+        };
     auto labelX = [&](float textW) {
         float x = (canvasMin.x + leftPad) - 6.0f - textW;
         float left = canvasMin.x + 8.0f;
         return (x < left) ? left : x;
         };
+    // first sample with ts >= t (binary search, metrics are ts-sorted)
+    auto lowerIdx = [&](double t, size_t from = 0)->size_t {
+        auto it = std::lower_bound(_metrics.begin() + (ptrdiff_t)from, _metrics.end(), t,
+            [](const Metric& m, double v) { return double(m.ts) < v; });
+        return size_t(it - _metrics.begin());
+        };
+    auto nearestIdx = [&](double t)->size_t {
+        size_t i = lowerIdx(t);
+        if (i >= _metrics.size()) return _metrics.size() - 1;
+        if (i > 0 && (t - double(_metrics[i - 1].ts)) <= (double(_metrics[i].ts) - t)) return i - 1;
+        return i;
+        };
     // Interpolation générique d’une série m->field
-    auto sampleAt = [&](double t, auto getter)->double {
-        if (_metrics.empty()) return 0.0;
-        size_t lo = 0, hi = _metrics.size();
-        while (lo + 1 < hi) {
-            size_t mid = (lo + hi) >> 1;
-            if (_metrics[mid].ts <= t) lo = mid;
-            else hi = mid;
-        }
-        double v0 = double(getter(_metrics[lo]));
-        if (lo + 1 < _metrics.size()) {
-            size_t n = lo + 1;
-            double v1 = double(getter(_metrics[n]));
-            double t0 = double(_metrics[lo].ts), t1 = double(_metrics[n].ts);
+    auto sampleAt = [&](double t, const MetricSeriesIndex& s)->double {
+        size_t hi = std::min(lowerIdx(t), _metrics.size() - 1);
+        size_t lo = hi > 0 && double(_metrics[hi].ts) > t ? hi - 1 : hi;
+        double v0 = double(s.value(lo));
+        if (hi != lo) {
+            double v1 = double(s.value(hi));
+            double t0 = double(_metrics[lo].ts), t1 = double(_metrics[hi].ts);
             double a = (t1 > t0) ? (t - t0) / (t1 - t0) : 0.0;
             a = std::clamp(a, 0.0, 1.0);
             return v0 + (v1 - v0) * a;
@@ -375,12 +806,67 @@ void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const
         return v0;
         };
 
+    // visibles (avec marge)
+    const double pad = spanUs * 0.10;
+    const size_t vis0 = lowerIdx(visStart - pad);
+    const size_t vis1 = lowerIdx(visEnd + pad + 1.0, vis0);
+    const float vx1 = canvasMin.x + leftPad;
+    const float vx2 = canvasMax.x - 6.f;
+
+    // Raw samples when they are sparse, otherwise M4 reduction: one first/min/max/last
+    // group per pixel column taken from the min/max pyramid -> bounded by the width.
+    auto drawSeries = [&](const MetricSeriesIndex& s, auto toY, ImU32 col)
+        {
+            if (vis0 >= vis1) {
+                ImVec2 a(xx(visStart), toY(sampleAt(visStart, s)));
+                ImVec2 b(xx(visEnd), toY(sampleAt(visEnd, s)));
+                dl->AddLine(a, b, col, kThick);
+                return;
+            }
+            _metricPts.clear();
+            // ancre gauche
+            _metricPts.emplace_back(xx(visStart), toY(sampleAt(visStart, s)));
+            const bool raw = float(vis1 - vis0) * 3.0f <= (vx2 - vx1);
+            if (raw)
+            {
+                for (size_t i = vis0; i < vis1; ++i) {
+                    float x = xx(double(_metrics[i].ts));
+                    if (x < vx1 - 2.f || x > vx2 + 2.f) continue;
+                    ImVec2 cur(x, toY(double(s.value(i))));
+                    _metricPts.push_back(cur);
+                    dl->AddCircleFilled(cur, kPtR, col);
+                }
+            }
+            else
+            {
+                size_t i = vis0;
+                for (float cx = std::floor(std::max(vx1, xx(double(_metrics[vis0].ts)))); cx <= vx2 && i < vis1; cx += 1.0f)
+                {
+                    const size_t k = std::min(vis1, lowerIdx(tsAtX(cx + 1.0f), i));
+                    if (k <= i) continue;
+                    const float x = cx + 0.5f;
+                    const auto [mn, mx] = s.minMax(i, k);
+                    const float yFirst = toY(double(s.value(i)));
+                    const float yLast = toY(double(s.value(k - 1)));
+                    _metricPts.emplace_back(x, yFirst);
+                    if (k - i > 1)
+                    {
+                        _metricPts.emplace_back(x, toY(double(mn)));
+                        _metricPts.emplace_back(x, toY(double(mx)));
+                        _metricPts.emplace_back(x, yLast);
+                    }
+                    i = k;
+                }
+            }
+            // bord droit
+            _metricPts.emplace_back(xx(visEnd), toY(sampleAt(visEnd, s)));
+            dl->AddPolyline(_metricPts.data(), (int)_metricPts.size(), col, ImDrawFlags_None, kThick);
+        };
+
     // -------- CPU track --------
     {
         float y = startY + 10.f;
         float h = kTrackH;
-        const float vx1 = canvasMin.x + leftPad;
-        const float vx2 = canvasMax.x - 6.f;
 
         dl->AddRectFilled(ImVec2(vx1, y), ImVec2(vx2, y + h), kBoxCol, 6.f);
         // vertical grid only for metrics (no horizontal cadence here)
@@ -416,58 +902,16 @@ void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const
                 pct = std::clamp(pct, 0.0, 100.0);
                 return y + (1.f - float(pct / 100.0)) * h;
             };
-        auto drawSeries = [&](auto getter, ImU32 col)
-            {
-                // indices visibles (avec marge)
-                const double pad = spanUs * 0.10;
-                const double qMin = visStart - pad;
-                const double qMax = visEnd + pad;
-                size_t i0 = 0, i1 = _metrics.size();
-                while (i0 < i1 && double(_metrics[i0].ts) < qMin) ++i0;
-                while (i1 > i0 && double(_metrics[i1 - 1].ts) > qMax) --i1;
-
-                ImVec2 last(-1, -1);
-                if (i0 >= i1) {
-                    ImVec2 a(xx(visStart), cpuToY(sampleAt(visStart, getter)));
-                    ImVec2 b(xx(visEnd), cpuToY(sampleAt(visEnd, getter)));
-                    dl->AddLine(a, b, col, kThick);
-                    return;
-                }
-                // ancre gauche
-                last = ImVec2(xx(visStart), cpuToY(sampleAt(visStart, getter)));
-                // samples
-                for (size_t i = i0; i < i1; ++i) {
-                    const auto& m = _metrics[i];
-                    float x = xx(double(m.ts));
-                    if (x < vx1 - 2.f || x > vx2 + 2.f) continue;
-                    ImVec2 cur(x, cpuToY(double(getter(m))));
-                    if (last.x > 0) dl->AddLine(last, cur, col, kThick);
-                    last = cur;
-                    dl->AddCircleFilled(cur, kPtR, col);
-                }
-                // bord droit
-                ImVec2 r(xx(visEnd), cpuToY(sampleAt(visEnd, getter)));
-                if (last.x > 0) dl->AddLine(last, r, col, kThick);
-            };
 
-        drawSeries([&](const Metric& m) { return m.cpu_total; }, kCpuTot);
-        drawSeries([&](const Metric& m) { return m.cpu;       }, kCpuProc);
+        drawSeries(_cpuTotalIdx, cpuToY, kCpuTot);
+        drawSeries(_cpuIdx, cpuToY, kCpuProc);
 
         // Hover
         ImGuiIO& io = ImGui::GetIO();
         if (io.MousePos.x >= vx1 && io.MousePos.x <= vx2 &&
             io.MousePos.y >= y && io.MousePos.y <= y + h)
         {
-            const double tUs = double(_timeMin) + (normStart + (normEnd - normStart) *
-                std::clamp((io.MousePos.x - (canvasMin.x + leftPad)) / std::max(1.0f, contentW), 0.0f, 1.0f))
-                * (double)(_timeMax - _timeMin);
-
-            size_t best = 0; double bestD = 1e300;
-            for (size_t i = 0; i < _metrics.size(); ++i) {
-                double d = std::abs(double(_metrics[i].ts) - tUs);
-                if (d < bestD) { bestD = d; best = i; }
-            }
-            const auto& m = _metrics[best];
+            const auto& m = _metrics[nearestIdx(tsAtX(io.MousePos.x))];
             ImGui::BeginTooltip();
             ImGui::Text("CPU @ %s", fmtTime(double(m.ts - _timeMin)).c_str());
             ImGui::Separator();
@@ -483,16 +927,14 @@ void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const
     {
         float y = startY;
         float h = kTrackH;
-        const float vx1 = canvasMin.x + leftPad;
-        const float vx2 = canvasMax.x - 6.f;
 
         dl->AddRectFilled(ImVec2(vx1, y), ImVec2(vx2, y + h), kBoxCol, 6.f);
         // vertical grid only
         draw_grid_background(dl, canvasMin, canvasMax, leftPad, contentW, normStart, normEnd, _timeMin, _timeMax, y, h, /*horizStep*/0.0f, /*colV*/kGridCol, /*colH*/0);
 
-        // borne Y globale (avec pad)
-        double ramMin = +1e300, ramMax = -1e300;
-        for (const auto& m : _metrics) { ramMin = std::min(ramMin, double(m.ram_used)); ramMax = std::max(ramMax, double(m.ram_used)); }
+        // borne Y globale (avec pad), O(log n) from the pyramid
+        const auto [rmn, rmx] = _ramIdx.minMax(0, _ramIdx.size());
+        double ramMin = double(rmn), ramMax = double(rmx);
         if (!(ramMax > ramMin)) { ramMin = 0.0; ramMax = 1.0; }
         const double ramPad = std::max(0.5, 0.05 * (ramMax - ramMin));
         const double mn = ramMin - ramPad, mx = ramMax + ramPad;
@@ -500,12 +942,6 @@ void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const
         // ticks Y
         const double step = nice_step_us(mx - mn, 4);
         const double first = std::ceil(mn / step) * step;
-        auto labelX = [&](float textW)
-            {
-                float x = (canvasMin.x + leftPad) - 6.0f - textW;
-                float left = canvasMin.x + 8.0f;
-                return (x < left) ? left : x;
-            };
         for (double v = first; v <= mx + 1e-9; v += step)
         {
             float yy = y + (1.f - float((v - mn) / (mx - mn))) * h;
@@ -524,50 +960,14 @@ void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const
                 return y + (1.f - float((v - mn) / (mx - mn))) * h;
             };
 
-        // visibles (marge)
-        const double pad = spanUs * 0.10;
-        const double qMin = visStart - pad;
-        const double qMax = visEnd + pad;
-        size_t i0 = 0, i1 = _metrics.size();
-        while (i0 < i1 && double(_metrics[i0].ts) < qMin) ++i0;
-        while (i1 > i0 && double(_metrics[i1 - 1].ts) > qMax) --i1;
-
-        ImVec2 last(-1, -1);
-        if (i0 >= i1) {
-            ImVec2 a(xx(visStart), ramToY(sampleAt(visStart, [&](const Metric& m) { return double(m.ram_used); })));
-            ImVec2 b(xx(visEnd), ramToY(sampleAt(visEnd, [&](const Metric& m) { return double(m.ram_used); })));
-            dl->AddLine(a, b, kRamCol, kThick);
-        }
-        else {
-            last = ImVec2(xx(visStart), ramToY(sampleAt(visStart, [&](const Metric& m) { return double(m.ram_used); })));
-            for (size_t i = i0; i < i1; ++i) {
-                const auto& m = _metrics[i];
-                float x = xx(double(m.ts));
-                if (x < vx1 - 2.f || x > vx2 + 2.f) continue;
-                ImVec2 cur(x, ramToY(double(m.ram_used)));
-                if (last.x > 0) dl->AddLine(last, cur, kRamCol, kThick);
-                last = cur;
-                dl->AddCircleFilled(cur, kPtR, kRamCol);
-            }
-            ImVec2 r(xx(visEnd), ramToY(sampleAt(visEnd, [&](const Metric& m) { return double(m.ram_used); })));
-            if (last.x > 0) dl->AddLine(last, r, kRamCol, kThick);
-        }
+        drawSeries(_ramIdx, ramToY, kRamCol);
 
         // Hover
         ImGuiIO& io = ImGui::GetIO();
         if (io.MousePos.x >= vx1 && io.MousePos.x <= vx2 &&
             io.MousePos.y >= y && io.MousePos.y <= y + h)
         {
-            const double tUs = double(_timeMin) + (normStart + (normEnd - normStart) *
-                std::clamp((io.MousePos.x - (canvasMin.x + leftPad)) / std::max(1.0f, contentW), 0.0f, 1.0f))
-                * (double)(_timeMax - _timeMin);
-
-            size_t best = 0; double bestD = 1e300;
-            for (size_t i = 0; i < _metrics.size(); ++i) {
-                double d = std::abs(double(_metrics[i].ts) - tUs);
-                if (d < bestD) { bestD = d; best = i; }
-            }
-            const auto& m = _metrics[best];
+            const auto& m = _metrics[nearestIdx(tsAtX(io.MousePos.x))];
 
             double used = double(m.ram_used);
             double total = std::max(1.0, double(m.ram_total));
@@ -586,6 +986,131 @@ void ViewerApp::drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const
 }
 
 // ---------- Categories ----------
+// Lane events are ts sorted and never overlap (packing in drawTimeline), so their starts
+// and ends are both sorted: [first, last) of the ones intersecting [us0, us1] (absolute).
+static std::pair<size_t, size_t> lane_range(const std::vector<Event*>& lane, double us0, double us1)
+{
+    auto b = std::partition_point(lane.begin(), lane.end(), [us0](const Event* e) { return double(e->ts + e->dur) < us0; });
+    auto e = std::partition_point(b, lane.end(), [us1](const Event* ev) { return double(ev->ts) <= us1; });
+    return { size_t(b - lane.begin()), size_t(e - lane.begin()) };
+}
+
+// Adaptive grouping of lane[first, last): x = x0 + (us - us0) * pxPerUs, boxes clamped to
+// [clipX1, clipX2]. densityScale maps the event count to a full content width (tiles).
+void ViewerApp::groupLaneEvents(const std::vector<Event*>& lane, size_t first, size_t last, int packed,
+    double x0, double us0, double pxPerUs, float clipX1, float clipX2, float densityScale,
+    std::vector<LaneGroup>& out, size_t& visibleEventsCount)
+{
+    constexpr float kMinBoxW = 18.f;
+    constexpr float kGapPx = 2.f;
+
+    // collect visible+filtered
+    std::vector<Event*> vis; vis.reserve(last - first);
+    for (size_t i = first; i < last; ++i)
+        if (passDataFilter(*lane[i])) vis.push_back(lane[i]);
+    visibleEventsCount += vis.size();
+    if (vis.empty()) return;
+
+    // gap adaptatif (zoom & volume)
+    float baseGapPx = 10.f / std::sqrt(std::max(1.f, _vp.zoom));
+    baseGapPx = std::clamp(baseGapPx, 1.0f, 40.0f);
+    const float targetGroups = 140.f;
+    const float density = float(vis.size()) * densityScale;
+    float adapt = 1.0f;
+    if (density > targetGroups * 2) adapt = std::min(4.0f, std::sqrt(density / targetGroups));
+    else if (density < targetGroups / 2) adapt = 0.7f;
+    const float minGapPx = std::clamp(baseGapPx * adapt, 0.5f, 80.0f);
+
+    auto x_from_abs = [&](double absUs) { return float(x0 + (absUs - us0) * pxPerUs); };
+    float curX1 = -1.f, curX2 = -1.f;
+    std::vector<Event*> bucket;
+    auto flush = [&]() {
+        if (bucket.empty()) return;
+        float gx1 = curX1 + kGapPx, gx2 = curX2 - kGapPx;
+        if (gx2 < clipX1) gx2 = clipX1;
+        if (gx1 > clipX2) gx2 = clipX2;
+        gx1 = std::max(gx1, clipX1);
+        gx2 = std::min(gx2, clipX2);
+        if (gx2 < gx1) gx2 = gx1 + 1.f;
+        out.push_back({ gx1, gx2, packed, bucket });
+        bucket.clear(); curX1 = curX2 = -1.f;
+        };
+
+    for (Event* e : vis)
+    {
+        float x1 = x_from_abs(double(e->ts));
+        float x2 = x_from_abs(double(e->ts + e->dur));
+        if (x2 - x1 < kMinBoxW) x2 = x1 + kMinBoxW;
+
+        if (bucket.empty())
+        {
+            curX1 = x1; curX2 = x2; bucket = { e };
+        }
+        else
+        {
+            if (x1 <= (curX2 + minGapPx))
+            {
+                curX2 = std::max(curX2, x2);
+                bucket.push_back(e);
+            }
+            else {
+                flush();
+                curX1 = x1; curX2 = x2; bucket = { e };
+            }
+        }
+    }
+    flush();
+}
+
+// Box, accents, brush outline and label of one group (p1 / p2 = box corners).
+void ViewerApp::drawLaneGroup(ImDrawList* dl, const LaneGroup& g, const ImVec2& p1, const ImVec2& p2, bool hovered, bool selected, bool gpuBoxes)
+{
+    const Swatch& sw = _colors[g.ev.front()->paint];
+    if (gpuBoxes) _boxes.add(p1, p2, event_box_fill(sw, hovered, selected));
+    else drawEventBox(dl, p1, p2, sw, hovered, selected);
+    if (hovered || selected)
+        drawTopBottomAccent(dl, p1, p2, sw.accentTop, sw.accentBottom);
+
+    // histogram brush highlight
+    if (_brushed.setCount)
+    {
+        const bool anyBrushed = std::any_of(g.ev.begin(), g.ev.end(), [&](const Event* e) { return _brushed.test(size_t(e->seq - _events.base())); });
+        if (anyBrushed)
+            dl->AddRect(p1, p2, IM_COL32(255, 156, 74, 255), 5.0f, 0, 2.0f);
+    }
+
+    // label
+    if ((p2.x - p1.x) >= 28.0f) {
+        if (g.ev.size() == 1) {
+            const Event* e = g.ev.front();
+            const std::string& lab = e->name.empty() ? e->category : e->name;
+            drawCenteredLabel(dl, p1, p2, lab, _labels.fit(e->kind, lab, p2.x - p1.x - 10.f), IM_COL32(25, 25, 25, 235));
+        }
+        else {
+            char buf[32];
+            const int n = std::snprintf(buf, sizeof(buf), "(%zu)", g.ev.size());
+            const std::string_view count(buf, size_t(std::max(0, n)));
+            drawCenteredLabel(dl, p1, p2, count, _labels.whole(count), IM_COL32(240, 240, 240, 235));
+        }
+    }
+}
+
+void ViewerApp::interactLaneGroup(const LaneGroup& g, bool hovered, Event*& hoveredEvent, std::vector<Event*>& hoveredGroup)
+{
+    if (!hovered) return;
+    if (g.ev.size() == 1) {
+        Event* e = g.ev.front();
+        hoveredEvent = e;
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) { _selected = e; _showSelectedPanel = true; }
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Right)) { ImGui::OpenPopup("evt_ctx"); _selected = e; _showSelectedPanel = true; }
+    }
+    else {
+        hoveredGroup = g.ev;
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) { _selected = g.ev.front(); _showSelectedPanel = true; }
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Right)) { ImGui::OpenPopup("evt_ctx"); _selected = g.ev.front(); _showSelectedPanel = true; }
+    }
+}
+
 void ViewerApp::drawCategoryBlock(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax,
     float leftPad, const std::string& catName,
     const std::vector<std::vector<Event*>>& lanes,
@@ -594,37 +1119,27 @@ void ViewerApp::drawCategoryBlock(ImDrawList* dl, const ImVec2& canvasMin, const
     float& curY, Event*& hoveredEvent,
     std::vector<Event*>& hoveredGroup, size_t& visibleEventsCount)
 {
+    PROFILE_SCOPE("drawCategoryBlock");
     constexpr float kLaneH = 38.f;
     constexpr float kRectH = 22.f;
     constexpr float kCatGap = 10.f;
-    constexpr float kMinBoxW = 18.f;
-    constexpr float kGapPx = 2.f;
-
-    const int subCount = (int)std::max<size_t>(1, lanes.size());
 
     const float vx1 = canvasMin.x + leftPad + 1.0f;
     const float vx2 = canvasMax.x - 6.0f;
     const float contentW = std::max(1.0f, canvasMax.x - canvasMin.x - leftPad - 8.0f);
-
-    auto x_from_abs = [&](double absUs)->float {
-        return xFromAbsUs(absUs, canvasMin, leftPad, contentW, normStart, normEnd, timeMin, timeMax);
-        };
-    auto clamp_to_view_x = [&](float& x1, float& x2) {
-        if (x2 < vx1) x2 = vx1;
-        if (x1 > vx2) x2 = vx2;
-        x1 = std::max(x1, vx1);
-        x2 = std::min(x2, vx2);
-        };
+    const double totalUs = std::max(1.0, double(timeMax - timeMin));
+    const double visStartUs = double(timeMin) + normStart * totalUs;
+    const double pxPerUs = double(contentW) / std::max(1e-12, (normEnd - normStart) * totalUs);
+    const double laneX0 = double(canvasMin.x + leftPad);
 
     // At least 1 lane and filtered
-    std::vector<int> visibleLanes; visibleLanes.reserve(subCount);
-    for (int li = 0; li < subCount; ++li) {
+    std::vector<int> visibleLanes; visibleLanes.reserve(lanes.size());
+    std::vector<std::pair<size_t, size_t>> ranges(lanes.size());
+    for (int li = 0; li < (int)lanes.size(); ++li) {
+        ranges[li] = lane_range(lanes[li], visStartUs, double(timeMin) + normEnd * totalUs);
         bool any = false;
-        for (Event* e : lanes[li]) {
-            if (e->normEnd < normStart || e->normStart > normEnd) continue;
-            if (!passDataFilter(*e)) continue;
-            any = true; break;
-        }
+        for (size_t i = ranges[li].first; i < ranges[li].second && !any; ++i)
+            any = passDataFilter(*lanes[li][i]);
         if (any) visibleLanes.push_back(li);
     }
     if (visibleLanes.empty()) return;
@@ -660,120 +1175,306 @@ void ViewerApp::drawCategoryBlock(ImDrawList* dl, const ImVec2& canvasMin, const
         }
     }
 
-    // events (grouping adaptatif)
-    for (int packed = 0; packed < (int)visibleLanes.size(); ++packed) {
-        int li = visibleLanes[packed];
-        float laneY = curY + packed * kLaneH;
-
-        // collect visible+filtered
-        std::vector<Event*> vis; vis.reserve(lanes[li].size());
-        for (Event* e : lanes[li]) {
-            if (e->normEnd < normStart || e->normStart > normEnd) continue;
-            if (!passDataFilter(*e)) continue;
-            vis.push_back(e);
-        }
-        visibleEventsCount += vis.size();
-        if (vis.empty()) continue;
-
-        std::sort(vis.begin(), vis.end(), [](const Event* a, const Event* b) { return a->ts < b->ts; });
-
-        struct G { float x1, x2; std::vector<Event*> ev; };
-        std::vector<G> groups; groups.reserve(vis.size());
-
-        // gap adaptatif (zoom & volume)
-        float baseGapPx = 10.f / std::sqrt(std::max(1.f, _vp.zoom));
-        baseGapPx = std::clamp(baseGapPx, 1.0f, 40.0f);
-        const size_t targetGroups = 140;
-        float adapt = 1.0f;
-        if (vis.size() > targetGroups * 2) adapt = std::min(4.0f, std::sqrt(float(vis.size()) / float(targetGroups)));
-        else if (vis.size() < targetGroups / 2) adapt = 0.7f;
-        const float minGapPx = std::clamp(baseGapPx * adapt, 0.5f, 80.0f);
-
-        float curX1 = -1.f, curX2 = -1.f;
-        std::vector<Event*> bucket;
-        auto flush = [&]() {
-            if (bucket.empty()) return;
-            float gx1 = curX1 + kGapPx, gx2 = curX2 - kGapPx;
-            clamp_to_view_x(gx1, gx2);
-            if (gx2 < gx1) gx2 = gx1 + 1.f;
-            groups.push_back({ gx1, gx2, bucket });
-            bucket.clear(); curX1 = curX2 = -1.f;
-            };
+    ImGuiIO& io = ImGui::GetIO();
+    auto boxOf = [&](const LaneGroup& g, float dx, ImVec2& p1, ImVec2& p2) {
+        const float laneY = curY + g.lane * kLaneH;
+        p1 = ImVec2(g.x1 + dx, laneY + (kLaneH - kRectH) * 0.5f);
+        p2 = ImVec2(g.x2 + dx, laneY + (kLaneH + kRectH) * 0.5f);
+        };
+    auto isHovered = [&](const ImVec2& p1, const ImVec2& p2) {
+        return io.MousePos.x >= p1.x && io.MousePos.x <= p2.x && io.MousePos.y >= p1.y && io.MousePos.y <= p2.y
+            && io.MousePos.x >= vx1 && io.MousePos.x <= vx2;
+        };
+    auto isSelected = [&](const LaneGroup& g) { return _selected && g.ev.size() == 1 && _selected == g.ev.front(); };
 
-        for (Event* e : vis)
+    // ---------- tiled: composite cached tiles, render the missing ones ----------
+    if (_useTilesThisFrame && catH <= TileCache::kMaxTileH)
+    {
+        uint64_t blockKey = std::hash<std::string>{}(catName);
+        for (int li : visibleLanes) blockKey = blockKey * 1099511628211ull + uint64_t(li) + 1;
+        double pxBits = pxPerUs;
+        uint64_t scaleKey;
+        std::memcpy(&scaleKey, &pxBits, sizeof(scaleKey));
+
+        const double scrollPx = (visStartUs - double(timeMin)) * pxPerUs;
+        const int64_t firstTile = int64_t(std::floor(scrollPx / TileCache::kTileW));
+        const int64_t lastTile = int64_t(std::floor((scrollPx + contentW) / TileCache::kTileW));
+
+        struct Placed { TileCache::Tile* tile; float originX; };
+        std::vector<Placed> placed;
+        bool ok = true;
+        for (int64_t ti = firstTile; ti <= lastTile && ok; ++ti)
         {
-            float x1 = x_from_abs(double(e->ts));
-            float x2 = x_from_abs(double(e->ts + e->dur));
-            if (x2 - x1 < kMinBoxW) x2 = x1 + kMinBoxW;
+            const TileCache::Key key{ blockKey, ti, scaleKey, _tileGen };
+            // snapped so cached pixels land on the same pixel grid
+            const float originX = std::floor(float(laneX0 + double(ti) * TileCache::kTileW - scrollPx) + 0.5f);
+            TileCache::Tile* t = _tiles.find(key);
+            if (!t)
+            {
+                t = _tiles.acquire(key, ImVec2(TileCache::kTileW, catH));
+                if (!t) { ok = false; break; }
+                // tile time range (with one box width of margin for the minimum box size)
+                const double tileUs0 = double(timeMin) + double(ti) * TileCache::kTileW / pxPerUs;
+                const double tileUs1 = tileUs0 + TileCache::kTileW / pxPerUs;
+                const float densityScale = contentW / TileCache::kTileW;
+                size_t ignored = 0;
+                _tiles.beginRender(dl, *t, ImVec2(originX, curY));
+                for (int packed = 0; packed < (int)visibleLanes.size(); ++packed)
+                {
+                    const auto& lane = lanes[visibleLanes[packed]];
+                    const auto r = lane_range(lane, tileUs0 - 20.0 / pxPerUs, tileUs1);
+                    groupLaneEvents(lane, r.first, r.second, packed, originX, tileUs0, pxPerUs, originX - 1.f, originX + TileCache::kTileW + 1.f, densityScale, t->groups, ignored);
+                }
+                for (LaneGroup& g : t->groups)
+                {
+                    ImVec2 p1, p2;
+                    boxOf(g, 0.f, p1, p2);
+                    drawLaneGroup(dl, g, p1, p2, false, false, false);
+                    g.x1 -= originX;
+                    g.x2 -= originX;
+                }
+                _tiles.endRender(dl);
+            }
+            placed.push_back({ t, originX });
+        }
 
-            if (bucket.empty())
+        if (ok)
+        {
+            for (int li : visibleLanes)
             {
-                curX1 = x1; curX2 = x2; bucket = { e };
+                if (_dataFilter[0] == '\0') { visibleEventsCount += ranges[li].second - ranges[li].first; continue; }
+                for (size_t i = ranges[li].first; i < ranges[li].second; ++i)
+                    visibleEventsCount += passDataFilter(*lanes[li][i]) ? 1 : 0;
             }
-            else
+
+            dl->PushClipRect(ImVec2(vx1, curY), ImVec2(vx2, curY + catH), true);
+            _tiles.beginComposite(dl);
+            for (const Placed& p : placed)
+                dl->AddImage(TileCache::textureId(*p.tile), ImVec2(p.originX, curY), ImVec2(p.originX + p.tile->size.x, curY + p.tile->size.y), ImVec2(0, 1), ImVec2(1, 0));
+            _tiles.endComposite(dl);
+
+            // live overlays: hovered / selected groups, interaction
+            for (const Placed& p : placed)
             {
-                if (x1 <= (curX2 + minGapPx))
+                for (const LaneGroup& g : p.tile->groups)
                 {
-                    curX2 = std::max(curX2, x2);
-                    bucket.push_back(e);
-                }
-                else {
-                    flush();
-                    curX1 = x1; curX2 = x2; bucket = { e };
+                    ImVec2 p1, p2;
+                    boxOf(g, p.originX, p1, p2);
+                    const bool gHovered = isHovered(p1, p2);
+                    const bool gSelected = isSelected(g);
+                    if (gHovered || gSelected)
+                        drawLaneGroup(dl, g, p1, p2, gHovered, gSelected, false);
+                    interactLaneGroup(g, gHovered, hoveredEvent, hoveredGroup);
                 }
             }
+            dl->PopClipRect();
+
+            curY += kCatGap + catH;
+            ImGui::Separator();
+            return;
         }
-        flush();
+        // tile budget exhausted: direct drawing below
+        for (const Placed& p : placed) p.tile->lastUsed = 0;
+    }
 
-        ImGuiIO& io = ImGui::GetIO();
-        for (auto& g : groups) {
-            ImVec2 p1(g.x1, laneY + (kLaneH - kRectH) * 0.5f);
-            ImVec2 p2(g.x2, laneY + (kLaneH + kRectH) * 0.5f);
-
-            ImU32 col = color::getColorU32(g.ev.front()->color);
-            bool gHovered = (io.MousePos.x >= p1.x && io.MousePos.x <= p2.x && io.MousePos.y >= p1.y && io.MousePos.y <= p2.y);
-
-            drawEventBox(dl, p1, p2, col, gHovered, (_selected && g.ev.size() == 1 && _selected == g.ev.front()));
-            if (gHovered || (_selected && g.ev.size() == 1 && _selected == g.ev.front()))
-                drawTopBottomAccent(dl, p1, p2, color::Lighten(col, +35, 200), color::Lighten(col, -35, 200));
-
-            // label
-            if ((p2.x - p1.x) >= 28.0f) {
-                if (g.ev.size() == 1) {
-                    Event* e = g.ev.front();
-                    std::string lab = e->name.empty() ? e->category : e->name;
-                    lab = elideToWidth(lab, p2.x - p1.x - 10.f);
-                    if (!lab.empty()) drawCenteredLabel(dl, p1, p2, lab.c_str(), IM_COL32(25, 25, 25, 235));
-                }
-                else {
-                    char buf[32]; std::snprintf(buf, sizeof(buf), "(%zu)", g.ev.size());
-                    drawCenteredLabel(dl, p1, p2, buf, IM_COL32(240, 240, 240, 235));
-                }
+    // ---------- direct ----------
+    // boxes go to the instanced renderer (channel 0, one draw for the block), accents and
+    // labels stay on top in channel 1
+    const bool gpuBoxes = _gpuBoxes && _boxes.available();
+    const size_t firstBox = _boxes.size();
+    if (gpuBoxes) { dl->ChannelsSplit(2); dl->ChannelsSetCurrent(1); }
+
+    // events (grouping adaptatif)
+    std::vector<LaneGroup> groups;
+    for (int packed = 0; packed < (int)visibleLanes.size(); ++packed) {
+        const int li = visibleLanes[packed];
+        groups.clear();
+        groupLaneEvents(lanes[li], ranges[li].first, ranges[li].second, packed, laneX0, visStartUs, pxPerUs, vx1, vx2, 1.0f, groups, visibleEventsCount);
+
+        for (const LaneGroup& g : groups) {
+            ImVec2 p1, p2;
+            boxOf(g, 0.f, p1, p2);
+            const bool gHovered = isHovered(p1, p2);
+            drawLaneGroup(dl, g, p1, p2, gHovered, isSelected(g), gpuBoxes);
+            interactLaneGroup(g, gHovered, hoveredEvent, hoveredGroup);
+        }
+    }
+
+    if (gpuBoxes)
+    {
+        dl->ChannelsSetCurrent(0);
+        _boxes.submit(dl, firstBox);
+        dl->ChannelsMerge();
+    }
+
+    curY += kCatGap + catH;
+    ImGui::Separator();
+}
+
+// ---------- Async operations ----------
+// One track per stitched chain: a thin line over its whole span (suspended) and a box per
+// fragment (active). Chains are packed into lanes by span.
+void ViewerApp::drawAsyncBlock(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax,
+    float leftPad, double normStart, double normEnd, float& curY, size_t& visibleEventsCount)
+{
+    PROFILE_SCOPE("drawAsyncBlock");
+    constexpr float kLaneH = 26.f;
+    constexpr float kRectH = 16.f;
+    constexpr float kCatGap = 10.f;
+    constexpr size_t kMaxLanes = 64;
+
+    const float vx1 = canvasMin.x + leftPad + 1.0f;
+    const float vx2 = canvasMax.x - 6.0f;
+    const float contentW = std::max(1.0f, canvasMax.x - canvasMin.x - leftPad - 8.0f);
+    const double totalUs = std::max(1.0, double(_timeMax - _timeMin));
+    const double visStart = double(_timeMin) + normStart * totalUs;
+    const double visEnd = double(_timeMin) + normEnd * totalUs;
+    auto x_from_abs = [&](double absUs)->float {
+        return std::clamp(xFromAbsUs(absUs, canvasMin, leftPad, contentW, normStart, normEnd, _timeMin, _timeMax), vx1, vx2);
+        };
+    auto eventOf = [&](const AsyncChain::Fragment& f) -> Event* {
+        return f.seq >= _events.base() && f.seq - _events.base() < _events.size() ? &_events[size_t(f.seq - _events.base())] : nullptr;
+        };
+
+    // visible chains -> lanes
+    std::vector<const AsyncChain*> vis;
+    _asyncChains.forEach([&](uint32_t, const AsyncChain& c) {
+        if (!c.stitched() || double(c.tsMax) < visStart || double(c.tsMin) > visEnd) return;
+        const Event* first = eventOf(c.frags.front());
+        if (!first || !passDataFilter(*first)) return;
+        vis.push_back(&c);
+    });
+    if (vis.empty()) return;
+    std::sort(vis.begin(), vis.end(), [](const AsyncChain* a, const AsyncChain* b) { return a->tsMin < b->tsMin; });
+
+    std::vector<std::vector<const AsyncChain*>> lanes;
+    std::vector<uint64_t> laneEnd;
+    size_t hidden = 0;
+    for (const AsyncChain* c : vis)
+    {
+        size_t li = 0;
+        while (li < lanes.size() && laneEnd[li] > c->tsMin) ++li;
+        if (li == lanes.size())
+        {
+            if (lanes.size() == kMaxLanes) { ++hidden; continue; }
+            lanes.emplace_back();
+            laneEnd.push_back(0);
+        }
+        lanes[li].push_back(c);
+        laneEnd[li] = c->tsMax;
+    }
+
+    const float blockH = (float)lanes.size() * kLaneH;
+    dl->AddRectFilled(ImVec2(canvasMin.x + 8, curY - 6.f), ImVec2(canvasMin.x + leftPad - 6, curY + blockH + 6.f), IM_COL32(8, 40, 55, 220), 6.f);
+    char label[48];
+    if (hidden) std::snprintf(label, sizeof(label), "async (+%zu)", hidden);
+    else std::snprintf(label, sizeof(label), "async");
+    dl->AddText(ImVec2(canvasMin.x + 16, curY + 6.f), IM_COL32(180, 200, 220, 255), label);
+    dl->AddRectFilled(ImVec2(canvasMin.x + leftPad, curY), ImVec2(vx2, curY + blockH), IM_COL32(22, 30, 36, 200), 6.f);
+
+    ImGuiIO& io = ImGui::GetIO();
+    const AsyncChain* hovered = nullptr;
+    const AsyncChain::Fragment* hoveredFrag = nullptr;
+    size_t hoveredIdx = 0;
+    for (size_t li = 0; li < lanes.size(); ++li)
+    {
+        const float laneY = curY + float(li) * kLaneH;
+        const float midY = laneY + kLaneH * 0.5f;
+        const bool mouseInLane = io.MousePos.y >= laneY && io.MousePos.y < laneY + kLaneH;
+        for (const AsyncChain* c : lanes[li])
+        {
+            const Event* first = eventOf(c->frags.front());
+            const Swatch& sw = _colors[first ? first->paint : 0];
+            const ImU32 col = sw.fill;
+            const float x1 = x_from_abs(double(c->tsMin));
+            const float x2 = std::max(x_from_abs(double(c->tsMax)), x1 + 1.0f);
+            dl->AddLine(ImVec2(x1, midY), ImVec2(x2, midY), sw.line, 1.5f);
+
+            // fragments, coalesced below one pixel
+            float runX1 = -1.f, runX2 = -1.f;
+            auto flushRun = [&] {
+                if (runX1 < 0.f) return;
+                dl->AddRectFilled(ImVec2(runX1, midY - kRectH * 0.5f), ImVec2(runX2, midY + kRectH * 0.5f), col, 3.f);
+                runX1 = runX2 = -1.f;
+            };
+            for (const AsyncChain::Fragment& f : c->frags)
+            {
+                if (double(f.end) < visStart || double(f.ts) > visEnd) continue;
+                ++visibleEventsCount;
+                const float fx1 = x_from_abs(double(f.ts));
+                const float fx2 = std::max(x_from_abs(double(f.end)), fx1 + 1.0f);
+                if (runX1 >= 0.f && fx1 <= runX2 + 1.0f) runX2 = std::max(runX2, fx2);
+                else { flushRun(); runX1 = fx1; runX2 = fx2; }
             }
+            flushRun();
 
-            // interaction
-            if (g.ev.size() == 1) {
-                Event* e = g.ev.front();
-                if (gHovered) hoveredEvent = e;
-                if (gHovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) { _selected = e; _showSelectedPanel = true; }
-                if (gHovered && ImGui::IsMouseClicked(ImGuiMouseButton_Right)) { ImGui::OpenPopup("evt_ctx"); _selected = e; _showSelectedPanel = true; }
+            if (first && (x2 - x1) >= 40.f)
+            {
+                const std::string& lab = first->name.empty() ? first->category : first->name;
+                LabelCache::draw(dl, ImVec2(x1 + 4.f, laneY + 1.f), IM_COL32(230, 230, 230, 220), lab, _labels.fit(first->kind, lab, x2 - x1 - 8.f));
             }
-            else {
-                if (gHovered) hoveredGroup = g.ev;
-                if (gHovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) { _selected = g.ev.front(); _showSelectedPanel = true; }
-                if (gHovered && ImGui::IsMouseClicked(ImGuiMouseButton_Right)) { ImGui::OpenPopup("evt_ctx"); _selected = g.ev.front(); _showSelectedPanel = true; }
+
+            const bool selected = _selected && _selected->chain && _asyncChains.chain(_selected->chain) == c;
+            if (mouseInLane && io.MousePos.x >= x1 - 2.f && io.MousePos.x <= x2 + 2.f)
+            {
+                hovered = c;
+                // fragment under the mouse (fragments are in ts order)
+                const double tMouse = visStart + double(io.MousePos.x - (canvasMin.x + leftPad)) / contentW * (visEnd - visStart);
+                auto it = std::upper_bound(c->frags.begin(), c->frags.end(), tMouse,
+                    [](double t, const AsyncChain::Fragment& f) { return t < double(f.ts); });
+                hoveredIdx = size_t(it - c->frags.begin());
+                if (it != c->frags.begin() && tMouse <= double(std::prev(it)->end) + (visEnd - visStart) / contentW)
+                    hoveredFrag = &*std::prev(it);
             }
+            if (hovered == c || selected)
+                dl->AddRect(ImVec2(x1 - 1.f, midY - kRectH * 0.5f - 2.f), ImVec2(x2 + 1.f, midY + kRectH * 0.5f + 2.f),
+                    selected ? IM_COL32(255, 255, 255, 200) : IM_COL32(255, 255, 255, 110), 4.f);
         }
     }
 
-    curY += kCatGap + (float)visibleLanes.size() * kLaneH;
-    ImGui::Separator();
+    if (hovered)
+    {
+        const AsyncChain& c = *hovered;
+        const Event* first = eventOf(c.frags.front());
+        ImGui::BeginTooltip();
+        ImGui::Text("%s", first ? (first->name.empty() ? first->category.c_str() : first->name.c_str()) : "?");
+        ImGui::Separator();
+        ImGui::Text("Async op: id %llu  pid %u", (unsigned long long)c.id, c.pid);
+        if (c.source)
+            ImGui::Text("Source:    %s", sourceLabel(c.source).c_str());
+        ImGui::Text("Segments:  %zu", c.frags.size());
+        ImGui::Text("Span:      %s", fmtTime(double(c.spanUs())).c_str());
+        ImGui::Text("Active:    %s (%.0f%%)", fmtTime(double(c.activeUs)).c_str(), c.spanUs() ? 100.0 * double(c.activeUs) / double(c.spanUs()) : 100.0);
+        ImGui::Text("Suspended: %s", fmtTime(double(c.suspendedUs())).c_str());
+        ImGui::Separator();
+        if (hoveredFrag)
+            ImGui::Text("Segment %zu/%zu: %s", hoveredIdx, c.frags.size(), fmtTime(double(hoveredFrag->end - hoveredFrag->ts)).c_str());
+        else if (hoveredIdx > 0 && hoveredIdx < c.frags.size())
+            ImGui::Text("Suspended between %zu and %zu: %s", hoveredIdx, hoveredIdx + 1,
+                fmtTime(double(c.frags[hoveredIdx].ts - std::min(c.frags[hoveredIdx].ts, c.frags[hoveredIdx - 1].end))).c_str());
+        ImGui::EndTooltip();
+
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+        {
+            if (Event* e = eventOf(hoveredFrag ? *hoveredFrag : c.frags.front()))
+            {
+                _selected = e;
+                _showSelectedPanel = true;
+            }
+        }
+    }
+
+    curY += kCatGap + blockH;
 }
 
 // =============== timeline (main) ===============
 void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax)
 {
+    PROFILE_SCOPE("drawTimeline");
     ImGuiIO& io = ImGui::GetIO();
+    _boxes.beginFrame();
+    _tiles.beginFrame();
+    _labels.beginFrame();
 
     const double totalUs = std::max(1.0, double(_timeMax - _timeMin));
     constexpr float kLeftPad = 150.f;
@@ -864,7 +1565,26 @@ void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVe
         }
     }
 
-    if (active && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
+    // Shift+drag: time range (flame graph) instead of panning, Shift+click clears it
+    auto timeAtMouse = [&]() {
+        const double spanN = 1.0 / std::max(1e-9, double(_vp.zoom));
+        const double n = std::clamp(_vp.offset + double(cursorCX(contentW)) * spanN, 0.0, 1.0);
+        return _timeMin + uint64_t(n * totalUs);
+    };
+    if (hovered && io.KeyShift && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+    {
+        _rangeDragging = true;
+        _rangeAnchor = _rangeT0 = _rangeT1 = timeAtMouse();
+    }
+    if (_rangeDragging)
+    {
+        const uint64_t t = timeAtMouse();
+        _rangeT0 = std::min(_rangeAnchor, t);
+        _rangeT1 = std::max(_rangeAnchor, t);
+        if (!ImGui::IsMouseDown(ImGuiMouseButton_Left))
+            _rangeDragging = false;
+    }
+    else if (active && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
     {
         const ImVec2 d = io.MouseDelta;
         const double spanN = 1.0 / std::max(1e-9, double(_vp.zoom));
@@ -885,28 +1605,64 @@ void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVe
     Event* hoveredEvent = nullptr;
     std::vector<Event*> hoveredGroup;
 
-    // Category -> lanes
-    std::unordered_map<std::string, std::vector<std::vector<Event*>>> rows;
-    rows.reserve(64);
+    // cached tiles are used while the content is the same as last frame and the zoom is
+    // settled (an animated zoom would miss every frame)
+    {
+        uint64_t gen = 1469598103934665603ull;
+        auto mix = [&gen](uint64_t v) { gen = (gen ^ v) * 1099511628211ull; };
+        mix(_eventsGen); mix(_events.size()); mix(_events.base()); mix(_timeMin); mix(_timeMax); mix(_stitchAsync);
+        mix(std::hash<std::string_view>{}(_dataFilter)); mix(_dataFilterRegex); mix(_dataFilterCaseSensitive);
+        mix(_brushed.setCount); mix(uint64_t(_brushedFirst)); mix(uint64_t(_brushedLast)); mix(_brushedKind);
+        const bool stable = (gen == _tileGen);
+        if (!stable) _tiles.invalidate();
+        _tileGen = gen;
+        _useTilesThisFrame = _cacheTiles && stable && _spill.empty() && !_anim.isActive();
+    }
+
+    // (Source /) category -> lanes; several live servers => one block per (source, category).
+    // Kept while the events are unchanged (rebuilt every frame while spilled chunks are paged in).
+    std::map<std::string, std::vector<std::vector<Event*>>>& rows = _rows;
+    const RowsKey rowsKey{ _eventsGen, _events.size(), _events.base(), _stitchAsync };
+    if (!_spill.empty() || !(rowsKey == _rowsKey))
     {
+        PROFILE_SCOPE("lane layout");
+        rows.clear();
+        _rowsKey = rowsKey;
         std::lock_guard<std::mutex> lk(_mtx);
-        std::unordered_map<std::string, std::vector<Event*>> byCat;
-        byCat.reserve(64);
-        for (Event& e : _events) byCat[e.category].push_back(&e);
+        SourceGroups bySrc(1);
+        for (Event& e : _events)
+        {
+            // fragments of a stitched async operation go to the async block
+            if (_stitchAsync && e.chain && _asyncChains.stitched(e.chain)) continue;
+            groupEvent(bySrc, e);
+        }
+        if (_selected && !_spillLod.empty() && _selected >= _spillLod.data() && _selected < _spillLod.data() + _spillLod.size())
+            _selected = nullptr;
+        collectSpilled(uint64_t(std::max(0.0, visStart)), uint64_t(std::max(0.0, visEnd)), bySrc);
+        if (_selected && !_spill.empty() && !ownsEvent(_selected))
+        {
+            _selected = nullptr;
+            _showSelectedPanel = false;
+        }
 
-        for (auto& kv : byCat)
+        const bool perSource = std::count_if(bySrc.begin(), bySrc.end(), [](const auto& g) { return !g.empty(); }) > 1;
+        for (size_t src = 0; src < bySrc.size(); ++src)
         {
-            auto& evs = kv.second;
-            std::sort(evs.begin(), evs.end(), [](const Event* a, const Event* b) { return a->ts < b->ts; });
-            std::vector<std::vector<Event*>> lanes;
-            for (Event* e : evs) {
-                bool placed = false;
-                for (auto& lane : lanes) {
-                    if (lane.empty() || lane.back()->normEnd <= e->normStart) { lane.push_back(e); placed = true; break; }
+            const std::string prefix = (perSource && src) ? sourceLabel(uint16_t(src)) + " / " : std::string{};
+            for (auto& kv : bySrc[src])
+            {
+                auto& evs = kv.second;
+                std::sort(evs.begin(), evs.end(), [](const Event* a, const Event* b) { return a->ts < b->ts; });
+                std::vector<std::vector<Event*>> lanes;
+                for (Event* e : evs) {
+                    bool placed = false;
+                    for (auto& lane : lanes) {
+                        if (lane.empty() || lane.back()->ts + lane.back()->dur <= e->ts) { lane.push_back(e); placed = true; break; }
+                    }
+                    if (!placed) { lanes.emplace_back(); lanes.back().push_back(e); }
                 }
-                if (!placed) { lanes.emplace_back(); lanes.back().push_back(e); }
+                rows.emplace(prefix + kv.first, std::move(lanes));
             }
-            rows.emplace(kv.first, std::move(lanes));
         }
     }
 
@@ -919,6 +1675,24 @@ void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVe
             normStart, normEnd,
             curY, hoveredEvent, hoveredGroup, _filteredVisible);
     }
+    if (_stitchAsync && _asyncChains.liveCount())
+        drawAsyncBlock(dl, canvasMin, canvasMax, kLeftPad, normStart, normEnd, curY, _filteredVisible);
+
+    // time range selection
+    if (_rangeT1 > _rangeT0)
+    {
+        auto xAt = [&](uint64_t t) {
+            const double n = (double(t) - double(_timeMin)) / totalUs;
+            const float x = canvasMin.x + kLeftPad + float((n - normStart) / std::max(1e-18, normEnd - normStart)) * contentW;
+            return std::clamp(x, canvasMin.x + kLeftPad, canvasMax.x - kRightPad);
+        };
+        const float x0 = xAt(_rangeT0), x1 = xAt(_rangeT1);
+        const float y0 = canvasMin.y + kTopPad, y1 = canvasMax.y - 22.f;
+        if (x1 > x0)
+            dl->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), IM_COL32(255, 210, 90, 26));
+        dl->AddLine(ImVec2(x0, y0), ImVec2(x0, y1), IM_COL32(255, 210, 90, 160));
+        dl->AddLine(ImVec2(x1, y0), ImVec2(x1, y1), IM_COL32(255, 210, 90, 160));
+    }
 
     // Tooltips
     if (hoveredEvent) {
@@ -927,6 +1701,8 @@ void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVe
         ImGui::Text("%s", e->name.empty() ? e->category.c_str() : e->name.c_str());
         ImGui::Separator();
         ImGui::Text("Category: %s", e->category.c_str());
+        if (e->source)
+            ImGui::Text("Source:   %s", sourceLabel(e->source).c_str());
         ImGui::Text("Start:    %s", fmtTime(double(e->ts - (double)_timeMin)).c_str());
         ImGui::Text("Duration: %s", fmtTime(double(e->dur)).c_str());
         ImGui::Text("Data:     %s", e->data.c_str());
@@ -934,6 +1710,7 @@ void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVe
         const EventStats* S = (it != _globalStats.end() ? &it->second : (e->stats.count ? &e->stats : nullptr));
         if (S) {
             ImGui::Separator();
+            ImGui::TextDisabled("producer stats (whole session)");
             ImGui::Text("count = %llu", (unsigned long long)S->count);
             ImGui::Text("avg   = %s", fmtTime(S->avg_us).c_str());
             ImGui::Text("min   = %s", fmtTime(double(S->min_us)).c_str());
@@ -966,6 +1743,20 @@ void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVe
     if (ImGui::BeginPopup("evt_ctx")) {
         const bool hasSel = (_selected != nullptr);
         if (ImGui::MenuItem("Clear selection", nullptr, false, hasSel)) { _selected = nullptr; _showSelectedPanel = false; }
+        if (ImGui::MenuItem("Duration histogram", nullptr, false, hasSel))
+        {
+            _histKind = _selected->kind;
+            _histColor = _colors[_selected->paint].fill;
+            _histPanel.clearBrush();
+            _showHistogramPanel = true;
+        }
+        if (ImGui::MenuItem("Flame graph of this span", nullptr, false, hasSel && _selected->dur > 0))
+        {
+            _rangeT0 = _selected->ts;
+            _rangeT1 = _selected->ts + _selected->dur;
+            _flamePanel.setRange(ViewerFlamePanel::Range::Selection);
+            _showFlamePanel = true;
+        }
         ImGui::EndPopup();
     }
 
@@ -1001,8 +1792,25 @@ void ViewerApp::drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVe
 
 void ViewerApp::tick_live()
 {
-    std::vector<std::string> read;
-    _client.tick(read);
+    PROFILE_SCOPE("tick_live");
+    std::vector<LivePayload> read;
+    if (_replay.active())
+    {
+        std::vector<std::string> replayed;
+        _replay.poll(replayed);
+        read.reserve(replayed.size());
+        for (auto& str : replayed)
+            read.push_back(LivePayload{ 0, std::move(str) });
+    }
+    else
+        _client.tick(read);
+    if (_recorder.recording())
+    {
+        for (const auto& p : read)
+            _recorder.append(p.data);
+    }
+    const auto ingestStart = std::chrono::steady_clock::now();
+    IngestStats::add(_ingest.payloads, read.size());
 
     // === Capture de l’état AVANT extension des bornes ===
     const double oldTotal = std::max(1.0, double(_timeMax - _timeMin));
@@ -1017,15 +1825,83 @@ void ViewerApp::tick_live()
 
     const size_t prevE = _events.size();
     const size_t prevM = _metrics.size();
+    size_t metricsIn = 0;   // all sources, _metrics only holds the graphed one
 
-    for (const auto& str : read)
+    _liveBatch.clear();
+    const auto parseStart = std::chrono::steady_clock::now();
+    for (const auto& p : read)
     {
+        const std::string& str = p.data;
+        if (p.source >= _sourceRuns.size())
+            _sourceRuns.resize(size_t(p.source) + 1);
+        std::vector<Event>& run = _sourceRuns[p.source];
+        std::vector<Metric>& mrun = metricsOf(p.source);
+        const size_t first = run.size();
+        const size_t firstM = mrun.size();
         std::string err;
-        if (!parse_trace_payload(str, _events, _globalStats, _metrics, 0, &err))
+        bool ok;
+        if (wire::isBinary(str))
+        {
+            const uint64_t dropped = _wire.undecodable();
+            ok = _wire.decode(str, run, _globalStats, mrun, &err);
+            IngestStats::add(_ingest.undecodable, _wire.undecodable() - dropped);
+            if (!ok)
+                _lastError = err;
+        }
+        else if (!(ok = parse_trace_payload(str, run, _globalStats, mrun, 0, &err)))
             _lastError = err.empty() ? "Failed to parse: " : err;
-        if (_events.size() == prevE && _metrics.size() == prevM)
-            break;
+        IngestStats::add(ok ? _ingest.parseOk : _ingest.parseFail, 1);
+        for (size_t i = first; i < run.size(); ++i)
+            run[i].source = p.source;
+        // producer clock -> viewer clock (per host offset / drift from the PING/PONG stamps)
+        const ClockSync* clock = (_alignClocks && p.source) ? _client.clock(p.source) : nullptr;
+        if (clock)
+        {
+            for (size_t i = first; i < run.size(); ++i)
+                run[i].ts = clock->toLocal(run[i].ts);
+            for (size_t i = firstM; i < mrun.size(); ++i)
+                mrun[i].ts = clock->toLocal(mrun[i].ts);
+        }
+        metricsIn += mrun.size() - firstM;
+    }
+    // same-host producers: records straight out of their shared memory rings (no parse)
+    if (!_replay.active())
+    {
+        // bounded per tick: a full ring keeps the frames coming. Captured in the producer
+        // clock like the UDP payloads, then aligned the same way
+        _shmMetrics.clear();
+        const size_t shm = _client.drain_shm(_sourceRuns, _shmMetrics, [&](uint16_t source, size_t first, size_t firstM)
+        {
+            std::vector<Event>& run = _sourceRuns[source];
+            if (_recorder.recording())
+                recordShm(run, first, _shmMetrics, firstM);
+            if (const ClockSync* clock = _alignClocks ? _client.clock(source) : nullptr)
+            {
+                for (size_t i = first; i < run.size(); ++i)
+                    run[i].ts = clock->toLocal(run[i].ts);
+                for (size_t i = firstM; i < _shmMetrics.size(); ++i)
+                    _shmMetrics[i].ts = clock->toLocal(_shmMetrics[i].ts);
+            }
+            std::vector<Metric>& mrun = metricsOf(source);
+            mrun.insert(mrun.end(), _shmMetrics.begin() + (ptrdiff_t)firstM, _shmMetrics.end());
+            metricsIn += _shmMetrics.size() - firstM;
+        });
+        IngestStats::add(_ingest.shmRecords, shm);
+        if (shm) _frames.request(FrameScheduler::LiveData);
     }
+    // one time ordered batch out of the per source runs (keeps chunk [tsMin, tsMax] tight)
+    const auto eventByTs = [](const Event& a, const Event& b) { return a.ts < b.ts; };
+    for (auto& run : _sourceRuns)
+    {
+        if (!std::is_sorted(run.begin(), run.end(), eventByTs))
+            std::stable_sort(run.begin(), run.end(), eventByTs);
+    }
+    kway_merge(_sourceRuns, _liveBatch, [](const Event& e) { return e.ts; });
+    const auto indexStart = std::chrono::steady_clock::now();
+    IngestStats::add(_ingest.parseNs, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(indexStart - parseStart).count()));
+    IngestStats::add(_ingest.events, _liveBatch.size());
+    IngestStats::add(_ingest.metrics, metricsIn);
+    _events.append(std::move(_liveBatch));
     uint64_t newMin = UINT64_MAX, newMax = 0;
 
     for (size_t i = prevE; i < _events.size(); ++i)
@@ -1086,9 +1962,7 @@ void ViewerApp::tick_live()
         }
     }
 
-    // 4) Normalized
-    normalizeEvents(_events, _timeMin, _timeMax);
-
+    // 4) View (events are placed from their absolute ts, nothing to renormalize)
     const double newTotal = std::max(1.0, double(_timeMax - _timeMin));
     const double newSpanN = std::clamp(absSpan_old / newTotal, 1e-18, 1.0);
     const double targetZoom = 1.0 / newSpanN;
@@ -1114,25 +1988,155 @@ void ViewerApp::tick_live()
     }
     if (std::abs(newOffset - _vp.offset) > epsOff)
         _vp.offset = newOffset;
-    if (expanded)
-        normalizeEvents(_events, _timeMin, _timeMax);
-    else
-        normalizeEventsFrom(_events, prevE, _timeMin, _timeMax);
 
     // 5) _metrics sort by ts
     if (_metrics.size() > prevM)
     {
         auto mid = _metrics.begin() + (ptrdiff_t)prevM;
-        if (prevM > 0 && _metrics[prevM - 1].ts > _metrics.back().ts)
+        const auto byTs = [](const Metric& a, const Metric& b) { return a.ts < b.ts; };
+        if (!std::is_sorted(mid, _metrics.end(), byTs))
+            std::sort(mid, _metrics.end(), byTs);
+        if (prevM > 0 && _metrics[prevM - 1].ts > _metrics[prevM].ts)
         {
-            std::inplace_merge(_metrics.begin(), mid, _metrics.end(), [](const Metric& a, const Metric& b)
-            {
-                return a.ts < b.ts;
-            });
+            std::inplace_merge(_metrics.begin(), mid, _metrics.end(), byTs);
+            indexMetricsFrom(0);
         }
+        else
+            indexMetricsFrom(prevM);
+    }
+
+    indexEventsFrom(prevE);
+    if (_replay.active())
+    {
+        _replayMeter.payloads += read.size();
+        for (const auto& p : read) _replayMeter.bytes += p.data.size();
+        _replayMeter.events += _events.size() - prevE;
+        _replayMeter.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - ingestStart).count();
+    }
+    IngestStats::add(_ingest.indexNs, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - indexStart).count()));
+    {
+        IngestStageTimer retentionTimer(_ingest.retentionNs);
+        applyRetention();
     }
+    _parsedCount = _events.size();
+}
 
+// ---------- Headless benchmark ----------
+void ViewerApp::benchLoad(std::vector<Event>&& events)
+{
+    cleanup();
+    std::lock_guard<std::mutex> lk(_mtx);
+    _events.assign(std::move(events));
+    auto [tmin, tmax] = computeTimeBounds(_events);
+    _timeMin = tmin; _timeMax = tmax;
+    resetEventIndex();
+    indexEventsFrom(0);
+    _vp = {};
+    _parsedCount = _events.size();
+    _view = AppView::Text;
+}
+
+void ViewerApp::benchAppend(std::vector<Event>&& batch)
+{
+    std::lock_guard<std::mutex> lk(_mtx);
+    const size_t prevE = _events.size();
+    _events.append(std::move(batch));
+    uint64_t newMin = UINT64_MAX, newMax = 0;
+    for (size_t i = prevE; i < _events.size(); ++i)
+    {
+        const auto& e = _events[i];
+        newMin = std::min(newMin, e.ts);
+        newMax = std::max(newMax, e.ts + std::max<uint64_t>(e.dur, 1));
+    }
+    if (newMin == UINT64_MAX)
+        return;
+    if (prevE == 0)
+        _timeMin = newMin;
+    _timeMax = std::max(_timeMax, newMax);
+    indexEventsFrom(prevE);
+    applyRetention();
     _parsedCount = _events.size();
+    _view = AppView::Live;
+}
+
+void ViewerApp::benchFrame(const BenchView& v)
+{
+    _vp.zoom = v.zoom;
+    _vp.offset = v.offset;
+    _vp.panY = v.panY;
+    std::snprintf(_dataFilter, sizeof(_dataFilter), "%s", v.filter ? v.filter : "");
+    _gpuBoxes = v.gpuBoxes;
+    _cacheTiles = false;
+
+    const ImGuiViewport* vp = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(vp->WorkPos, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(vp->WorkSize, ImGuiCond_Always);
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings
+        | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse;
+    if (ImGui::Begin("Timeline##Main", nullptr, flags))
+    {
+        const ImVec2 winPos = ImGui::GetWindowPos();
+        const ImVec2 winSize = ImGui::GetWindowSize();
+        drawTimeline(ImGui::GetWindowDrawList(), winPos, ImVec2(winPos.x + winSize.x, winPos.y + winSize.y));
+    }
+    ImGui::End();
+}
+
+// ---------- Capture / replay ----------
+bool ViewerApp::startReplay(const std::string& path)
+{
+    cleanup();
+    std::string err;
+    if (!_replay.open(path, &err))
+    {
+        _lastError = err;
+        return false;
+    }
+    _replayMeter = {};
+    _view = AppView::Live;
+    return true;
+}
+
+void ViewerApp::toggleRecording()
+{
+    if (_recorder.recording())
+    {
+        _recorder.stop();
+        return;
+    }
+    char name[64];
+    const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::strftime(name, sizeof(name), "capture_%Y%m%d_%H%M%S.tcap", std::localtime(&now));
+    std::string err;
+    if (!_recorder.start(name, &err))
+        _lastError = err;
+    // fresh string table: the new file must carry its own definitions
+    _shmCapture = wire::Encoder(kShmCaptureSession);
+}
+
+// shared memory records never go through a payload: encode them as bin1 so a replay
+// of the capture shows them too (under source 0, like every replayed payload)
+void ViewerApp::recordShm(const std::vector<Event>& run, size_t first, const std::vector<Metric>& metrics, size_t firstM)
+{
+    constexpr size_t kMaxCaptureMsg = 1u << 20;
+    _shmCapture.begin();
+    for (size_t i = first; i < run.size(); ++i)
+    {
+        const Event& e = run[i];
+        _shmCapture.event(e.name, e.category, e.ts, e.dur, e.data, e.color, e.pid, e.tid, e.id);
+        if (_shmCapture.size() >= kMaxCaptureMsg)
+        {
+            _recorder.append(_shmCapture.finish());
+            _shmCapture.begin();
+        }
+    }
+    for (size_t i = firstM; i < metrics.size(); ++i)
+    {
+        const Metric& m = metrics[i];
+        _shmCapture.metric(m.ts, float(m.cpu), float(m.cpu_total), m.ram_used, m.ram_total);
+    }
+    if (_shmCapture.size() > wire::kHeaderBytes)
+        _recorder.append(_shmCapture.finish());
 }
 static bool _wantOpenFilePopup = false;
 static std::string s_open_error;
@@ -1180,6 +2184,168 @@ void ViewerApp::drawMenu()
                 cleanup();
                 _view = AppView::Startup; // conforme à ta note
             }
+            if (!_replay.active())
+            {
+                ImGui::TextDisabled("%s (%s)", _client.server_endpoint().c_str(), _client.protocol());
+                if (ImGui::BeginMenu("Servers"))
+                {
+                    // live set: one session per server, merged into this timeline
+                    const auto live = _client.sessions();
+                    for (const LiveSessionInfo& ls : live)
+                    {
+                        ImGui::PushID(ls.source);
+                        ImGui::Text("%s  %s:%u", sourceLabel(ls.source).c_str(), ls.server.ip.c_str(), ls.server.port);
+                        ImGui::SameLine();
+                        if (ls.connected)
+                            ImGui::TextDisabled("%s, %u ms", ls.protocol, ls.latency_ms);
+                        else
+                            ImGui::TextDisabled("down");
+                        if (ls.shm)
+                        {
+                            ImGui::SameLine();
+                            ImGui::TextDisabled("shm %llu records, %llu dropped", (unsigned long long)ls.shm_records, (unsigned long long)ls.shm_dropped);
+                        }
+                        if (ls.clock_synced)
+                        {
+                            ImGui::SameLine();
+                            ImGui::TextDisabled("clock %+.1f us, %+.2f ppm (delay %llu us)", ls.clock_offset_us, ls.clock_drift_ppm,
+                                (unsigned long long)ls.clock_delay_us);
+                        }
+                        ImGui::SameLine();
+                        if (ImGui::SmallButton(ls.connected ? "Drop" : "Retry"))
+                        {
+                            if (ls.connected) _client.stop_session(ls.source);
+                            else _client.start_session(ls.server);
+                        }
+                        ImGui::PopID();
+                    }
+                    ImGui::Separator();
+                    int added = 0;
+                    for (const ServerInfo& si : _client.scan())
+                    {
+                        const bool in = std::any_of(live.begin(), live.end(), [&](const LiveSessionInfo& ls) {
+                            return ls.server.ip == si.ip && ls.server.port == si.port;
+                        });
+                        if (in) continue;
+                        const std::string item = "Add " + si.name + "  " + si.ip + ":" + std::to_string(si.port);
+                        if (ImGui::MenuItem(item.c_str()))
+                            _client.start_session(si);
+                        ++added;
+                    }
+                    if (!added)
+                        ImGui::TextDisabled("No other server discovered");
+                    ImGui::Separator();
+                    ImGui::Checkbox("Align host clocks", &_alignClocks);
+                    if (live.size() > 1)
+                    {
+                        // one host's CPU / RAM at a time, the series are never merged
+                        ImGui::TextDisabled("CPU / RAM graph");
+                        for (const LiveSessionInfo& ls : live)
+                        {
+                            ImGui::PushID(ls.source);
+                            if (ImGui::RadioButton(sourceLabel(ls.source).c_str(), _metricSourceSet && _metricSource == ls.source))
+                                selectMetricSource(ls.source);
+                            ImGui::PopID();
+                        }
+                    }
+                    ImGui::EndMenu();
+                }
+                if (ImGui::MenuItem(_recorder.recording() ? "Stop recording" : "Record session", nullptr, _recorder.recording()))
+                    toggleRecording();
+                if (_recorder.recording())
+                    ImGui::TextDisabled("%s: %llu payloads, %.1f MB%s", _recorder.path().c_str(), (unsigned long long)_recorder.records(),
+                        double(_recorder.bytes()) / (1024.0 * 1024.0), _recorder.failed() ? " (write error)" : "");
+            }
+            else if (ImGui::BeginMenu("Replay"))
+            {
+                static const double kSpeeds[] = { 1.0, 10.0, 100.0, 0.0 };
+                static const char* kSpeedNames[] = { "1x", "10x", "100x", "Max" };
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (ImGui::RadioButton(kSpeedNames[i], _replay.speed() == kSpeeds[i]))
+                        _replay.setSpeed(kSpeeds[i]);
+                    if (i < 3) ImGui::SameLine();
+                }
+                const double progress = _replay.fileBytes() ? double(_replay.bytesRead()) / double(_replay.fileBytes()) : 0.0;
+                ImGui::TextDisabled("%s  %.1f%%%s", _replay.path().c_str(), progress * 100.0, _replay.finished() ? " (done)" : "");
+                ImGui::TextDisabled("Capture time: %s", fmtTime(double(_replay.position())).c_str());
+                // ingest only (parse + index), independent of the frame rate
+                const double sec = std::max(1e-9, _replayMeter.seconds);
+                ImGui::Separator();
+                ImGui::TextDisabled("Ingest: %llu payloads, %llu events in %.3f s", (unsigned long long)_replayMeter.payloads,
+                    (unsigned long long)_replayMeter.events, _replayMeter.seconds);
+                ImGui::TextDisabled("        %.0f payloads/s, %.0f events/s, %.1f MB/s", double(_replayMeter.payloads) / sec,
+                    double(_replayMeter.events) / sec, double(_replayMeter.bytes) / sec / (1024.0 * 1024.0));
+                ImGui::EndMenu();
+            }
+            ImGui::MenuItem("Ingest stats overlay", nullptr, &_showIngestPanel);
+            if (!_replay.active() && ImGui::BeginMenu("Link quality"))
+            {
+                const FrameReassembler& fr = _client.framing();
+                if (!fr.sessionCount())
+                    ImGui::TextDisabled("No framed payload received (plain datagrams carry no sequence numbers).");
+                fr.forEachSession([](uint32_t id, const FrameReassembler::SessionStats& st)
+                {
+                    const double total = double(st.messages + st.lost);
+                    ImGui::Text("Session %08X", id);
+                    ImGui::TextDisabled("  %llu messages (%.1f MB), %llu fragments", (unsigned long long)st.messages,
+                        double(st.bytes) / (1024.0 * 1024.0), (unsigned long long)st.fragments);
+                    ImGui::TextDisabled("  lost %llu (%.2f%%), duplicates %llu, reordered %llu, timeouts %llu, malformed %llu",
+                        (unsigned long long)st.lost, total > 0.0 ? 100.0 * double(st.lost) / total : 0.0,
+                        (unsigned long long)st.duplicates, (unsigned long long)st.reordered,
+                        (unsigned long long)st.timeouts, (unsigned long long)st.malformed);
+                });
+                if (const FrameReassembler::SessionStats& r = fr.retired(); r.messages || r.lost)
+                    ImGui::TextDisabled("Ended sessions: %llu messages, lost %llu", (unsigned long long)r.messages, (unsigned long long)r.lost);
+                ImGui::EndMenu();
+            }
+            if (ImGui::BeginMenu("Retention"))
+            {
+                ImGui::Checkbox("Enabled", &_retention.enabled);
+                ImGui::BeginDisabled(!_retention.enabled);
+                float winMin = float(_retention.maxWindowSec / 60.0);
+                ImGui::SetNextItemWidth(160.0f);
+                if (ImGui::SliderFloat("Window (min, 0 = off)", &winMin, 0.0f, 24.0f * 60.0f, "%.1f", ImGuiSliderFlags_Logarithmic))
+                    _retention.maxWindowSec = double(winMin) * 60.0;
+                int maxK = int(_retention.maxEvents / 1000);
+                ImGui::SetNextItemWidth(160.0f);
+                if (ImGui::InputInt("Max events (K, 0 = off)", &maxK, 100, 1000))
+                    _retention.maxEvents = uint64_t(std::max(0, maxK)) * 1000;
+                int maxMB = int(_retention.maxBytes >> 20);
+                ImGui::SetNextItemWidth(160.0f);
+                if (ImGui::InputInt("Max memory (MB, 0 = off)", &maxMB, 64, 512))
+                    _retention.maxBytes = uint64_t(std::max(0, maxMB)) << 20;
+                ImGui::Checkbox("Keep aggregates of evicted events", &_retention.keepAggregates);
+                ImGui::Checkbox("Spill evicted chunks to disk", &_retention.spillToDisk);
+                ImGui::EndDisabled();
+                ImGui::Separator();
+                ImGui::TextDisabled("Resident: %zu events (%.1f MB)", _events.size(), double(_events.bytes()) / (1024.0 * 1024.0));
+                ImGui::TextDisabled("Evicted:  %llu events, %llu metrics", (unsigned long long)_evicted.events, (unsigned long long)_evicted.metrics);
+                if (!_spill.empty())
+                    ImGui::TextDisabled("Spilled:  %llu events in %zu chunks (%.1f MB on disk)", (unsigned long long)_spill.events(), _spill.chunks().size(), double(_spill.fileBytes()) / (1024.0 * 1024.0));
+                ImGui::EndMenu();
+            }
+            ImGui::EndMenu();
+        }
+
+        // ========= VIEW =========
+        if (_view != AppView::Startup && ImGui::BeginMenu("View"))
+        {
+            ImGui::MenuItem("Stitch async operations", nullptr, &_stitchAsync);
+            ImGui::SetItemTooltip("Fragments sharing an id are drawn as one track (%zu chains)", _asyncChains.liveCount());
+            ImGui::MenuItem("GPU event boxes", nullptr, &_gpuBoxes, _boxes.available());
+            ImGui::SetItemTooltip("Instanced OpenGL boxes instead of ImDrawList rectangles");
+            ImGui::MenuItem("Cache timeline tiles", nullptr, &_cacheTiles);
+            ImGui::SetItemTooltip("Pan over cached offscreen tiles, only new tiles are drawn (%zu cached)", _tiles.size());
+            bool continuous = _frames.continuous();
+            if (ImGui::MenuItem("Redraw every frame", nullptr, &continuous))
+                _frames.setContinuous(continuous);
+            ImGui::SetItemTooltip("Off: frames are drawn on input, animation and new data only (%llu drawn)", (unsigned long long)_frames.drawn());
+            ImGui::Separator();
+            ImGui::MenuItem("Flame graph", nullptr, &_showFlamePanel);
+            ImGui::SetItemTooltip("Call tree of the nested spans (whole trace, visible range or Shift+drag selection)");
+            ImGui::MenuItem("Self profiler HUD", nullptr, &_showProfilePanel);
+            ImGui::SetItemTooltip("Frame time breakdown of the viewer, exportable as a trace file");
             ImGui::EndMenu();
         }
 
@@ -1267,6 +2433,45 @@ void ViewerApp::drawMenu()
 
 // --- drawUI (controls + timeline host) ---
 void ViewerApp::drawUI()
+{
+    PROFILE_SCOPE("drawUI");
+    drawViews();
+    scheduleRedraw();
+}
+
+// ---------- Redraw scheduling ----------
+void ViewerApp::scheduleRedraw()
+{
+    // input events NewFrame() applied this frame (mouse, keys, wheel, focus)
+    if (!ImGui::GetCurrentContext()->InputEventsTrail.empty())
+        _frames.noteInput();
+    // caret blink (ImGui: 0.8 s on / 0.4 s off)
+    if (ImGui::GetIO().WantTextInput)
+        _frames.requestIn(0.4);
+    if (_anim.isActive())
+        _frames.request(FrameScheduler::Animation);
+
+    switch (_view)
+    {
+    case AppView::Startup:
+        if (_connectView.animating())
+            _frames.request(FrameScheduler::Animation);
+        break;
+    case AppView::Text:
+        if (_autoReload && _filepath[0])
+            _frames.requestIn(std::max(0.0, double(_autoReloadInterval) - _autoReloadTimer));
+        break;
+    case AppView::Live:
+        // replay is paced by the frames; UDP datagrams wake the loop, shared memory rings are polled
+        if (_replay.active() && !_replay.finished())
+            _frames.request(FrameScheduler::LiveData);
+        else if (_client.session_count())
+            _frames.requestIn(_client.shm_active() ? 0.02 : 0.5);   // keepalive PINGs (down sessions too), telemetry
+        break;
+    }
+}
+
+void ViewerApp::drawViews()
 {
     if (_view == AppView::Startup)
     {
@@ -1291,15 +2496,20 @@ void ViewerApp::drawUI()
         _connectView.draw(avail,
             [this](const ServerInfo& s)
             {
-                if (_client.connected())
-                    _client.stop_session();
-                _client.start_session(s);
-                _view = AppView::Live;
+                // several servers may be added at once ("Connect all")
+                if (_client.start_session(s))
+                    _view = AppView::Live;
             },
             [this](const std::string_view path)
             {
                 if (_client.connected())
                     _client.stop_session();
+                // recorded sessions replay through the live path
+                if (std::filesystem::path(path).extension() == ".tcap")
+                {
+                    startReplay(std::string(path));
+                    return;
+                }
                 if (!path.empty())
                 {
                     std::memcpy(_filepath, path.data(), path.size());
@@ -1313,7 +2523,8 @@ void ViewerApp::drawUI()
         return;
     }
 
-    else if (_view == AppView::Live && _client.connected())
+    // down sessions stay in the set: tick_live keeps pinging them until they answer
+    else if (_view == AppView::Live && (_client.session_count() || _replay.active()))
         tick_live();
 
     // ====== TOP BAR MENU ======
@@ -1371,7 +2582,65 @@ void ViewerApp::drawUI()
 
     // Show selected event
     if (_showSelectedPanel && _selected) {
-        _selectedPanel.draw(_selected, _events, _mtx, _timeMin, _showSelectedPanel);
+        _selectedPanel.draw(_selected, _events, _colors, _mtx, _timeMin, _showSelectedPanel);
+        if (_selectedPanel.consumeHistogramRequest())
+        {
+            _histKind = _selected->kind;
+            _histColor = _colors[_selected->paint].fill;
+            _histPanel.clearBrush();
+            _showHistogramPanel = true;
+        }
+    }
+
+    // Ingest telemetry overlay (live only)
+    if (_view == AppView::Live)
+    {
+        _ingestRates.sample(_ingest, ImGui::GetTime());
+        if (_showIngestPanel && _ingestPanel.draw(IngestSnapshot::of(_ingest), _ingestRates, _showIngestPanel))
+        {
+            char name[64];
+            const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            std::strftime(name, sizeof(name), "ingest_stats_%Y%m%d_%H%M%S.json", std::localtime(&now));
+            std::string err;
+            if (!write_ingest_stats_json(name, IngestSnapshot::of(_ingest), _ingestRates, &err))
+                _lastError = err;
+        }
+    }
+
+    // Self profiling HUD (zones are recorded while it is shown)
+    if (_showProfilePanel && _profilePanel.draw(selfprof::report(), _showProfilePanel))
+    {
+        char name[64];
+        const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::strftime(name, sizeof(name), "viewer_profile_%Y%m%d_%H%M%S.json", std::localtime(&now));
+        std::string err;
+        if (!selfprof::exportTrace(name, &err))
+            _lastError = err;
+    }
+    selfprof::setEnabled(_showProfilePanel);
+
+    // Duration histogram of the selected kind
+    if (_showHistogramPanel && _histKind < _kinds.size())
+    {
+        const EventKindKey& k = _kinds[_histKind];
+        const std::string title = k.category + "::" + (k.name.empty() ? k.category : k.name);
+        _histPanel.draw(title, _histograms[_histKind], _histColor, _brushed.setCount, _showHistogramPanel);
+    }
+    updateBrushSelection();
+
+    // Flame graph of the panel range
+    if (_showFlamePanel)
+    {
+        ViewerFlamePanel::Status st;
+        st.collecting = _flameCollect.active;
+        st.collected = _flameCollect.end > _flameCollect.first
+            ? float(_flameCollect.next - _flameCollect.first) / float(_flameCollect.end - _flameCollect.first)
+            : 1.f;
+        st.building = _flame.busy();
+        st.hasSelection = _rangeT1 > _rangeT0;
+        const std::shared_ptr<const FlameTree> tree = _flame.result();
+        const bool refresh = _flamePanel.draw(tree, _kinds, _colors, st, _showFlamePanel);
+        updateFlameGraph(refresh);
     }
     ImGui::End();
 
@@ -1,16 +1,35 @@
 ﻿#pragma once
 #include "ViewerTimeAbsolue.hpp"
 #include "ViewerSelectedPanel.hpp"
+#include "ViewerHistogramPanel.hpp"
+#include "ViewerIngestPanel.hpp"
+#include "ViewerProfilePanel.hpp"
+#include "ViewerFlamePanel.hpp"
 #include "ViewportAnim.hpp"
 #include "ViewConnect.hpp"
 #include "model.hpp"
 #include "filter.hpp"
+#include "histogram.hpp"
+#include "metric_index.hpp"
+#include "event_store.hpp"
+#include "event_spill.hpp"
+#include "async_chains.hpp"
+#include "box_renderer.hpp"
+#include "tile_cache.hpp"
+#include "label_cache.hpp"
+#include "color_table.hpp"
+#include "capture.hpp"
+#include "wire_binary.hpp"
+#include "ingest_stats.hpp"
+#include "frame_scheduler.hpp"
+#include "flame_graph.hpp"
 
 #include <vector>
 #include <string>
 #include <mutex>
 #include <unordered_map>
 #include <filesystem>
+#include <map>
 
 /// @brief ViewerApp — class/struct documentation.
 class ViewerApp
@@ -21,10 +40,29 @@ public:
     ~ViewerApp();
 
     void drawUI();
+    // redraw requests of the subsystems, main() blocks while nothing is pending
+    FrameScheduler& frames() { return _frames; }
     bool loadFile(const char* path, uint64_t durMinUs);
     bool reloadFilePreserveView(uint64_t durMinUs);
     void updateAutoReload(const char* path);
 
+    // ---------- Headless benchmark (tools/render_bench.cpp) ----------
+    /// @brief BenchView — class/struct documentation.
+    struct BenchView
+    {
+        float  zoom = 1.f;
+        double offset = 0.0;
+        float  panY = 0.f;
+        const char* filter = "";
+        bool   gpuBoxes = false;   // instanced boxes: only their CPU side runs (no GL context)
+    };
+    // replaces the events the way loadFile() does (no file, no spill)
+    void benchLoad(std::vector<Event>&& events);
+    // appends a time ordered batch the way tick_live() does (bounds, index, retention)
+    void benchAppend(std::vector<Event>&& batch);
+    // the timeline window at v, between NewFrame() and Render(); tiles off, nothing touches GL
+    void benchFrame(const BenchView& v);
+
 private:
     /// @brief Viewport — class/struct documentation.
     struct Viewport
@@ -45,31 +83,103 @@ private:
         }
     };
 
+    // timeline grouping: source -> category -> events
+    using SourceGroups = std::vector<std::unordered_map<std::string, std::vector<Event*>>>;
+
     //
     void cleanup();
     // live pass
     void tick_live();
+    void drawViews();
+    // next frames wanted after this one (input settle, animation, live data, timers)
+    void scheduleRedraw();
     // rendering helpers
     void drawMenu();
     void drawCategoryBlock(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax, float leftPad, const std::string& catName, const std::vector<std::vector<Event*>>& lanes, uint64_t timeMin, uint64_t timeMax, double normStart, double normEnd, float& curY, Event*& hoveredEvent, std::vector<Event*>& hoveredGroup, size_t& visibleEventsCount);
     void drawTimeline(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax);
-    void drawEventBox(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, ImU32 color, bool hovered, bool selected);
+    // stitched async operations, one track per chain (active fragments + suspended gaps)
+    void drawAsyncBlock(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax, float leftPad, double normStart, double normEnd, float& curY, size_t& visibleEventsCount);
+    void groupLaneEvents(const std::vector<Event*>& lane, size_t first, size_t last, int packed, double x0, double us0, double pxPerUs, float clipX1, float clipX2, float densityScale, std::vector<LaneGroup>& out, size_t& visibleEventsCount);
+    void drawLaneGroup(ImDrawList* dl, const LaneGroup& g, const ImVec2& p1, const ImVec2& p2, bool hovered, bool selected, bool gpuBoxes);
+    void interactLaneGroup(const LaneGroup& g, bool hovered, Event*& hoveredEvent, std::vector<Event*>& hoveredGroup);
+    void drawEventBox(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, const Swatch& sw, bool hovered, bool selected);
     void drawTopBottomAccent(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, ImU32 topColor, ImU32 bottomColor);
-    void drawCenteredLabel(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, const char* text, ImU32 color);
+    void drawCenteredLabel(ImDrawList* dl, const ImVec2& p1, const ImVec2& p2, std::string_view text, const LabelCache::Fit& fit, ImU32 color);
     void drawMetricsBottom(ImDrawList* dl, const ImVec2& canvasMin, const ImVec2& canvasMax, float leftPad, float contentW, float startY, double normStart, double normEnd);
 
+    // loadFile / reloadFilePreserveView: streams the file into a cleared store (under _mtx)
+    bool streamFile(const char* path, uint64_t durMinUs, std::string& err);
     // file mtimes
     bool getFileMTime(const char* path, std::filesystem::file_time_type& out) const;
 
+    // ingest indexing (kind ids + per-kind duration histograms)
+    void resetEventIndex();
+    void indexEventsFrom(size_t beginIdx);
+    void updateBrushSelection();
+    void indexMetricsFrom(size_t beginIdx);
+    // live: metrics destination of a source, and the source shown by the CPU / RAM graph
+    std::vector<Metric>& metricsOf(uint16_t source);
+    void selectMetricSource(uint16_t source);
+    // live retention (front chunk eviction)
+    bool applyRetention();
+    void onEvictChunk(const EventStore::Chunk& chunk);
+    // spilled chunks overlapping [t0, t1] (paged in, or LOD summaries when zoomed out)
+    void collectSpilled(uint64_t t0, uint64_t t1, SourceGroups& bySrc);
+    static void groupEvent(SourceGroups& bySrc, Event& e);
+    // lane block label of a live source ("name (id)")
+    std::string sourceLabel(uint16_t source) const;
+    bool ownsEvent(const Event* e) const;
+    // session capture / replay
+    bool startReplay(const std::string& path);
+    void toggleRecording();
+    void recordShm(const std::vector<Event>& run, size_t first, const std::vector<Metric>& metrics, size_t firstM);
+
     // filters
     bool passDataFilter(const Event& e);
     void compileDataFilterIfNeeded();
+
+    // flame graph: copies the spans of the panel range a slice per frame, then builds in the background
+    void updateFlameGraph(bool force);
 private:
-    std::vector<Event> _events;
-    // by name
+    EventStore _events;
+    // live parse scratch, appended to _events each tick
+    std::vector<Event> _liveBatch;
+    // per source parse runs of the tick, k-way merged by ts into _liveBatch
+    std::vector<std::vector<Event>> _sourceRuns;
+    // rewrite live ts into the viewer clock (UdpClient::clock estimates)
+    bool _alignClocks = true;
+    RetentionPolicy _retention;
+    /// @brief EvictedSummary — class/struct documentation.
+    struct EvictedSummary
+    {
+        uint64_t events = 0;
+        uint64_t metrics = 0;
+        uint64_t tsMin = UINT64_MAX;
+        uint64_t tsMax = 0;
+    } _evicted;
+    // out-of-core backing of evicted chunks (RetentionPolicy::spillToDisk)
+    SpillFile _spill;
+    std::vector<size_t> _spillOverlap;
+    // per frame LOD boxes of spilled chunks too many to page in
+    std::vector<Event> _spillLod;
+    // by name, as reported by the producer ("stat" records): covers the whole session,
+    // retention never takes evicted events out of it
     std::unordered_map<std::string, EventStats> _globalStats;
+    // CPU / RAM of the graphed source (_metricSource); live sources are never merged,
+    // the others are kept in _sourceMetrics (indexed by source) until picked
     std::vector<Metric> _metrics;
+    std::vector<std::vector<Metric>> _sourceMetrics;
+    uint16_t _metricSource = 0;
+    bool _metricSourceSet = false;
+    // shared memory drain scratch, routed per source
+    std::vector<Metric> _shmMetrics;
     std::mutex _mtxMetrics;
+    // min/max pyramids of the metric tracks (M4 draw, range queries)
+    MetricSeriesIndex _cpuIdx{ [](const Metric& m) { return m.cpu; } };
+    MetricSeriesIndex _cpuTotalIdx{ [](const Metric& m) { return m.cpu_total; } };
+    MetricSeriesIndex _ramIdx{ [](const Metric& m) { return double(m.ram_used); } };
+    // scratch polyline, reused across frames
+    std::vector<ImVec2> _metricPts;
 
     uint64_t _timeMin, _timeMax;
 
@@ -95,7 +205,33 @@ private:
 
     // viewport
     AppView     _view;
+    // before _client: its receive thread wakes the scheduler and writes the
+    // telemetry (set_stats) until joined
+    FrameScheduler _frames;
+    // live pipeline telemetry (receive thread + tick_live stages)
+    IngestStats _ingest;
     UdpClient _client;
+    // live session recording, and replay of a capture through tick_live
+    CaptureWriter _recorder;
+    CaptureReplay _replay;
+    // same-host (shared memory) records re-encoded as bin1 payloads for the capture
+    static constexpr uint32_t kShmCaptureSession = 0x314D4853;   // "SHM1"
+    wire::Encoder _shmCapture{ kShmCaptureSession };
+    // bin1 live payloads (per producer session string tables)
+    wire::Decoder _wire;
+    IngestRates _ingestRates;
+    ViewerIngestPanel _ingestPanel;
+    bool _showIngestPanel = false;
+    ViewerProfilePanel _profilePanel;
+    bool _showProfilePanel = false;   // also turns the zone recording on
+    /// @brief IngestMeter — class/struct documentation.
+    struct IngestMeter
+    {
+        uint64_t payloads = 0;
+        uint64_t bytes = 0;
+        uint64_t events = 0;
+        double   seconds = 0.0;  // time spent in tick_live (parse + index)
+    } _replayMeter;
     ConnectView _connectView;
 
     ViewportAnim _anim;
@@ -104,6 +240,78 @@ private:
     ViewerSelectedPanel _selectedPanel;
     bool _showSelectedPanel;
 
+    // kinds (category,name) interned on ingest, one histogram per kind
+    std::unordered_map<EventKindKey, uint32_t, EventKindKeyHash> _kindIds;
+    std::vector<EventKindKey> _kinds;
+    std::vector<DurationHistogram> _histograms;
+    // colors resolved on ingest (Event::paint), with their hovered / accent variants
+    ColorTable _colors;
+    // id -> fragment chain of the async operations (Event::chain)
+    AsyncChainIndex _asyncChains;
+    bool _stitchAsync = true;
+    // timeline boxes drawn instanced (ImDrawList fallback when off or unavailable)
+    BoxRenderer _boxes;
+    bool _gpuBoxes = true;
+    // label prefix widths by kind id (elision without CalcTextSize / allocations)
+    LabelCache _labels;
+    // lane area rasterized in time aligned tiles, composited while panning
+    TileCache _tiles;
+    bool _cacheTiles = true;
+    bool _useTilesThisFrame = false;
+    uint64_t _tileGen = 0;
+    // timeline rows ((source /) category -> packed lanes), rebuilt when the events change
+    /// @brief RowsKey — class/struct documentation.
+    struct RowsKey
+    {
+        uint64_t gen = UINT64_MAX, size = 0, base = 0;
+        bool stitch = false;
+        bool operator==(const RowsKey&) const = default;
+    };
+    std::map<std::string, std::vector<std::vector<Event*>>> _rows;
+    RowsKey _rowsKey;
+    // bumped each time _events is replaced (invalidates index based caches)
+    uint64_t _eventsGen = 0;
+
+    // flame graph (span containment call tree) of a time range
+    FlameBuilder _flame;
+    ViewerFlamePanel _flamePanel;
+    bool _showFlamePanel = false;
+    /// @brief FlameCollect — class/struct documentation.
+    struct FlameCollect
+    {
+        static constexpr size_t kEventsPerFrame = size_t(1) << 20;
+        bool active = false;
+        uint64_t gen = 0;
+        uint64_t first = 0, next = 0, end = 0;   // absolute chunk numbers (base() / kChunkEvents + index)
+        uint64_t t0 = 0, t1 = 0;
+        bool byThread = false;
+        std::vector<FlameSpan> spans;
+    } _flameCollect;
+    /// @brief FlameKey — class/struct documentation.
+    struct FlameKey
+    {
+        uint64_t gen = UINT64_MAX, size = 0, base = 0, t0 = 0, t1 = 0;
+        bool byThread = false;
+        bool operator==(const FlameKey&) const = default;
+    };
+    FlameKey _flameKey;
+    double _flameCollectedAt = -1e9;
+    // Shift+drag time range on the timeline, none while _rangeT1 <= _rangeT0
+    uint64_t _rangeT0 = 0, _rangeT1 = 0;
+    uint64_t _rangeAnchor = 0;
+    bool _rangeDragging = false;
+
+    ViewerHistogramPanel _histPanel;
+    bool _showHistogramPanel = false;
+    uint32_t _histKind = 0;
+    ImU32 _histColor = 0;
+    // brushed buckets -> timeline highlight (cached, extended in live)
+    EventBitset _brushed;
+    int _brushedFirst = -1;
+    int _brushedLast = -1;
+    uint32_t _brushedKind = UINT32_MAX;
+    uint64_t _brushedGen = 0;
+
     // filtering
     char _dataFilter[128];
     bool _dataFilterCaseSensitive;
@@ -0,0 +1,269 @@
+#include "ViewerFlamePanel.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+std::string ViewerFlamePanel::nodeLabel(const FlameNode& n, const std::vector<EventKindKey>& kinds)
+{
+    if (n.kind == FlameNode::kRoot) return "all";
+    if (n.kind == FlameNode::kThread)
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "pid %u / tid %u", unsigned((n.thread >> 32) & 0xFFFFFF), unsigned(n.thread & 0xFFFFFFFF));
+        return buf;
+    }
+    if (n.kind >= kinds.size()) return "?";
+    const EventKindKey& k = kinds[n.kind];
+    return k.name.empty() ? k.category : k.name;
+}
+
+// -------------------------------------------------------------
+// Flame graph window
+// -------------------------------------------------------------
+bool ViewerFlamePanel::draw(const std::shared_ptr<const FlameTree>& tree, const std::vector<EventKindKey>& kinds, const ColorTable& colors, const Status& st, bool& p_open)
+{
+    ImGui::SetNextWindowSize(ImVec2(900, 460), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowPos(ImVec2(80, 420), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Flame graph", &p_open, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoSavedSettings))
+    {
+        ImGui::End();
+        return false;
+    }
+
+    bool rebuild = false;
+    static const char* kRanges[] = { "Whole trace", "Visible range", "Selection (Shift+drag)" };
+    int range = int(_range);
+    ImGui::SetNextItemWidth(190.f);
+    if (ImGui::Combo("##flame_range", &range, kRanges, IM_ARRAYSIZE(kRanges)))
+    {
+        _range = Range(range);
+        rebuild = true;
+    }
+    if (_range == Range::Selection && !st.hasSelection)
+        ImGui::SetItemTooltip("No selection: Shift+drag on the timeline (whole trace until then)");
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Split by thread", &_byThread)) rebuild = true;
+    ImGui::SameLine();
+    ImGui::Checkbox("Flame (root at bottom)", &_inverted);
+    ImGui::SameLine();
+    ImGui::Checkbox("Auto", &_auto);
+    ImGui::SetItemTooltip("Rebuild when the events or the range change (live: at most once per second)");
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Refresh")) rebuild = true;
+
+    if (st.collecting)
+        ImGui::Text("Collecting spans... %.0f %%", double(st.collected) * 100.0);
+    else if (st.building)
+        ImGui::TextUnformatted("Building...");
+    if (tree)
+    {
+        if (st.collecting || st.building) ImGui::SameLine();
+        ImGui::TextDisabled("%s range, %llu spans, %u threads, %zu frames, depth %u, built in %.0f ms",
+            fmtTime(double(tree->t1 - tree->t0)).c_str(), (unsigned long long)tree->spans, tree->threads,
+            tree->nodes.size(), tree->maxDepth, tree->buildMs);
+    }
+    ImGui::Separator();
+
+    // held, not just compared: a freed tree's address can come back with the next build
+    if (tree != _tree)
+    {
+        _tree = tree;
+        _focus = 0;
+        _labels.clear();   // kind ids are reassigned on reload
+        // self time by kind
+        std::unordered_map<uint32_t, size_t> at;
+        _hot.clear();
+        if (tree)
+            for (const FlameNode& n : tree->nodes)
+            {
+                if (n.kind == FlameNode::kRoot || n.kind == FlameNode::kThread) continue;
+                auto [it, added] = at.try_emplace(n.kind, _hot.size());
+                if (added) _hot.push_back({ n.kind, n.paint, 0, 0 });
+                _hot[it->second].selfUs += n.selfUs;
+                _hot[it->second].calls += n.calls;
+            }
+        std::sort(_hot.begin(), _hot.end(), [](const Hot& a, const Hot& b) { return a.selfUs > b.selfUs; });
+    }
+
+    if (!tree || tree->nodes.empty() || tree->nodes[0].totalUs == 0)
+    {
+        ImGui::TextDisabled(tree ? "No nested spans in the range." : "No flame graph yet.");
+        ImGui::End();
+        return rebuild;
+    }
+
+    const float hotW = 300.f;
+    ImGui::BeginChild("##flame_graph", ImVec2(-hotW - ImGui::GetStyle().ItemSpacing.x, 0.f));
+    drawGraph(*tree, kinds, colors);
+    ImGui::EndChild();
+    ImGui::SameLine();
+    ImGui::BeginChild("##flame_hot", ImVec2(hotW, 0.f));
+    drawHotList(*tree, kinds, colors);
+    ImGui::EndChild();
+
+    ImGui::End();
+    return rebuild;
+}
+
+// ---------- Icicle ----------
+void ViewerFlamePanel::drawGraph(const FlameTree& t, const std::vector<EventKindKey>& kinds, const ColorTable& colors)
+{
+    constexpr float kRowH = 20.f;
+    const FlameNode& focus = t.nodes[_focus];
+    // focus path, root first
+    std::vector<uint32_t> path;
+    for (uint32_t n = _focus;; n = t.nodes[n].parent)
+    {
+        path.push_back(n);
+        if (n == 0) break;
+    }
+    std::reverse(path.begin(), path.end());
+
+    const uint32_t rows = uint32_t(path.size()) + (t.maxDepth - focus.depth);
+    const float width = std::max(100.f, ImGui::GetContentRegionAvail().x);
+    const float height = std::max(ImGui::GetContentRegionAvail().y, float(rows) * kRowH);
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##flame_canvas", ImVec2(width, height));
+    const bool canvasHovered = ImGui::IsItemHovered();
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    _labels.beginFrame();
+    const float textY = (kRowH - 1.f - ImGui::GetTextLineHeight()) * 0.5f;
+    const ImVec2 clipMin = ImGui::GetWindowPos();
+    const ImVec2 clipMax(clipMin.x + ImGui::GetWindowSize().x, clipMin.y + ImGui::GetWindowSize().y);
+    int hovered = -1;
+
+    auto rowY = [&](uint32_t row) {
+        return _inverted ? origin.y + height - float(row + 1) * kRowH : origin.y + float(row) * kRowH;
+    };
+    auto frame = [&](uint32_t node, float x, float w, uint32_t row, bool dimmed) {
+        const FlameNode& n = t.nodes[node];
+        const float y = rowY(row);
+        if (y + kRowH < clipMin.y || y > clipMax.y) return;
+        const ImVec2 p1(x, y), p2(x + std::max(1.f, w - 1.f), y + kRowH - 1.f);
+        const bool isHovered = canvasHovered && mouse.x >= p1.x && mouse.x < p2.x + 1.f && mouse.y >= p1.y && mouse.y < p2.y + 1.f;
+        if (isHovered) hovered = int(node);
+
+        const bool synthetic = n.kind == FlameNode::kRoot || n.kind == FlameNode::kThread;
+        const Swatch& sw = colors[synthetic ? 0 : n.paint];
+        ImU32 fill = isHovered ? sw.hovered : sw.fill;
+        if (dimmed || (_highlightKind != UINT32_MAX && n.kind != _highlightKind))
+            fill = (fill & 0x00FFFFFF) | (IM_COL32_A_MASK & IM_COL32(0, 0, 0, 90));
+        dl->AddRectFilled(p1, p2, fill);
+
+        if (w < 24.f) return;
+        const float maxPx = w - 8.f;
+        if (synthetic || n.kind >= kinds.size())
+        {
+            const std::string s = nodeLabel(n, kinds);
+            const LabelCache::Fit f = _labels.whole(s);
+            if (f.width <= maxPx)
+                LabelCache::draw(dl, ImVec2(x + 4.f, y + textY), IM_COL32(235, 235, 235, 255), s, f);
+            return;
+        }
+        const EventKindKey& k = kinds[n.kind];
+        const std::string& s = k.name.empty() ? k.category : k.name;
+        const LabelCache::Fit f = _labels.fit(n.kind, s, maxPx);
+        if (!f.empty())
+            LabelCache::draw(dl, ImVec2(x + 4.f, y + textY), IM_COL32(15, 15, 15, 255), s, f);
+    };
+
+    // ancestors of the focus: full width, dimmed (click to go back)
+    for (uint32_t r = 0; r + 1 < path.size(); ++r)
+        frame(path[r], origin.x, width, r, true);
+
+    // the focus and its subtree, widths relative to the focus
+    /// @brief Item — class/struct documentation.
+    struct Item
+    {
+        uint32_t node;
+        float x, w;
+        uint32_t row;
+    };
+    std::vector<Item> todo{ { _focus, origin.x, width, uint32_t(path.size() - 1) } };
+    const double scale = focus.totalUs ? double(width) / double(focus.totalUs) : 0.0;
+    while (!todo.empty())
+    {
+        const Item it = todo.back();
+        todo.pop_back();
+        frame(it.node, it.x, it.w, it.row, false);
+        const FlameNode& n = t.nodes[it.node];
+        float cx = it.x;
+        for (uint32_t c = 0; c < n.childCount; ++c)
+        {
+            const uint32_t ci = t.children[n.firstChild + c];
+            const float cw = float(double(t.nodes[ci].totalUs) * scale);
+            // longest first: the remaining children are narrower still
+            if (cw < 1.f) break;
+            todo.push_back({ ci, cx, cw, it.row + 1 });
+            cx += cw;
+        }
+    }
+
+    if (hovered >= 0)
+    {
+        const FlameNode& n = t.nodes[size_t(hovered)];
+        const double rootUs = double(std::max<uint64_t>(1, t.nodes[0].totalUs));
+        ImGui::BeginTooltip();
+        ImGui::TextUnformatted(nodeLabel(n, kinds).c_str());
+        if (n.kind < kinds.size() && !kinds[n.kind].name.empty())
+            ImGui::TextDisabled("%s", kinds[n.kind].category.c_str());
+        ImGui::Separator();
+        ImGui::Text("Inclusive: %s (%.2f %%)", fmtTime(double(n.totalUs)).c_str(), 100.0 * double(n.totalUs) / rootUs);
+        ImGui::Text("Self:      %s (%.2f %%)", fmtTime(double(n.selfUs)).c_str(), 100.0 * double(n.selfUs) / rootUs);
+        if (n.calls)
+            ImGui::Text("Calls:     %llu (avg %s)", (unsigned long long)n.calls, fmtTime(double(n.totalUs) / double(n.calls)).c_str());
+        ImGui::Text("Depth:     %u", n.depth);
+        ImGui::EndTooltip();
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+            _focus = uint32_t(hovered);
+    }
+    if (canvasHovered && ImGui::IsMouseClicked(ImGuiMouseButton_Right))
+        _focus = t.nodes[_focus].parent;
+}
+
+// ---------- Self time by kind ----------
+void ViewerFlamePanel::drawHotList(const FlameTree& t, const std::vector<EventKindKey>& kinds, const ColorTable& colors)
+{
+    ImGui::TextUnformatted("Self time");
+    ImGui::SameLine();
+    ImGui::BeginDisabled(_highlightKind == UINT32_MAX);
+    if (ImGui::SmallButton("Clear highlight")) _highlightKind = UINT32_MAX;
+    ImGui::EndDisabled();
+
+    const double rootUs = double(std::max<uint64_t>(1, t.nodes[0].totalUs));
+    if (!ImGui::BeginTable("##flame_hot_table", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingStretchProp))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("kind", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("self", ImGuiTableColumnFlags_WidthFixed, 70.f);
+    ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed, 44.f);
+    ImGui::TableHeadersRow();
+    ImGuiListClipper clipper;
+    clipper.Begin(int(_hot.size()));
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+        {
+            const Hot& h = _hot[size_t(i)];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            const EventKindKey* k = h.kind < kinds.size() ? &kinds[h.kind] : nullptr;
+            const std::string label = k ? (k->name.empty() ? k->category : k->category + "::" + k->name) : "?";
+            ImGui::PushID(i);
+            ImGui::PushStyleColor(ImGuiCol_Text, colors[h.paint].fill | IM_COL32_A_MASK);
+            if (ImGui::Selectable(label.c_str(), _highlightKind == h.kind, ImGuiSelectableFlags_SpanAllColumns))
+                _highlightKind = (_highlightKind == h.kind) ? UINT32_MAX : h.kind;
+            ImGui::PopStyleColor();
+            ImGui::SetItemTooltip("%llu calls, click to highlight its frames", (unsigned long long)h.calls);
+            ImGui::PopID();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(fmtTime(double(h.selfUs)).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", 100.0 * double(h.selfUs) / rootUs);
+        }
+    }
+    ImGui::EndTable();
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+
+#include "model.hpp"
+#include "flame_graph.hpp"
+#include "color_table.hpp"
+#include "label_cache.hpp"
+
+/// @brief ViewerFlamePanel — class/struct documentation.
+class ViewerFlamePanel
+{
+public:
+    enum class Range { All, Visible, Selection };
+
+    /// @brief Status — class/struct documentation.
+    struct Status
+    {
+        bool  collecting = false;
+        float collected = 0.f;     // span copy progress, 0..1
+        bool  building = false;
+        bool  hasSelection = false;
+    };
+
+    // Draws the icicle of `tree` (root on top, or at the bottom as a flame graph) and the
+    // kinds with the most self time. Click a frame to focus it, an ancestor to go back.
+    // - kinds: Event::kind -> (category, name)
+    // - colors: Event::paint swatches
+    // Returns true when a rebuild was asked (Refresh, range or thread split changed).
+    bool draw(const std::shared_ptr<const FlameTree>& tree, const std::vector<EventKindKey>& kinds, const ColorTable& colors, const Status& st, bool& p_open);
+
+    Range range() const { return _range; }
+    void setRange(Range r) { _range = r; }
+    bool byThread() const { return _byThread; }
+    bool autoRefresh() const { return _auto; }
+
+private:
+    void drawGraph(const FlameTree& t, const std::vector<EventKindKey>& kinds, const ColorTable& colors);
+    void drawHotList(const FlameTree& t, const std::vector<EventKindKey>& kinds, const ColorTable& colors);
+    static std::string nodeLabel(const FlameNode& n, const std::vector<EventKindKey>& kinds);
+
+private:
+    Range _range = Range::All;
+    bool _byThread = false;
+    bool _auto = true;
+    bool _inverted = false;    // root at the bottom
+    // focus (node index) is reset when the tree changes
+    std::shared_ptr<const FlameTree> _tree;
+    uint32_t _focus = 0;
+    uint32_t _highlightKind = UINT32_MAX;
+    /// @brief Hot — class/struct documentation.
+    struct Hot
+    {
+        uint32_t kind;
+        uint32_t paint;
+        uint64_t selfUs;
+        uint64_t calls;
+    };
+    std::vector<Hot> _hot;     // by self time, for _tree
+    LabelCache _labels;
+};
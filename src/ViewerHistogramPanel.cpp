@@ -0,0 +1,138 @@
+#include "ViewerHistogramPanel.hpp"
+#include "color_helper.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// -------------------------------------------------------------
+// Duration histogram window (log-scale buckets)
+// -------------------------------------------------------------
+bool ViewerHistogramPanel::draw(const std::string& title, const DurationHistogram& h, ImU32 color, size_t brushedCount, bool& p_open)
+{
+    const int prevA = brushFirst(), prevB = brushLast();
+
+    ImGui::SetNextWindowSize(ImVec2(620, 380), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowPos(ImVec2(600, 60), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Duration histogram", &p_open, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoSavedSettings))
+    {
+        ImGui::End();
+        return false;
+    }
+
+    ImGui::PushStyleColor(ImGuiCol_Text, color);
+    ImGui::TextUnformatted(title.c_str());
+    ImGui::PopStyleColor();
+    ImGui::Separator();
+
+    if (h.total == 0)
+    {
+        ImGui::TextDisabled("No samples.");
+        ImGui::End();
+        return false;
+    }
+
+    ImGui::Text("count = %llu   avg = %s   min = %s   max = %s",
+        (unsigned long long)h.total, fmtTime(h.sum_us / double(h.total)).c_str(),
+        fmtTime(double(h.min_us)).c_str(), fmtTime(double(h.max_us)).c_str());
+    ImGui::Text("p50 = %s   p90 = %s   p99 = %s   p99.9 = %s",
+        fmtTime(double(h.percentile(0.50))).c_str(), fmtTime(double(h.percentile(0.90))).c_str(),
+        fmtTime(double(h.percentile(0.99))).c_str(), fmtTime(double(h.percentile(0.999))).c_str());
+    ImGui::Checkbox("Log count", &_logY);
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!hasBrush());
+    if (ImGui::SmallButton("Clear brush")) clearBrush();
+    ImGui::EndDisabled();
+    if (hasBrush())
+    {
+        ImGui::SameLine();
+        ImGui::Text("brush [%s .. %s[  ->  %zu events highlighted",
+            fmtTime(double(DurationHistogram::bucketLower(brushFirst()))).c_str(),
+            fmtTime(double(DurationHistogram::bucketUpper(brushLast()))).c_str(), brushedCount);
+    }
+
+    // ---- plot ----
+    const int b0 = h.firstBucket();
+    const int b1 = h.lastBucket();
+    const int n = std::max(1, b1 - b0 + 1);
+    uint64_t maxC = 1;
+    for (int b = b0; b <= b1; ++b) maxC = std::max(maxC, h.counts[b]);
+
+    ImVec2 avail = ImGui::GetContentRegionAvail();
+    const float axisH = ImGui::GetTextLineHeight() + 6.f;
+    ImVec2 p1 = ImGui::GetCursorScreenPos();
+    ImVec2 size(std::max(120.f, avail.x), std::max(60.f, avail.y - axisH));
+    ImGui::InvisibleButton("##hist_plot", size);
+    const bool hovered = ImGui::IsItemHovered();
+    const bool active = ImGui::IsItemActive();
+    ImVec2 p2(p1.x + size.x, p1.y + size.y);
+
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    dl->AddRectFilled(p1, ImVec2(p2.x, p2.y + axisH), IM_COL32(20, 32, 38, 190), 6.f);
+
+    const float barW = size.x / float(n);
+    auto bucketAtX = [&](float x) { return std::clamp(b0 + int((x - p1.x) / barW), b0, b1); };
+
+    // brush interaction: drag to select, right click to clear
+    ImGuiIO& io = ImGui::GetIO();
+    if (hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+    {
+        _brushA = _brushB = bucketAtX(io.MousePos.x);
+        _dragging = true;
+    }
+    if (_dragging && active)
+        _brushB = bucketAtX(io.MousePos.x);
+    if (!active)
+        _dragging = false;
+    if (hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Right))
+        clearBrush();
+
+    const double denom = _logY ? std::log1p(double(maxC)) : double(maxC);
+    const ImU32 dim = color::AlphaMul(color, 0.45f);
+    const ImU32 hot = IM_COL32(255, 156, 74, 235);
+    for (int b = b0; b <= b1; ++b)
+    {
+        const uint64_t c = h.counts[b];
+        if (!c) continue;
+        const double v = _logY ? std::log1p(double(c)) : double(c);
+        const float bh = float(v / denom) * (size.y - 4.f);
+        const float x1 = p1.x + float(b - b0) * barW;
+        const float x2 = std::max(x1 + 1.f, x1 + barW - 1.f);
+        const bool inBrush = hasBrush() && b >= brushFirst() && b <= brushLast();
+        dl->AddRectFilled(ImVec2(x1, p2.y - bh), ImVec2(x2, p2.y), inBrush ? hot : (hasBrush() ? dim : color));
+    }
+
+    // percentile markers
+    auto marker = [&](double p, const char* label)
+        {
+            const float x = p1.x + (float(DurationHistogram::bucketOf(h.percentile(p)) - b0) + 0.5f) * barW;
+            dl->AddLine(ImVec2(x, p1.y), ImVec2(x, p2.y), IM_COL32(255, 255, 255, 90), 1.0f);
+            dl->AddText(ImVec2(x + 3.f, p1.y + 2.f), IM_COL32(220, 220, 220, 200), label);
+        };
+    marker(0.50, "p50");
+    marker(0.90, "p90");
+    marker(0.99, "p99");
+
+    // x axis: ~6 labels on bucket boundaries
+    const int labelEvery = std::max(1, int(std::ceil(float(n) / std::max(1.f, size.x / 90.f))));
+    for (int b = b0; b <= b1; b += labelEvery)
+    {
+        const float x = p1.x + float(b - b0) * barW;
+        const std::string lab = fmtTime(double(DurationHistogram::bucketLower(b)));
+        dl->AddLine(ImVec2(x, p2.y), ImVec2(x, p2.y + 4.f), IM_COL32(200, 200, 200, 160));
+        dl->AddText(ImVec2(x + 2.f, p2.y + 3.f), IM_COL32(200, 200, 200, 220), lab.c_str());
+    }
+
+    if (hovered)
+    {
+        const int b = bucketAtX(io.MousePos.x);
+        ImGui::BeginTooltip();
+        ImGui::Text("[%s .. %s[", fmtTime(double(DurationHistogram::bucketLower(b))).c_str(), fmtTime(double(DurationHistogram::bucketUpper(b))).c_str());
+        ImGui::Text("count = %llu  (%.2f%%)", (unsigned long long)h.counts[b], 100.0 * double(h.counts[b]) / double(h.total));
+        ImGui::TextDisabled("drag: brush range    right click: clear");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::End();
+    return prevA != brushFirst() || prevB != brushLast();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+#include <imgui.h>
+
+#include "histogram.hpp"
+
+/// @brief ViewerHistogramPanel — class/struct documentation.
+class ViewerHistogramPanel
+{
+public:
+    // Draws the duration distribution of one event kind (precomputed histogram).
+    // - title: kind label ("category::name")
+    // - color: kind color used for the bars
+    // - brushedCount: number of events matching the current brush (timeline highlight)
+    // Returns true when the brushed bucket range changed this frame.
+    bool draw(const std::string& title, const DurationHistogram& h, ImU32 color, size_t brushedCount, bool& p_open);
+
+    // Brush (inclusive bucket range), -1 when none
+    void clearBrush() { _brushA = _brushB = -1; _dragging = false; }
+    bool hasBrush() const { return _brushA >= 0 && _brushB >= 0; }
+    int  brushFirst() const { return std::min(_brushA, _brushB); }
+    int  brushLast() const { return std::max(_brushA, _brushB); }
+
+private:
+    bool _logY = true;
+    int  _brushA = -1;
+    int  _brushB = -1;
+    bool _dragging = false;
+};
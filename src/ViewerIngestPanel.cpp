@@ -0,0 +1,74 @@
+#include "ViewerIngestPanel.hpp"
+#include <cstdio>
+
+namespace
+{
+    void rateLine(const char* label, double perSec, const char* unit)
+    {
+        if (perSec >= 1e6) ImGui::Text("%-12s %8.2f M%s/s", label, perSec * 1e-6, unit);
+        else if (perSec >= 1e3) ImGui::Text("%-12s %8.2f k%s/s", label, perSec * 1e-3, unit);
+        else ImGui::Text("%-12s %8.0f %s/s", label, perSec, unit);
+    }
+
+    void stageLine(const char* label, double load, uint64_t totalNs)
+    {
+        ImGui::Text("%-12s %6.1f%%  (%.2f s)", label, load * 100.0, double(totalNs) * 1e-9);
+    }
+}
+
+// -------------------------------------------------------------
+// Ingest telemetry overlay
+// -------------------------------------------------------------
+bool ViewerIngestPanel::draw(const IngestSnapshot& s, const IngestRates& r, bool& p_open)
+{
+    const ImGuiViewport* vp = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(vp->WorkPos.x + vp->WorkSize.x - 12.0f, vp->WorkPos.y + 34.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.78f);
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings
+        | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNavFocus | ImGuiWindowFlags_NoMove;
+    bool exportRequested = false;
+    if (!ImGui::Begin("Ingest stats", &p_open, flags))
+    {
+        ImGui::End();
+        return false;
+    }
+
+    ImGui::TextDisabled("Network");
+    rateLine("datagrams", r.datagramsPerSec, "");
+    rateLine("bytes", r.bytesPerSec, "B");
+    ImGui::Text("%-12s %8u  (high %u)", "queue", s.queueDepth, s.queueHigh);
+    if (s.kernelDrops || s.rxStalls)
+        ImGui::TextColored(ImVec4(1.0f, 0.45f, 0.35f, 1.0f), "kernel drops %llu (%.0f/s), rx stalls %llu",
+            (unsigned long long)s.kernelDrops, r.dropsPerSec, (unsigned long long)s.rxStalls);
+    else
+        ImGui::TextDisabled("no kernel drop");
+    if (s.shmRecords)
+        rateLine("shm records", r.shmRecordsPerSec, "");
+
+    ImGui::Separator();
+    ImGui::TextDisabled("Parse");
+    rateLine("events", r.eventsPerSec, "");
+    rateLine("metrics", r.metricsPerSec, "");
+    ImGui::Text("%-12s %llu ok / %llu failed", "payloads", (unsigned long long)s.parseOk, (unsigned long long)s.parseFail);
+    if (s.undecodable)
+        ImGui::TextColored(ImVec4(1.0f, 0.45f, 0.35f, 1.0f), "%-12s %llu (string definition lost)", "undecodable",
+            (unsigned long long)s.undecodable);
+
+    ImGui::Separator();
+    ImGui::TextDisabled("Stage time (share of wall clock)");
+    stageLine("recv", r.recvLoad, s.recvNs);
+    stageLine("drain", r.drainLoad, s.drainNs);
+    stageLine("parse", r.parseLoad, s.parseNs);
+    stageLine("index", r.indexLoad, s.indexNs);
+    stageLine("retention", r.retentionLoad, s.retentionNs);
+
+    ImGui::Separator();
+    if (ImGui::SmallButton("Export JSON"))
+        exportRequested = true;
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Hide"))
+        p_open = false;
+
+    ImGui::End();
+    return exportRequested;
+}
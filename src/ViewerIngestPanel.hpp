@@ -0,0 +1,13 @@
+#pragma once
+#include <imgui.h>
+
+#include "ingest_stats.hpp"
+
+/// @brief ViewerIngestPanel — class/struct documentation.
+class ViewerIngestPanel
+{
+public:
+    // Live pipeline overlay (top-right corner, semi transparent).
+    // Returns true when the user asked for a file export.
+    bool draw(const IngestSnapshot& s, const IngestRates& r, bool& p_open);
+};
@@ -0,0 +1,54 @@
+#include "ViewerProfilePanel.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+// -------------------------------------------------------------
+// Self profiling HUD
+// -------------------------------------------------------------
+bool ViewerProfilePanel::draw(const selfprof::FrameReport& r, bool& p_open)
+{
+    const ImGuiViewport* vp = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(vp->WorkPos.x + vp->WorkSize.x - 12.0f, vp->WorkPos.y + vp->WorkSize.y - 12.0f), ImGuiCond_Always, ImVec2(1.0f, 1.0f));
+    ImGui::SetNextWindowBgAlpha(0.78f);
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings
+        | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNavFocus | ImGuiWindowFlags_NoMove;
+    bool exportRequested = false;
+    if (!ImGui::Begin("Self profile", &p_open, flags))
+    {
+        ImGui::End();
+        return false;
+    }
+
+    float worst = 0.f;
+    for (float ms : r.history) worst = std::max(worst, ms);
+    ImGui::Text("Frame %6.2f ms   worst %6.2f ms (last %zu)", r.frameMs, double(worst), r.history.size());
+    if (!r.history.empty())
+        ImGui::PlotLines("##frame_ms", r.history.data(), int(r.history.size()), 0, nullptr, 0.0f, std::max(16.7f, worst), ImVec2(320.0f, 48.0f));
+
+    ImGui::Separator();
+    ImGui::TextDisabled("%-26s %6s %9s", "zone (inclusive)", "calls", "ms");
+    double top = 0.0;
+    for (const selfprof::StageTime& s : r.stages)
+    {
+        char label[64];
+        std::snprintf(label, sizeof(label), "%*s%s", int(s.depth > 0 ? (s.depth - 1) * 2 : 0), "", s.name);
+        ImGui::Text("%-26s %6u %9.3f", label, s.calls, s.ms);
+        if (s.depth <= 1) top += s.ms;
+        // share of the frame
+        const float share = r.frameMs > 0.0 ? float(s.ms / r.frameMs) : 0.f;
+        ImGui::SameLine();
+        ImGui::ProgressBar(std::clamp(share, 0.f, 1.f), ImVec2(80.0f, 0.0f), "");
+    }
+    ImGui::TextDisabled("%-26s %6s %9.3f", "(unattributed)", "", std::max(0.0, r.frameMs - top));
+
+    ImGui::Separator();
+    if (ImGui::SmallButton("Export trace"))
+        exportRequested = true;
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Hide"))
+        p_open = false;
+
+    ImGui::End();
+    return exportRequested;
+}
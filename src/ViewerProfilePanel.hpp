@@ -0,0 +1,14 @@
+#pragma once
+#include <imgui.h>
+
+#include "self_profile.hpp"
+
+/// @brief ViewerProfilePanel — class/struct documentation.
+class ViewerProfilePanel
+{
+public:
+    // Frame time HUD of the viewer itself (bottom-right corner, semi transparent):
+    // frame time history and the per zone breakdown of the last frame.
+    // Returns true when the user asked for a trace export.
+    bool draw(const selfprof::FrameReport& r, bool& p_open);
+};
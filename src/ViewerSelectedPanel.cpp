@@ -36,7 +36,7 @@
 // -------------------------------------------------------------
 // Selected event information screen
 // -------------------------------------------------------------
-void ViewerSelectedPanel::draw(const Event* sel, const std::vector<Event>& events, std::mutex& eventsMtx, uint64_t timeMin, bool& p_open)
+void ViewerSelectedPanel::draw(const Event* sel, const EventStore& events, const ColorTable& colors, std::mutex& eventsMtx, uint64_t timeMin, bool& p_open)
 {
     if (!sel) return;
 
@@ -59,7 +59,7 @@ void ViewerSelectedPanel::draw(const Event* sel, const std::vector<Event>& event
     }
 
     // Title
-    ImGui::PushStyleColor(ImGuiCol_Text, color::getColorU32(sel->color));
+    ImGui::PushStyleColor(ImGuiCol_Text, colors[sel->paint].fill);
     ImGui::Text("%s", sel->name.empty() ? sel->category.c_str() : sel->name.c_str());
     ImGui::PopStyleColor();
     ImGui::Separator();
@@ -106,7 +106,7 @@ void ViewerSelectedPanel::draw(const Event* sel, const std::vector<Event>& event
                 if (row.first_ts == UINT64_MAX)
                 {
                     row.key = typeKey;
-                    row.col_u32 = color::getColorU32(e.color);
+                    row.col_u32 = colors[e.paint].fill;
                     row.first_ts = e.ts;
                     row.min_us = 1e300;
                     row.max_us = 0.0;
@@ -139,6 +139,8 @@ void ViewerSelectedPanel::draw(const Event* sel, const std::vector<Event>& event
             ImGui::Text("min   = %s", fmtTime(gMinUs).c_str());
             ImGui::Text("max   = %s", fmtTime(gMaxUs).c_str());
         }
+        if (ImGui::SmallButton("Duration histogram"))
+            _histogramRequested = true;
     }
 
     ImGui::Spacing();
@@ -9,7 +9,8 @@
 #include <imgui.h>
 
 #include "model.hpp"
-#include "color_helper.hpp"
+#include "event_store.hpp"
+#include "color_table.hpp"
 
 /// @brief ViewerSelectedPanel — class/struct documentation.
 class ViewerSelectedPanel
@@ -17,9 +18,15 @@ class ViewerSelectedPanel
 public:
     // Draws the info window if `sel` is not null.
     // - events/eventsMtx: full dataset to compute aggregates
+    // - colors: resolved Event::paint swatches
     // - timeMin: to format absolute start (relative to file start)
-    void draw(const Event* sel, const std::vector<Event>& events, std::mutex& eventsMtx, uint64_t timeMin, bool& p_open);
+    void draw(const Event* sel, const EventStore& events, const ColorTable& colors, std::mutex& eventsMtx, uint64_t timeMin, bool& p_open);
+
+    // True once after the user asked for the duration histogram of the selection
+    bool consumeHistogramRequest() { const bool r = _histogramRequested; _histogramRequested = false; return r; }
 private:
+    bool _histogramRequested = false;
+
     /// @brief Row — class/struct documentation.
     struct Row
     {
@@ -0,0 +1,83 @@
+#include "async_chains.hpp"
+
+uint32_t AsyncChainIndex::add(const Event& e)
+{
+    if (e.id == 0)
+        return 0;
+    const Key k{ e.id, e.pid, e.source };
+    auto [it, inserted] = _byKey.try_emplace(k, 0u);
+    if (inserted)
+    {
+        uint32_t slot;
+        if (!_free.empty()) { slot = _free.back(); _free.pop_back(); }
+        else { slot = uint32_t(_chains.size()); _chains.emplace_back(); }
+        AsyncChain& c = _chains[slot];
+        c = AsyncChain{};
+        c.id = e.id;
+        c.pid = e.pid;
+        c.source = e.source;
+        c.live = true;
+        ++_live;
+        it->second = slot;
+    }
+
+    AsyncChain& c = _chains[it->second];
+    const uint64_t end = e.ts + e.dur;
+    // fragments come in end order, which is ts order unless they overlap (or batches reorder)
+    if (c.sorted && !c.frags.empty() && e.ts < c.frags.back().ts)
+    {
+        c.sorted = false;
+        _unsorted.push_back(it->second);
+    }
+    c.frags.push_back({ e.ts, end, e.seq });
+    c.tsMin = std::min(c.tsMin, e.ts);
+    c.tsMax = std::max(c.tsMax, end);
+    c.activeUs += e.dur;
+    return it->second + 1;
+}
+
+void AsyncChainIndex::sortPending()
+{
+    for (uint32_t slot : _unsorted)
+    {
+        AsyncChain& c = _chains[slot];
+        if (!c.live || c.sorted) continue;
+        std::sort(c.frags.begin(), c.frags.end(), [](const AsyncChain::Fragment& a, const AsyncChain::Fragment& b) { return a.ts < b.ts; });
+        c.sorted = true;
+    }
+    _unsorted.clear();
+}
+
+void AsyncChainIndex::recompute_(AsyncChain& c)
+{
+    c.tsMin = UINT64_MAX;
+    c.tsMax = 0;
+    c.activeUs = 0;
+    for (const AsyncChain::Fragment& f : c.frags)
+    {
+        c.tsMin = std::min(c.tsMin, f.ts);
+        c.tsMax = std::max(c.tsMax, f.end);
+        c.activeUs += f.end - f.ts;
+    }
+}
+
+void AsyncChainIndex::evictBefore(uint64_t seqBase)
+{
+    for (uint32_t slot = 0; slot < _chains.size(); ++slot)
+    {
+        AsyncChain& c = _chains[slot];
+        if (!c.live) continue;
+        const size_t before = c.frags.size();
+        std::erase_if(c.frags, [seqBase](const AsyncChain::Fragment& f) { return f.seq < seqBase; });
+        if (c.frags.size() == before) continue;
+        if (!c.frags.empty())
+        {
+            recompute_(c);
+            continue;
+        }
+        _byKey.erase(Key{ c.id, c.pid, c.source });
+        c = AsyncChain{};
+        _free.push_back(slot);
+        --_live;
+    }
+}
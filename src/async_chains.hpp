@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "model.hpp"
+
+// =============== Async chains ===============
+// A logical async operation (coroutine, asio handler chain) is sent as several fragments,
+// one per active slice between two suspension points, all carrying the same Event::id
+// (producer/trace_producer.hpp tracer::AsyncSpan). Fragments are stitched on ingest by
+// (source, pid, id) through a hash index, O(1) per event; the gaps between the fragments
+// of a chain are its suspended time.
+// Events reference their chain with Event::chain (slot + 1, 0 = none). A slot is only
+// reused once all its fragments left the store.
+/// @brief AsyncChain — class/struct documentation.
+struct AsyncChain
+{
+    /// @brief Fragment — class/struct documentation.
+    struct Fragment
+    {
+        uint64_t ts;
+        uint64_t end;
+        uint64_t seq;   // EventStore sequence number
+    };
+
+    uint64_t id = 0;
+    uint32_t pid = 0;
+    uint16_t source = 0;
+    std::vector<Fragment> frags;   // ts order (see AsyncChainIndex::sortPending)
+    uint64_t tsMin = UINT64_MAX;
+    uint64_t tsMax = 0;            // last fragment end
+    uint64_t activeUs = 0;         // sum of the fragments
+    bool     sorted = true;
+    bool     live = false;
+
+    // more than one fragment: drawn as one async track instead of loose events
+    bool stitched() const { return frags.size() >= 2; }
+    uint64_t spanUs() const { return tsMax > tsMin ? tsMax - tsMin : 0; }
+    uint64_t suspendedUs() const { return spanUs() > activeUs ? spanUs() - activeUs : 0; }
+};
+
+class AsyncChainIndex
+{
+public:
+    void clear()
+    {
+        _chains.clear();
+        _free.clear();
+        _byKey.clear();
+        _unsorted.clear();
+        _live = 0;
+    }
+
+    // events with an id join (or open) their chain; returns the Event::chain reference
+    uint32_t add(const Event& e);
+    // fragments evicted from the store (seq < seqBase) leave their chain, empty chains are freed
+    void evictBefore(uint64_t seqBase);
+    // restores ts order of the chains that received out of order fragments
+    void sortPending();
+
+    const AsyncChain* chain(uint32_t ref) const
+    {
+        return (ref && ref <= _chains.size() && _chains[ref - 1].live) ? &_chains[ref - 1] : nullptr;
+    }
+    bool stitched(uint32_t ref) const
+    {
+        const AsyncChain* c = chain(ref);
+        return c && c->stitched();
+    }
+    size_t liveCount() const { return _live; }
+
+    template <class Fn>
+    void forEach(Fn&& fn) const
+    {
+        for (uint32_t i = 0; i < _chains.size(); ++i)
+            if (_chains[i].live) fn(i + 1, _chains[i]);
+    }
+
+private:
+    /// @brief Key — class/struct documentation.
+    struct Key
+    {
+        uint64_t id;
+        uint32_t pid;
+        uint16_t source;
+        bool operator==(const Key& o) const noexcept { return id == o.id && pid == o.pid && source == o.source; }
+    };
+    /// @brief KeyHash — class/struct documentation.
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const noexcept
+        {
+            return std::hash<uint64_t>{}(k.id * 0x9E3779B97F4A7C15ull ^ (uint64_t(k.pid) << 16) ^ k.source);
+        }
+    };
+
+    void recompute_(AsyncChain& c);
+
+    std::vector<AsyncChain> _chains;
+    std::vector<uint32_t> _free;
+    std::unordered_map<Key, uint32_t, KeyHash> _byKey;
+    std::vector<uint32_t> _unsorted;
+    size_t _live = 0;
+};
@@ -0,0 +1,223 @@
+#include "box_renderer.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    // corners from gl_VertexID (triangle strip), the box is described by the instance only
+    const char* kVertexSrc = R"(#version 330 core
+layout(location = 0) in vec4 iRect;
+layout(location = 1) in vec4 iFill;
+layout(location = 2) in uint iFlags;
+uniform vec2 uDisplayPos;
+uniform vec2 uDisplaySize;
+out vec2 vLocal;
+flat out vec2 vHalf;
+out vec4 vFill;
+flat out uint vFlags;
+void main()
+{
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2 p = mix(iRect.xy, iRect.zw, corner);
+    vHalf = 0.5 * (iRect.zw - iRect.xy);
+    vLocal = (corner * 2.0 - 1.0) * vHalf;
+    vFill = iFill;
+    vFlags = iFlags;
+    vec2 ndc = (p - uDisplayPos) / uDisplaySize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
+)";
+
+    // rounded box SDF: fill, then a 1 px border composited over it, antialiased edge
+    const char* kFragmentSrc = R"(#version 330 core
+in vec2 vLocal;
+flat in vec2 vHalf;
+in vec4 vFill;
+flat in uint vFlags;
+uniform float uRounding;
+uniform vec4 uBorder;
+out vec4 oColor;
+float sdRoundBox(vec2 p, vec2 b, float r)
+{
+    vec2 q = abs(p) - b + r;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;
+}
+void main()
+{
+    float r = min(uRounding, min(vHalf.x, vHalf.y));
+    float d = sdRoundBox(vLocal, vHalf, r);
+    float aa = max(fwidth(d), 1e-4);
+    float cover = clamp(0.5 - d / aa, 0.0, 1.0);
+    vec4 c = vFill;
+    if ((vFlags & 1u) != 0u)
+    {
+        vec4 edge = vec4(mix(vFill.rgb, uBorder.rgb, uBorder.a), vFill.a + uBorder.a * (1.0 - vFill.a));
+        float inner = clamp(0.5 - (d + 1.0) / aa, 0.0, 1.0);
+        c = mix(edge, vFill, inner);
+    }
+    oColor = vec4(c.rgb, c.a * cover);
+}
+)";
+
+    GLuint compile(GLenum type, const char* src)
+    {
+        GLuint s = glCreateShader(type);
+        glShaderSource(s, 1, &src, nullptr);
+        glCompileShader(s);
+        GLint ok = GL_FALSE;
+        glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+        if (!ok)
+        {
+            char log[1024] = {};
+            glGetShaderInfoLog(s, sizeof(log), nullptr, log);
+            std::fprintf(stderr, "BoxRenderer: shader compile failed: %s\n", log);
+            glDeleteShader(s);
+            return 0;
+        }
+        return s;
+    }
+
+    ImVec4 to_float4(ImU32 c)
+    {
+        return ImVec4(float(c & 0xFF) / 255.f, float((c >> 8) & 0xFF) / 255.f, float((c >> 16) & 0xFF) / 255.f, float(c >> 24) / 255.f);
+    }
+}
+
+BoxRenderer::~BoxRenderer()
+{
+    if (_vbo) glDeleteBuffers(1, &_vbo);
+    if (_vao) glDeleteVertexArrays(1, &_vao);
+    if (_program) glDeleteProgram(_program);
+}
+
+void BoxRenderer::beginFrame()
+{
+    _instances.clear();
+    _batches.clear();
+    _uploaded = false;
+}
+
+void BoxRenderer::submit(ImDrawList* dl, size_t first)
+{
+    if (first >= _instances.size() || _failed)
+        return;
+#ifdef IMGUI_HAS_VIEWPORT
+    const ImGuiViewport* vp = ImGui::GetWindowViewport();
+#else
+    const ImGuiViewport* vp = ImGui::GetMainViewport();
+#endif
+    _batches.push_back({ this, first, _instances.size() - first, vp->Pos, vp->Size });
+    dl->AddCallback(&BoxRenderer::drawCallback, &_batches.back());
+    dl->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void BoxRenderer::drawCallback(const ImDrawList*, const ImDrawCmd* cmd)
+{
+    const Batch& b = *static_cast<const Batch*>(cmd->UserCallbackData);
+    b.owner->draw_(b, cmd);
+}
+
+bool BoxRenderer::init_()
+{
+    GLuint vs = compile(GL_VERTEX_SHADER, kVertexSrc);
+    GLuint fs = compile(GL_FRAGMENT_SHADER, kFragmentSrc);
+    if (!vs || !fs)
+    {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return false;
+    }
+    _program = glCreateProgram();
+    glAttachShader(_program, vs);
+    glAttachShader(_program, fs);
+    glLinkProgram(_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(_program, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        char log[1024] = {};
+        glGetProgramInfoLog(_program, sizeof(log), nullptr, log);
+        std::fprintf(stderr, "BoxRenderer: program link failed: %s\n", log);
+        glDeleteProgram(_program);
+        _program = 0;
+        return false;
+    }
+    _locDisplayPos = glGetUniformLocation(_program, "uDisplayPos");
+    _locDisplaySize = glGetUniformLocation(_program, "uDisplaySize");
+    _locRounding = glGetUniformLocation(_program, "uRounding");
+    _locBorder = glGetUniformLocation(_program, "uBorder");
+
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_vbo);
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    for (GLuint a = 0; a < 3; ++a)
+    {
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, 1);
+    }
+    return true;
+}
+
+void BoxRenderer::upload_()
+{
+    const size_t bytes = _instances.size() * sizeof(Instance);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    // orphan: the driver hands a fresh block instead of waiting on last frame draws
+    if (bytes > _vboBytes)
+        _vboBytes = std::max(bytes, _vboBytes * 2);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(_vboBytes), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(bytes), _instances.data());
+    _uploaded = true;
+}
+
+void BoxRenderer::draw_(const Batch& b, const ImDrawCmd* cmd)
+{
+    if (_failed)
+        return;
+    if (!_program && !init_())
+    {
+        _failed = true;
+        return;
+    }
+    glBindVertexArray(_vao);
+    if (!_uploaded)
+        upload_();
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+
+    // no base instance in GL 3.3: point the attributes at the batch
+    const size_t base = b.first * sizeof(Instance);
+    constexpr GLsizei kStride = sizeof(Instance);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, kStride, (const void*)(base + offsetof(Instance, x1)));
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, kStride, (const void*)(base + offsetof(Instance, fill)));
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, kStride, (const void*)(base + offsetof(Instance, flags)));
+
+    // scissor from the command clip rect, same mapping as the backend
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    const float sx = b.displaySize.x > 0 ? float(viewport[2]) / b.displaySize.x : 1.f;
+    const float sy = b.displaySize.y > 0 ? float(viewport[3]) / b.displaySize.y : 1.f;
+    const float cx1 = (cmd->ClipRect.x - b.displayPos.x) * sx, cy1 = (cmd->ClipRect.y - b.displayPos.y) * sy;
+    const float cx2 = (cmd->ClipRect.z - b.displayPos.x) * sx, cy2 = (cmd->ClipRect.w - b.displayPos.y) * sy;
+    if (cx2 <= cx1 || cy2 <= cy1)
+        return;
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(GLint(cx1), GLint(float(viewport[3]) - cy2), GLsizei(cx2 - cx1), GLsizei(cy2 - cy1));
+
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(_program);
+    glUniform2f(_locDisplayPos, b.displayPos.x, b.displayPos.y);
+    glUniform2f(_locDisplaySize, b.displaySize.x, b.displaySize.y);
+    glUniform1f(_locRounding, _rounding);
+    const ImVec4 border = to_float4(_border);
+    glUniform4f(_locBorder, border.x, border.y, border.z, border.w);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(b.count));
+}
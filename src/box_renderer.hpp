@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <imgui.h>
+
+// =============== Instanced event boxes (GL 3.3) ===============
+// Timeline boxes are queued as one 24 byte instance each (x1 y1 x2 y2, fill, flags) and
+// drawn from an ImDrawList callback, one instanced draw per submitted batch. The rounding
+// and the border are resolved in the fragment shader (rounded box SDF) instead of the ~40
+// vertices AddRectFilled + AddRect tessellate per box.
+// The instance buffer is re-specified (orphaned) once per frame: GL 3.3 has no persistent
+// mapping. Callbacks run inside the imgui_impl_opengl3 render pass, which restores its
+// state afterwards (ImDrawCallback_ResetRenderState).
+class BoxRenderer
+{
+public:
+    enum Flags : uint32_t { Border = 1u << 0 };
+
+    /// @brief Instance — class/struct documentation.
+    struct Instance
+    {
+        float x1, y1, x2, y2;
+        ImU32 fill;
+        uint32_t flags;
+    };
+
+    BoxRenderer() = default;
+    BoxRenderer(const BoxRenderer&) = delete;
+    BoxRenderer& operator=(const BoxRenderer&) = delete;
+    // GL objects are released here: destroy while the context is current
+    ~BoxRenderer();
+
+    // Drops the previous frame instances and batches.
+    void beginFrame();
+    void add(const ImVec2& p1, const ImVec2& p2, ImU32 fill, uint32_t flags = Border)
+    {
+        _instances.push_back({ p1.x, p1.y, p2.x, p2.y, fill, flags });
+    }
+    size_t size() const { return _instances.size(); }
+    // Draws the instances added since `first` at the current position of dl.
+    void submit(ImDrawList* dl, size_t first);
+
+    // False once the program failed to build (callers fall back to ImDrawList).
+    bool available() const { return !_failed; }
+    void setStyle(float rounding, ImU32 border) { _rounding = rounding; _border = border; }
+
+private:
+    /// @brief Batch — class/struct documentation.
+    struct Batch
+    {
+        BoxRenderer* owner;
+        size_t first;
+        size_t count;
+        ImVec2 displayPos;
+        ImVec2 displaySize;
+    };
+
+    static void drawCallback(const ImDrawList* dl, const ImDrawCmd* cmd);
+    bool init_();
+    void upload_();
+    void draw_(const Batch& b, const ImDrawCmd* cmd);
+
+private:
+    std::vector<Instance> _instances;
+    std::deque<Batch> _batches;   // stable addresses (callback user data)
+    bool _uploaded = false;
+
+    uint32_t _program = 0;
+    uint32_t _vao = 0;
+    uint32_t _vbo = 0;
+    size_t _vboBytes = 0;
+    int _locDisplayPos = -1;
+    int _locDisplaySize = -1;
+    int _locRounding = -1;
+    int _locBorder = -1;
+    bool _failed = false;
+
+    float _rounding = 5.0f;
+    ImU32 _border = IM_COL32(0, 0, 0, 140);
+};
@@ -0,0 +1,208 @@
+#include "capture.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+    // swap threshold: wake the writer once this much is pending
+    constexpr size_t kFlushBytes = 1u << 20;
+
+    template <class T>
+    inline void put(std::vector<char>& buf, const T& v)
+    {
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+}
+
+// ---------- CaptureWriter ----------
+CaptureWriter::~CaptureWriter()
+{
+    stop();
+}
+
+bool CaptureWriter::start(const std::string& path, std::string* err)
+{
+    stop();
+    _f = std::fopen(path.c_str(), "wb");
+    if (!_f)
+    {
+        if (err) *err = "Unable to create capture file " + path;
+        return false;
+    }
+    _path = path;
+    _front.clear();
+    _back.clear();
+    _front.reserve(kFlushBytes * 2);
+    _back.reserve(kFlushBytes * 2);
+    _front.insert(_front.end(), capture::kMagic, capture::kMagic + 4);
+    put(_front, capture::kVersion);
+    _records = 0;
+    _bytes = capture::kHeaderBytes;
+    _failed = false;
+    _stop = false;
+    _t0 = std::chrono::steady_clock::now();
+    _recording = true;
+    _thread = std::thread([this] { run_(); });
+    return true;
+}
+
+void CaptureWriter::stop()
+{
+    if (!_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        _stop = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+    std::fclose(_f);
+    _f = nullptr;
+    _recording = false;
+}
+
+void CaptureWriter::append(std::string_view payload)
+{
+    if (!recording()) return;
+    const uint64_t us = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - _t0).count());
+    size_t pending;
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        put(_front, us);
+        put(_front, uint32_t(payload.size()));
+        _front.insert(_front.end(), payload.begin(), payload.end());
+        pending = _front.size();
+    }
+    _records.fetch_add(1, std::memory_order_relaxed);
+    _bytes.fetch_add(capture::kRecordHeaderBytes + payload.size(), std::memory_order_relaxed);
+    if (pending >= kFlushBytes)
+        _cv.notify_one();
+}
+
+void CaptureWriter::run_()
+{
+    for (;;)
+    {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lk(_mtx);
+            _cv.wait_for(lk, std::chrono::milliseconds(250), [this] { return _stop || _front.size() >= kFlushBytes; });
+            _front.swap(_back);
+            stopping = _stop;
+        }
+        if (!_back.empty())
+        {
+            if (std::fwrite(_back.data(), 1, _back.size(), _f) != _back.size())
+                _failed = true;
+            _back.clear();
+            std::fflush(_f);
+        }
+        if (stopping)
+            break;
+    }
+}
+
+// ---------- CaptureReplay ----------
+bool CaptureReplay::open(const std::string& path, std::string* err)
+{
+    close();
+    _in.open(path, std::ios::binary);
+    if (!_in.is_open())
+    {
+        if (err) *err = "Unable to open capture " + path;
+        return false;
+    }
+    char head[capture::kHeaderBytes];
+    uint32_t version = 0;
+    if (!_in.read(head, sizeof(head)) || std::memcmp(head, capture::kMagic, 4) != 0
+        || (std::memcpy(&version, head + 4, 4), version != capture::kVersion))
+    {
+        if (err) *err = "Not a trace capture: " + path;
+        close();
+        return false;
+    }
+    std::error_code ec;
+    _fileBytes = uint64_t(std::filesystem::file_size(path, ec));
+    _path = path;
+    _pos = capture::kHeaderBytes;
+    _records = 0;
+    _finished = false;
+    _pending = false;
+    _lastUs = 0;
+    _anchorUs = 0;
+    _anchorWall = std::chrono::steady_clock::now();
+    return true;
+}
+
+void CaptureReplay::close()
+{
+    if (_in.is_open()) _in.close();
+    _in.clear();
+    _pending = false;
+    _pendingPayload.clear();
+    _finished = false;
+}
+
+uint64_t CaptureReplay::captureNowUs_() const
+{
+    const double wallUs = double(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - _anchorWall).count());
+    return _anchorUs + uint64_t(wallUs * _speed);
+}
+
+void CaptureReplay::setSpeed(double speed)
+{
+    // re-anchor so the capture clock stays continuous
+    _anchorUs = (_speed > 0.0) ? captureNowUs_() : _lastUs;
+    _anchorWall = std::chrono::steady_clock::now();
+    _speed = std::max(0.0, speed);
+}
+
+bool CaptureReplay::readNext_()
+{
+    char head[capture::kRecordHeaderBytes];
+    if (!_in.read(head, sizeof(head)))
+        return false;
+    uint32_t len = 0;
+    std::memcpy(&_pendingUs, head, 8);
+    std::memcpy(&len, head + 8, 4);
+    _pendingPayload.resize(len);
+    if (len && !_in.read(_pendingPayload.data(), std::streamsize(len)))
+        return false;
+    _pos += capture::kRecordHeaderBytes + len;
+    return true;
+}
+
+void CaptureReplay::poll(std::vector<std::string>& out)
+{
+    if (!active() || _finished) return;
+
+    const bool maxSpeed = _speed <= 0.0;
+    const uint64_t due = maxSpeed ? UINT64_MAX : captureNowUs_();
+    size_t budget = kMaxBytesPerPoll;
+    for (;;)
+    {
+        if (!_pending)
+        {
+            if (!readNext_()) { _finished = true; break; }
+            _pending = true;
+        }
+        if (_pendingUs > due) break;
+        if (maxSpeed && _pendingPayload.size() > budget && budget != kMaxBytesPerPoll) break;
+
+        budget -= std::min(budget, _pendingPayload.size());
+        _lastUs = _pendingUs;
+        out.push_back(std::move(_pendingPayload));
+        _pendingPayload = {};
+        _pending = false;
+        ++_records;
+        if (maxSpeed && budget == 0) break;
+    }
+    if (maxSpeed)
+    {
+        _anchorUs = _lastUs;
+        _anchorWall = std::chrono::steady_clock::now();
+    }
+}
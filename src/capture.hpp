@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// =============== Capture file ===============
+// Append-only record of the received payloads (one per datagram):
+//   file   : "TCAP" | u32 version
+//   record : u64 arrival_us | u32 len | payload[len]
+// arrival_us is relative to the recording start (steady clock). Same-host sessions read
+// through shared memory have no datagram: their records are stored as bin1 payloads
+// encoded by the viewer (session "SHM1").
+namespace capture
+{
+    inline constexpr char     kMagic[4] = { 'T', 'C', 'A', 'P' };
+    inline constexpr uint32_t kVersion = 1;
+    inline constexpr size_t   kHeaderBytes = 8;
+    inline constexpr size_t   kRecordHeaderBytes = 12;
+}
+
+// =============== Recorder ===============
+// append() only copies into the front buffer; a writer thread swaps and flushes it,
+// so the UI never waits on disk IO.
+class CaptureWriter
+{
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool start(const std::string& path, std::string* err = nullptr);
+    void stop();
+    bool recording() const { return _recording.load(std::memory_order_relaxed); }
+
+    void append(std::string_view payload);
+
+    const std::string& path() const { return _path; }
+    uint64_t records() const { return _records.load(std::memory_order_relaxed); }
+    uint64_t bytes() const { return _bytes.load(std::memory_order_relaxed); }
+    bool failed() const { return _failed.load(std::memory_order_relaxed); }
+
+private:
+    void run_();
+
+private:
+    std::FILE* _f = nullptr;
+    std::string _path;
+    std::thread _thread;
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::vector<char> _front;   // filled by append (under _mtx)
+    std::vector<char> _back;    // owned by the writer thread
+    bool _stop = false;
+    std::chrono::steady_clock::time_point _t0{};
+
+    std::atomic<bool> _recording{ false };
+    std::atomic<bool> _failed{ false };
+    std::atomic<uint64_t> _records{ 0 };
+    std::atomic<uint64_t> _bytes{ 0 };
+};
+
+// =============== Replay ===============
+// Streams a capture back at 1x / Nx (arrival times scaled) or as fast as possible
+// (speed 0, bounded per poll so the UI keeps drawing).
+class CaptureReplay
+{
+public:
+    static constexpr size_t kMaxBytesPerPoll = 4u << 20;
+
+    bool open(const std::string& path, std::string* err = nullptr);
+    void close();
+    bool active() const { return _in.is_open(); }
+    bool finished() const { return _finished; }
+
+    // 0 = max speed
+    void setSpeed(double speed);
+    double speed() const { return _speed; }
+
+    // payloads due now (appended to out)
+    void poll(std::vector<std::string>& out);
+
+    const std::string& path() const { return _path; }
+    uint64_t records() const { return _records; }
+    uint64_t bytesRead() const { return _pos; }
+    uint64_t fileBytes() const { return _fileBytes; }
+    // capture time reached (us)
+    uint64_t position() const { return _lastUs; }
+
+private:
+    bool readNext_();
+    uint64_t captureNowUs_() const;
+
+private:
+    std::ifstream _in;
+    std::string _path;
+    uint64_t _fileBytes = 0;
+    uint64_t _pos = 0;
+    uint64_t _records = 0;
+    bool _finished = false;
+
+    bool _pending = false;
+    uint64_t _pendingUs = 0;
+    std::string _pendingPayload;
+    uint64_t _lastUs = 0;
+
+    double _speed = 1.0;
+    // capture clock = _anchorUs + (now - _anchorWall) * speed
+    uint64_t _anchorUs = 0;
+    std::chrono::steady_clock::time_point _anchorWall{};
+};
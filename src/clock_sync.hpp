@@ -0,0 +1,120 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// =============== Clock sync ===============
+// NTP style estimate of a producer clock against the viewer wall clock (us), fed by the
+// PING/PONG keepalive:
+//   t1 PING sent (viewer)   t2 PING received (producer)   t3 PONG sent (producer)   t4 PONG received (viewer)
+//   offset = ((t2 - t1) + (t3 - t4)) / 2     delay = (t4 - t1) - (t3 - t2)
+// Queueing only ever adds delay (and skews the offset by up to delay / 2), so the estimate
+// keeps the fastest exchange of each slice of the window and fits
+// offset(t) = offset + drift * (t - ref) on them (least squares) to follow the clock drift.
+class ClockSync
+{
+public:
+    static constexpr size_t kWindow = 64;
+    static constexpr size_t kSlices = 8;
+    static constexpr double kMaxDriftPpm = 500.0;
+
+    /// @brief Sample — class/struct documentation.
+    struct Sample
+    {
+        double   t;        // viewer time of the exchange (midpoint of t1, t4)
+        double   offset;   // producer - viewer (us)
+        uint64_t delay;    // round trip minus producer processing (us)
+    };
+
+    void reset() { *this = ClockSync{}; }
+
+    // returns false for inconsistent stamps (sample dropped)
+    bool addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4)
+    {
+        if (t4 < t1 || t3 < t2 || (t4 - t1) < (t3 - t2))
+            return false;
+        Sample s;
+        s.t = 0.5 * (double(t1) + double(t4));
+        s.offset = 0.5 * ((double(t2) - double(t1)) + (double(t3) - double(t4)));
+        s.delay = (t4 - t1) - (t3 - t2);
+        _samples.push_back(s);
+        if (_samples.size() > kWindow)
+            _samples.pop_front();
+        refit_();
+        return true;
+    }
+
+    bool   valid() const { return !_samples.empty(); }
+    size_t samples() const { return _samples.size(); }
+    // estimated producer - viewer offset at viewer time t (us)
+    double offsetAt(double t) const { return _offset + _drift * (t - _ref); }
+    // latest estimate
+    double offsetUs() const { return _samples.empty() ? 0.0 : offsetAt(_samples.back().t); }
+    double driftPpm() const { return _drift * 1e6; }
+    uint64_t minDelayUs() const { return _minDelay; }
+    // samples the current fit rests on
+    size_t used() const { return _used; }
+
+    // producer timestamp -> viewer time base
+    uint64_t toLocal(uint64_t remoteUs) const
+    {
+        if (_samples.empty()) return remoteUs;
+        const double r = double(remoteUs);
+        const double local = r - offsetAt(r - _offset);
+        return local <= 0.0 ? 0 : uint64_t(std::llround(local));
+    }
+
+private:
+    void refit_()
+    {
+        // one point per slice of the window: its fastest exchange (spread over time for the drift)
+        _minDelay = UINT64_MAX;
+        for (const Sample& s : _samples) _minDelay = std::min(_minDelay, s.delay);
+        _fit.clear();
+        const size_t per = (_samples.size() + kSlices - 1) / kSlices;
+        for (size_t i = 0; i < _samples.size(); i += per)
+        {
+            const Sample* best = &_samples[i];
+            for (size_t j = i + 1; j < std::min(_samples.size(), i + per); ++j)
+                if (_samples[j].delay < best->delay) best = &_samples[j];
+            // a slice without one fast exchange would only add noise
+            if (best->delay <= 2 * _minDelay + 200)
+                _fit.push_back(best);
+        }
+        _used = _fit.size();
+
+        double mt = 0.0, mo = 0.0;
+        for (const Sample* s : _fit) { mt += s->t; mo += s->offset; }
+        mt /= double(_fit.size());
+        mo /= double(_fit.size());
+        double sxx = 0.0, sxy = 0.0;
+        for (const Sample* s : _fit)
+        {
+            sxx += (s->t - mt) * (s->t - mt);
+            sxy += (s->t - mt) * (s->offset - mo);
+        }
+        // drift needs a few seconds of spread to mean anything
+        _drift = (_fit.size() >= 3 && sxx > 1e12) ? std::clamp(sxy / sxx, -kMaxDriftPpm * 1e-6, kMaxDriftPpm * 1e-6) : 0.0;
+        _ref = mt;
+        _offset = mo;
+    }
+
+private:
+    std::deque<Sample> _samples;
+    std::vector<const Sample*> _fit;
+    double   _offset = 0.0;
+    double   _drift = 0.0;
+    double   _ref = 0.0;
+    uint64_t _minDelay = 0;
+    size_t   _used = 0;
+};
+
+// viewer wall clock, same base as the producers' "ts" (us since epoch)
+inline uint64_t clock_now_us()
+{
+    using namespace std::chrono;
+    return uint64_t(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+}
@@ -0,0 +1,87 @@
+#include "color_table.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "color_helper.hpp"
+
+namespace
+{
+    // default palette for events without a color, picked by category hash (stable across runs)
+    constexpr color::Color kCategoryPalette[] = {
+        color::Color::Blue, color::Color::Green, color::Color::Orange, color::Color::Purple,
+        color::Color::Teal, color::Color::Amber, color::Color::Pink, color::Color::Indigo,
+        color::Color::Cyan, color::Color::Lime, color::Color::Red, color::Color::Magenta,
+        color::Color::Yellow, color::Color::Slate, color::Color::Brown,
+    };
+
+    uint64_t fnv1a(std::string_view s)
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (unsigned char c : s) { h ^= c; h *= 1099511628211ull; }
+        return h;
+    }
+
+    Swatch make_swatch(ImU32 fill)
+    {
+        Swatch s;
+        s.fill = fill;
+        s.hovered = color::AdjustRGB(fill, +20);
+        s.accentTop = color::Lighten(fill, +35, 200);
+        s.accentBottom = color::Lighten(fill, -35, 200);
+        s.line = color::Lighten(fill, -60, 160);
+        return s;
+    }
+}
+
+ColorTable::ColorTable()
+{
+    clear();
+}
+
+void ColorTable::clear()
+{
+    _swatches.clear();
+    _byColor.clear();
+    _byCategory.clear();
+    _byFill.clear();
+    // not in _byFill: an explicit "#AAAAAA" still gets its own (non zero) swatch
+    _swatches.push_back(make_swatch(IM_COL32(170, 170, 170, 255)));
+}
+
+uint32_t ColorTable::add_(ImU32 fill)
+{
+    auto [it, inserted] = _byFill.try_emplace(fill, uint32_t(_swatches.size()));
+    if (inserted)
+        _swatches.push_back(make_swatch(fill));
+    return it->second;
+}
+
+uint32_t ColorTable::internColor(const std::string& hex)
+{
+    if (auto it = _byColor.find(hex); it != _byColor.end())
+        return it->second;
+    // invalid strings are remembered as 0 (category palette)
+    uint8_t r, g, b, a;
+    const uint32_t paint = color::parseHexRGB(hex, r, g, b, a) ? add_(IM_COL32(r, g, b, a)) : 0;
+    _byColor.emplace(hex, paint);
+    return paint;
+}
+
+uint32_t ColorTable::category_(const std::string& category)
+{
+    if (auto it = _byCategory.find(category); it != _byCategory.end())
+        return it->second;
+    const color::Color c = kCategoryPalette[fnv1a(category) % std::size(kCategoryPalette)];
+    const uint32_t paint = add_(color::getColorU32(c));
+    _byCategory.emplace(category, paint);
+    return paint;
+}
+
+uint32_t ColorTable::intern(const Event& e)
+{
+    if (!e.color.empty())
+        if (const uint32_t paint = internColor(e.color))
+            return paint;
+    return category_(e.category);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <imgui.h>
+
+#include "model.hpp"
+
+// =============== Event colors ===============
+// Colors are resolved once at ingest: every unique "#RRGGBB[AA]" string, or the category
+// when an event has none (or an invalid one), gets a Swatch with the packed colors the
+// timeline draws with. Events carry its index (Event::paint), so drawing never parses.
+// Index 0 is the neutral gray of events that were never interned.
+
+/// @brief Swatch — class/struct documentation.
+struct Swatch
+{
+    ImU32 fill = 0;
+    ImU32 hovered = 0;        // fill, hovered box
+    ImU32 accentTop = 0;      // hovered / selected box accents
+    ImU32 accentBottom = 0;
+    ImU32 line = 0;           // async chain suspended gaps
+};
+
+class ColorTable
+{
+public:
+    ColorTable();
+
+    // swatch index of e (color string, else category palette)
+    uint32_t intern(const Event& e);
+    uint32_t internColor(const std::string& hex);
+    const Swatch& operator[](uint32_t paint) const { return _swatches[paint < _swatches.size() ? paint : 0]; }
+    size_t size() const { return _swatches.size(); }
+    // drops everything but the default swatch (Event::paint values become stale)
+    void clear();
+
+private:
+    uint32_t add_(ImU32 fill);
+    uint32_t category_(const std::string& category);
+
+private:
+    std::vector<Swatch> _swatches;
+    std::unordered_map<std::string, uint32_t> _byColor;
+    std::unordered_map<std::string, uint32_t> _byCategory;
+    std::unordered_map<ImU32, uint32_t> _byFill;   // several spellings of one color share a swatch
+};
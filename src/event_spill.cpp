@@ -0,0 +1,314 @@
+#include "event_spill.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <process.h>
+#define spill_getpid _getpid
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#define spill_getpid getpid
+#endif
+
+namespace
+{
+    constexpr uint32_t kSpillMagic = 0x33505354; // "TSP3"
+
+    /// @brief SpillHeader — class/struct documentation.
+    struct SpillHeader
+    {
+        uint32_t magic;
+        uint32_t count;
+        uint64_t tsMin;
+        uint64_t tsMax;
+        uint64_t dataBytes;
+        uint64_t colorBytes;
+    };
+
+    template <class T>
+    inline void put(std::vector<char>& buf, const T& v)
+    {
+        const char* p = reinterpret_cast<const char*>(&v);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    // unaligned column read
+    template <class T>
+    inline T col(const char* base, size_t i)
+    {
+        T v;
+        std::memcpy(&v, base + i * sizeof(T), sizeof(T));
+        return v;
+    }
+}
+
+SpillFile::SpillFile(size_t residentChunks)
+    : _capacity{ std::max<size_t>(2, residentChunks) }
+{
+}
+
+SpillFile::~SpillFile()
+{
+    reset();
+}
+
+// POSIX: mkstemp (O_EXCL, 0600) in a private mkdtemp directory, both unlinked right away:
+// reads go through the open descriptor, nothing is left behind on a crash and no other
+// user (or viewer sharing the temp directory) can name the file.
+// Windows: exclusive create ("x"), reads reopen it by path.
+bool SpillFile::open_()
+{
+    if (_f) return true;
+    std::error_code ec;
+    auto dir = std::filesystem::temp_directory_path(ec);
+    if (ec) dir = ".";
+#ifdef _WIN32
+    _path = (dir / ("trace_viewer_spill_" + std::to_string(spill_getpid()) + ".bin")).string();
+    _f = std::fopen(_path.c_str(), "w+bx");
+#else
+    std::string tmpl = (dir / "trace_viewer_XXXXXX").string();
+    if (!mkdtemp(tmpl.data()))
+    {
+        _lastError = "Unable to create spill directory in " + dir.string();
+        return false;
+    }
+    std::string file = tmpl + "/spill_XXXXXX";
+    const int fd = mkstemp(file.data());
+    if (fd >= 0)
+    {
+        ::unlink(file.c_str());
+        _f = fdopen(fd, "w+b");
+        if (!_f) ::close(fd);
+    }
+    ::rmdir(tmpl.c_str());
+    _path = file;
+#endif
+    if (!_f)
+    {
+        _lastError = "Unable to create spill file " + _path;
+        return false;
+    }
+    _end = 0;
+    return true;
+}
+
+void SpillFile::reset()
+{
+    _resident.clear();
+    _lru.clear();
+    _chunks.clear();
+    _events = 0;
+    _end = 0;
+    if (_f)
+    {
+        std::fclose(_f);
+        _f = nullptr;
+#ifdef _WIN32
+        std::error_code ec;
+        std::filesystem::remove(_path, ec);
+#endif
+    }
+}
+
+bool SpillFile::write(const EventStore::Chunk& chunk)
+{
+    if (chunk.events.empty()) return true;
+    if (!open_()) return false;
+
+    const auto& evs = chunk.events;
+    const size_t n = evs.size();
+
+    SpillHeader h{};
+    h.magic = kSpillMagic;
+    h.count = uint32_t(n);
+    h.tsMin = chunk.tsMin;
+    h.tsMax = chunk.tsMax;
+    for (const Event& e : evs) { h.dataBytes += e.data.size(); h.colorBytes += e.color.size(); }
+
+    std::vector<char> buf;
+    buf.reserve(sizeof(h) + n * (4 * 8 + 7 * 4 + 2) + h.dataBytes + h.colorBytes + 8);
+    put(buf, h);
+    for (const Event& e : evs) put(buf, e.ts);
+    for (const Event& e : evs) put(buf, e.dur);
+    for (const Event& e : evs) put(buf, e.id);
+    for (const Event& e : evs) put(buf, e.seq);
+    for (const Event& e : evs) put(buf, e.kind);
+    for (const Event& e : evs) put(buf, e.paint);
+    for (const Event& e : evs) put(buf, e.pid);
+    for (const Event& e : evs) put(buf, e.tid);
+    for (const Event& e : evs) put(buf, uint32_t(e.data.size()));
+    for (const Event& e : evs) put(buf, uint32_t(e.color.size()));
+    for (const Event& e : evs) put(buf, e.chain);
+    for (const Event& e : evs) put(buf, e.source);
+    for (const Event& e : evs) buf.insert(buf.end(), e.data.begin(), e.data.end());
+    for (const Event& e : evs) buf.insert(buf.end(), e.color.begin(), e.color.end());
+    // keep chunk offsets 8-byte aligned
+    buf.resize((buf.size() + 7) & ~size_t(7), 0);
+
+    if (std::fwrite(buf.data(), 1, buf.size(), _f) != buf.size())
+    {
+        _lastError = "Spill write failed";
+        return false;
+    }
+
+    ChunkInfo ci;
+    ci.offset = _end;
+    ci.bytes = buf.size();
+    ci.count = uint32_t(n);
+    ci.tsMin = chunk.tsMin;
+    ci.tsMax = chunk.tsMax;
+    // running bounds: tsMaxUpTo never decreases, tsMinFrom is lowered on the suffix it covers
+    ci.tsMaxUpTo = _chunks.empty() ? ci.tsMax : std::max(_chunks.back().tsMaxUpTo, ci.tsMax);
+    ci.tsMinFrom = ci.tsMin;
+    for (size_t k = _chunks.size(); k-- > 0 && _chunks[k].tsMinFrom > ci.tsMin;)
+        _chunks[k].tsMinFrom = ci.tsMin;
+    for (const Event& e : evs)
+    {
+        auto it = std::find_if(ci.lod.begin(), ci.lod.end(), [&](const KindSpan& k) { return k.kind == e.kind && k.source == e.source; });
+        if (it == ci.lod.end()) { ci.lod.push_back(KindSpan{ e.kind, e.source }); it = ci.lod.end() - 1; }
+        it->count++;
+        it->tsMin = std::min(it->tsMin, e.ts);
+        it->tsMax = std::max(it->tsMax, e.ts + e.dur);
+    }
+    _chunks.push_back(std::move(ci));
+    _end += buf.size();
+    _events += n;
+    return true;
+}
+
+void SpillFile::overlapping(uint64_t t0, uint64_t t1, std::vector<size_t>& out) const
+{
+    out.clear();
+    // chunks before lo all end before t0, chunks from hi on all start after t1
+    const auto lo = std::partition_point(_chunks.begin(), _chunks.end(), [t0](const ChunkInfo& c) { return c.tsMaxUpTo < t0; });
+    const auto hi = std::partition_point(lo, _chunks.end(), [t1](const ChunkInfo& c) { return c.tsMinFrom <= t1; });
+    for (auto it = lo; it != hi; ++it)
+    {
+        if (it->tsMax >= t0 && it->tsMin <= t1)
+            out.push_back(size_t(it - _chunks.begin()));
+    }
+}
+
+bool SpillFile::isResident(const Event* e) const
+{
+    for (const auto& kv : _resident)
+    {
+        const auto& v = kv.second.chunk->events;
+        if (!v.empty() && std::less_equal<const Event*>()(v.data(), e) && std::less<const Event*>()(e, v.data() + v.size()))
+            return true;
+    }
+    return false;
+}
+
+EventStore::Chunk* SpillFile::page(size_t idx, const std::vector<EventKindKey>& kinds)
+{
+    if (idx >= _chunks.size()) return nullptr;
+
+    auto it = _resident.find(idx);
+    if (it != _resident.end())
+    {
+        _lru.splice(_lru.begin(), _lru, it->second.pos);
+        return it->second.chunk.get();
+    }
+
+    auto chunk = read_(_chunks[idx], kinds);
+    if (!chunk) return nullptr;
+
+    while (_resident.size() >= _capacity && !_lru.empty())
+    {
+        _resident.erase(_lru.back());
+        _lru.pop_back();
+    }
+    _lru.push_front(idx);
+    EventStore::Chunk* raw = chunk.get();
+    _resident.emplace(idx, Resident{ std::move(chunk), _lru.begin() });
+    return raw;
+}
+
+std::unique_ptr<EventStore::Chunk> SpillFile::read_(const ChunkInfo& ci, const std::vector<EventKindKey>& kinds)
+{
+    if (!_f) return {};
+    std::fflush(_f);
+
+    const char* mem = nullptr;
+    std::vector<char> fallback;
+#ifdef _WIN32
+    fallback.resize(size_t(ci.bytes));
+    {
+        std::ifstream ifs(_path, std::ios::binary);
+        ifs.seekg(std::streamoff(ci.offset));
+        if (!ifs.read(fallback.data(), std::streamsize(ci.bytes))) { _lastError = "Spill read failed"; return {}; }
+    }
+    mem = fallback.data();
+#else
+    const uint64_t page = uint64_t(sysconf(_SC_PAGESIZE));
+    const uint64_t aligned = ci.offset & ~(page - 1);
+    const size_t delta = size_t(ci.offset - aligned);
+    const size_t mapLen = size_t(ci.bytes) + delta;
+    void* map = mmap(nullptr, mapLen, PROT_READ, MAP_PRIVATE, fileno(_f), off_t(aligned));
+    if (map == MAP_FAILED) { _lastError = "Spill mmap failed"; return {}; }
+    mem = static_cast<const char*>(map) + delta;
+#endif
+
+    SpillHeader h;
+    std::memcpy(&h, mem, sizeof(h));
+    std::unique_ptr<EventStore::Chunk> out;
+    if (h.magic == kSpillMagic && h.count == ci.count)
+    {
+        const size_t n = h.count;
+        const char* p = mem + sizeof(h);
+        const char* ts = p;         p += n * 8;
+        const char* dur = p;        p += n * 8;
+        const char* id = p;         p += n * 8;
+        const char* seq = p;        p += n * 8;
+        const char* kind = p;       p += n * 4;
+        const char* paint = p;      p += n * 4;
+        const char* pid = p;        p += n * 4;
+        const char* tid = p;        p += n * 4;
+        const char* dataLen = p;    p += n * 4;
+        const char* colorLen = p;   p += n * 4;
+        const char* chain = p;      p += n * 4;
+        const char* source = p;     p += n * 2;
+        const char* data = p;       p += h.dataBytes;
+        const char* color = p;
+
+        out = std::make_unique<EventStore::Chunk>();
+        out->events.resize(n);
+        out->tsMin = h.tsMin;
+        out->tsMax = h.tsMax;
+        for (size_t i = 0; i < n; ++i)
+        {
+            Event& e = out->events[i];
+            e.ts = col<uint64_t>(ts, i);
+            e.dur = col<uint64_t>(dur, i);
+            e.id = col<uint64_t>(id, i);
+            e.seq = col<uint64_t>(seq, i);
+            e.kind = col<uint32_t>(kind, i);
+            e.paint = col<uint32_t>(paint, i);
+            e.pid = col<uint32_t>(pid, i);
+            e.tid = col<uint32_t>(tid, i);
+            e.chain = col<uint32_t>(chain, i);
+            e.source = col<uint16_t>(source, i);
+            const uint32_t dl = col<uint32_t>(dataLen, i);
+            const uint32_t cl = col<uint32_t>(colorLen, i);
+            e.data.assign(data, dl); data += dl;
+            e.color.assign(color, cl); color += cl;
+            if (e.kind < kinds.size())
+            {
+                e.category = kinds[e.kind].category;
+                e.name = kinds[e.kind].name;
+            }
+        }
+    }
+    else
+        _lastError = "Corrupted spill chunk";
+
+#ifndef _WIN32
+    munmap(map, mapLen);
+#endif
+    return out;
+}
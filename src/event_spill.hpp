@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "model.hpp"
+#include "event_store.hpp"
+
+// =============== Spill file ===============
+// Out-of-core backing for cold EventStore chunks.
+// Each chunk is appended once in a compact columnar layout:
+//   header | ts[n] dur[n] id[n] seq[n] (u64) | kind[n] paint[n] pid[n] tid[n] dataLen[n] colorLen[n]
+//   chain[n] (u32) | source[n] (u16)
+//   | data blob | color blob
+// name/category are not stored, they come back from the interned kind table (paint from
+// the ColorTable, both live as long as the spill file).
+// Chunks are memory-mapped back on demand into a small LRU resident set; a per-chunk
+// LOD summary (per kind count + range) stays in memory for zoomed-out views. The chunk
+// table keeps running bounds so range lookups binary search it (chunks are mostly, not
+// strictly, in time order).
+class SpillFile
+{
+public:
+    /// @brief KindSpan — class/struct documentation.
+    struct KindSpan
+    {
+        uint32_t kind = 0;
+        uint16_t source = 0;
+        uint32_t count = 0;
+        uint64_t tsMin = UINT64_MAX;
+        uint64_t tsMax = 0;
+    };
+
+    /// @brief ChunkInfo — class/struct documentation.
+    struct ChunkInfo
+    {
+        uint64_t offset = 0;
+        uint64_t bytes = 0;
+        uint32_t count = 0;
+        uint64_t tsMin = UINT64_MAX;
+        uint64_t tsMax = 0;
+        uint64_t tsMaxUpTo = 0;           // max tsMax of chunks [0, this]
+        uint64_t tsMinFrom = UINT64_MAX;  // min tsMin of chunks [this, end)
+        std::vector<KindSpan> lod;
+    };
+
+    explicit SpillFile(size_t residentChunks = 64);
+    ~SpillFile();
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // append one chunk (copied out, the store can drop it right after)
+    bool write(const EventStore::Chunk& chunk);
+    // drop the file, directory and resident set
+    void reset();
+
+    bool     empty() const { return _chunks.empty(); }
+    uint64_t events() const { return _events; }
+    uint64_t fileBytes() const { return _end; }
+    size_t   residentCapacity() const { return _capacity; }
+    const std::vector<ChunkInfo>& chunks() const { return _chunks; }
+    const std::string& lastError() const { return _lastError; }
+
+    // chunk indices whose [tsMin, tsMax] overlaps [t0, t1]
+    void overlapping(uint64_t t0, uint64_t t1, std::vector<size_t>& out) const;
+    // decoded chunk from the resident set (paged in when missing); nullptr on IO error.
+    // Pointers stay valid until the chunk leaves the LRU (at most residentCapacity() pages later).
+    EventStore::Chunk* page(size_t idx, const std::vector<EventKindKey>& kinds);
+    bool isResident(const Event* e) const;
+
+private:
+    bool open_();
+    std::unique_ptr<EventStore::Chunk> read_(const ChunkInfo& ci, const std::vector<EventKindKey>& kinds);
+
+private:
+    std::FILE* _f = nullptr;
+    std::string _path;
+    std::string _lastError;
+    std::vector<ChunkInfo> _chunks;
+    uint64_t _end = 0;
+    uint64_t _events = 0;
+
+    // LRU resident set (front = most recent)
+    size_t _capacity;
+    std::list<size_t> _lru;
+    /// @brief Resident — class/struct documentation.
+    struct Resident
+    {
+        std::unique_ptr<EventStore::Chunk> chunk;
+        std::list<size_t>::iterator pos;
+    };
+    std::unordered_map<size_t, Resident> _resident;
+};
@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model.hpp"
+
+// =============== Retention ===============
+// Live sessions (and file loads when spilling); 0 = no limit for that criterion.
+struct RetentionPolicy
+{
+    bool     enabled = false;
+    double   maxWindowSec = 0.0;     // keep [timeMax - window, timeMax] resident
+    uint64_t maxEvents = 0;
+    uint64_t maxBytes = 0;
+    bool     keepAggregates = true;  // per-kind histograms still cover evicted events (producer stats always do)
+    bool     spillToDisk = false;    // evicted chunks go to the spill file instead of being dropped
+};
+
+// =============== Event store ===============
+// Chunked append-only storage for the timeline:
+// - chunks are reserved once and never reallocate => Event* stay valid while the chunk lives,
+// - every chunk but the last is full => O(1) random access,
+// - retention drops whole chunks from the front in O(1).
+// Each stored event gets a global sequence number (Event::seq), the position of an
+// event relative to the current front is `seq - base()`.
+class EventStore
+{
+public:
+    static constexpr size_t kChunkEvents = 4096;
+
+    /// @brief Chunk — class/struct documentation.
+    struct Chunk
+    {
+        std::vector<Event> events;
+        uint64_t tsMin = UINT64_MAX;   // min ts
+        uint64_t tsMax = 0;            // max end (ts + dur)
+        size_t   bytes = 0;            // approximated heap footprint
+    };
+
+    template <class EventT, class StoreT>
+    class Iter
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Event;
+        using difference_type = std::ptrdiff_t;
+        using pointer = EventT*;
+        using reference = EventT&;
+
+        Iter() = default;
+        Iter(StoreT* s, size_t i) : _s(s), _i(i) {}
+        reference operator*() const { return (*_s)[_i]; }
+        pointer operator->() const { return &(*_s)[_i]; }
+        Iter& operator++() { ++_i; return *this; }
+        Iter operator++(int) { Iter t = *this; ++_i; return t; }
+        bool operator==(const Iter& o) const { return _i == o._i; }
+        bool operator!=(const Iter& o) const { return _i != o._i; }
+    private:
+        StoreT* _s = nullptr;
+        size_t _i = 0;
+    };
+    using iterator = Iter<Event, EventStore>;
+    using const_iterator = Iter<const Event, const EventStore>;
+
+    size_t size() const { return _size; }
+    bool   empty() const { return _size == 0; }
+    size_t bytes() const { return _bytes; }
+    // sequence number of the front event (= number of events evicted so far)
+    uint64_t base() const { return _base; }
+
+    Event&       operator[](size_t i)       { return _chunks[i / kChunkEvents]->events[i % kChunkEvents]; }
+    const Event& operator[](size_t i) const { return _chunks[i / kChunkEvents]->events[i % kChunkEvents]; }
+
+    iterator begin() { return { this, 0 }; }
+    iterator end() { return { this, _size }; }
+    const_iterator begin() const { return { this, 0 }; }
+    const_iterator end() const { return { this, _size }; }
+
+    const std::deque<std::unique_ptr<Chunk>>& chunks() const { return _chunks; }
+
+    void clear()
+    {
+        _chunks.clear();
+        _size = 0;
+        _bytes = 0;
+        _base = 0;
+    }
+
+    void push_back(Event&& e)
+    {
+        if (_chunks.empty() || _chunks.back()->events.size() == kChunkEvents)
+        {
+            _chunks.push_back(std::make_unique<Chunk>());
+            _chunks.back()->events.reserve(kChunkEvents);
+        }
+        Chunk& c = *_chunks.back();
+        e.seq = _base + _size;
+        const size_t b = approxBytes(e);
+        c.tsMin = std::min(c.tsMin, e.ts);
+        c.tsMax = std::max(c.tsMax, e.ts + e.dur);
+        c.bytes += b;
+        c.events.push_back(std::move(e));
+        _bytes += b;
+        ++_size;
+    }
+
+    void append(std::vector<Event>&& evs)
+    {
+        for (Event& e : evs) push_back(std::move(e));
+        evs.clear();
+    }
+
+    // replace the whole content (file load)
+    void assign(std::vector<Event>&& evs)
+    {
+        clear();
+        append(std::move(evs));
+    }
+
+    // O(1) front eviction; returns the dropped chunk (aggregates / spill)
+    std::unique_ptr<Chunk> popFrontChunk()
+    {
+        if (_chunks.empty()) return {};
+        std::unique_ptr<Chunk> c = std::move(_chunks.front());
+        _chunks.pop_front();
+        _size -= c->events.size();
+        _bytes -= c->bytes;
+        _base += c->events.size();
+        return c;
+    }
+
+    static size_t approxBytes(const Event& e)
+    {
+        auto heap = [](const std::string& s) { return s.capacity() > 15 ? s.capacity() + 1 : 0; };
+        return sizeof(Event) + heap(e.name) + heap(e.category) + heap(e.data) + heap(e.color);
+    }
+
+private:
+    std::deque<std::unique_ptr<Chunk>> _chunks;
+    size_t _size = 0;
+    size_t _bytes = 0;
+    uint64_t _base = 0;
+};
@@ -0,0 +1,186 @@
+#include "flame_graph.hpp"
+#include "self_profile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+
+bool build_flame_tree(std::vector<FlameSpan>& spans, uint64_t t0, uint64_t t1, bool byThread, FlameTree& out,
+    const std::atomic<bool>* cancel)
+{
+    PROFILE_SCOPE("build_flame_tree");
+    const auto start = std::chrono::steady_clock::now();
+    out = {};
+    out.t0 = t0;
+    out.t1 = t1;
+    out.byThread = byThread;
+    out.spans = spans.size();
+    out.nodes.emplace_back();   // root
+
+    // per thread, by start; an enclosing span comes before the spans it contains
+    std::sort(spans.begin(), spans.end(), [](const FlameSpan& a, const FlameSpan& b) {
+        if (a.thread != b.thread) return a.thread < b.thread;
+        if (a.ts != b.ts) return a.ts < b.ts;
+        return a.end > b.end;
+    });
+    if (cancel && cancel->load(std::memory_order_relaxed))
+        return false;
+
+    // (parent, kind) -> node
+    std::unordered_map<uint64_t, uint32_t> childOf;
+    auto child = [&](uint32_t parent, uint32_t kind, uint32_t paint) {
+        const auto [it, added] = childOf.try_emplace((uint64_t(parent) << 32) | kind, uint32_t(out.nodes.size()));
+        if (added)
+        {
+            FlameNode n;
+            n.kind = kind;
+            n.paint = paint;
+            n.parent = parent;
+            n.depth = out.nodes[parent].depth + 1;
+            out.maxDepth = std::max(out.maxDepth, n.depth);
+            out.nodes.push_back(std::move(n));
+        }
+        return it->second;
+    };
+
+    /// @brief Open — class/struct documentation.
+    struct Open
+    {
+        uint64_t end;
+        uint32_t node;
+    };
+    std::vector<Open> stack;
+    uint32_t base = 0;
+    for (size_t i = 0; i < spans.size(); ++i)
+    {
+        const FlameSpan& s = spans[i];
+        if ((i & 0xFFFF) == 0 && cancel && cancel->load(std::memory_order_relaxed))
+            return false;
+        if (i == 0 || s.thread != spans[i - 1].thread)
+        {
+            stack.clear();
+            ++out.threads;
+            base = 0;
+            if (byThread)
+            {
+                base = uint32_t(out.nodes.size());
+                FlameNode n;
+                n.kind = FlameNode::kThread;
+                n.thread = s.thread;
+                n.depth = 1;
+                out.maxDepth = std::max(out.maxDepth, n.depth);
+                out.nodes.push_back(std::move(n));
+            }
+        }
+        // the parent is the innermost open span that also contains the end
+        while (!stack.empty() && stack.back().end < s.end)
+            stack.pop_back();
+        const uint32_t node = child(stack.empty() ? base : stack.back().node, s.kind, s.paint);
+        FlameNode& n = out.nodes[node];
+        n.calls += 1;
+        const uint64_t a = std::max(s.ts, t0), b = std::min(s.end, t1);
+        n.totalUs += b > a ? b - a : 0;
+        stack.push_back({ s.end, node });
+    }
+
+    // children have larger indices than their parent: one reverse pass sums them up
+    std::vector<uint64_t> childUs(out.nodes.size(), 0);
+    for (size_t i = out.nodes.size(); i-- > 0;)
+    {
+        FlameNode& n = out.nodes[i];
+        const bool synthetic = n.kind == FlameNode::kRoot || n.kind == FlameNode::kThread;
+        if (synthetic)
+            n.totalUs = childUs[i];
+        n.selfUs = synthetic ? 0 : n.totalUs - std::min(n.totalUs, childUs[i]);
+        if (i > 0)
+        {
+            childUs[n.parent] += n.totalUs;
+            ++out.nodes[n.parent].childCount;
+        }
+    }
+    // flat child lists, longest first
+    uint32_t offset = 0;
+    for (FlameNode& n : out.nodes)
+    {
+        n.firstChild = offset;
+        offset += n.childCount;
+        n.childCount = 0;
+    }
+    out.children.resize(offset);
+    for (size_t i = 1; i < out.nodes.size(); ++i)
+    {
+        FlameNode& p = out.nodes[out.nodes[i].parent];
+        out.children[p.firstChild + p.childCount++] = uint32_t(i);
+    }
+    for (const FlameNode& n : out.nodes)
+    {
+        std::sort(out.children.begin() + n.firstChild, out.children.begin() + n.firstChild + n.childCount, [&](uint32_t a, uint32_t b) {
+            return out.nodes[a].totalUs > out.nodes[b].totalUs;
+        });
+    }
+    out.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// ---------- Background builds ----------
+FlameBuilder::~FlameBuilder()
+{
+    if (!_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        _stop = true;
+        _pending.reset();
+    }
+    _cancel = true;
+    _cv.notify_one();
+    _thread.join();
+}
+
+void FlameBuilder::submit(Job&& job)
+{
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        _pending = std::move(job);
+        _busy = true;
+        _cancel = true;   // under the lock: the worker clears it when it takes the job
+    }
+    if (!_thread.joinable())
+        _thread = std::thread([this] { run_(); });
+    _cv.notify_one();
+}
+
+std::shared_ptr<const FlameTree> FlameBuilder::result() const
+{
+    std::lock_guard<std::mutex> lk(_mtx);
+    return _result;
+}
+
+void FlameBuilder::run_()
+{
+    selfprof::setThreadName("flame graph");
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lk(_mtx);
+            _cv.wait(lk, [this] { return _stop || _pending.has_value(); });
+            if (_stop) return;
+            job = std::move(*_pending);
+            _pending.reset();
+            _cancel = false;
+        }
+        auto tree = std::make_shared<FlameTree>();
+        const bool done = build_flame_tree(job.spans, job.t0, job.t1, job.byThread, *tree, &_cancel);
+        job = {};   // the spans can be large, free them before waiting
+        {
+            std::lock_guard<std::mutex> lk(_mtx);
+            if (done)
+                _result = std::move(tree);
+            if (!_pending)
+                _busy = false;
+        }
+        if (done)
+            if (FrameScheduler* f = _wake.load(std::memory_order_acquire))
+                f->wake(FrameScheduler::Loader);
+    }
+}
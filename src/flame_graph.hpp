@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "frame_scheduler.hpp"
+
+// =============== Flame graph ===============
+// Call tree aggregated from span containment. The spans of one thread, sorted by start
+// (longest first on ties), are swept once with a stack: a span that ends inside the top of
+// the stack is its child, anything else pops. Identical stacks (same kinds from the root)
+// share a node, which sums the calls, the inclusive time clipped to the range, and the self
+// time (inclusive minus the children). Partially overlapping spans become siblings.
+// Builds run on a worker thread over a compact copy of the spans (FlameSpan), a newer
+// request cancels the running one.
+
+/// @brief FlameSpan — class/struct documentation.
+struct FlameSpan
+{
+    uint64_t ts;
+    uint64_t end;      // ts + dur, dur > 0
+    uint64_t thread;   // (source, pid, tid) packed, spans nest per thread only
+    uint32_t kind;     // Event::kind
+    uint32_t paint;    // Event::paint
+};
+
+/// @brief FlameNode — class/struct documentation.
+struct FlameNode
+{
+    static constexpr uint32_t kRoot = UINT32_MAX;
+    static constexpr uint32_t kThread = UINT32_MAX - 1;
+
+    uint32_t kind = kRoot;     // kRoot, kThread (split by thread) or an Event::kind
+    uint32_t paint = 0;
+    uint32_t parent = 0;
+    uint32_t depth = 0;
+    uint64_t thread = 0;       // kThread nodes
+    uint64_t calls = 0;
+    uint64_t totalUs = 0;      // inclusive, clipped to the range
+    uint64_t selfUs = 0;
+    uint32_t firstChild = 0;   // into FlameTree::children
+    uint32_t childCount = 0;
+};
+
+/// @brief FlameTree — class/struct documentation.
+struct FlameTree
+{
+    std::vector<FlameNode> nodes;   // [0] = root, parents before their children
+    std::vector<uint32_t> children; // per node, longest first
+    uint64_t t0 = 0, t1 = 0;        // range
+    uint64_t spans = 0;
+    uint32_t threads = 0;
+    uint32_t maxDepth = 0;
+    bool byThread = false;
+    double buildMs = 0.0;
+};
+
+// Sorts `spans` and sweeps them. Spans are expected to overlap [t0, t1].
+// Returns false when `cancel` was raised (tree left incomplete).
+bool build_flame_tree(std::vector<FlameSpan>& spans, uint64_t t0, uint64_t t1, bool byThread, FlameTree& out,
+    const std::atomic<bool>* cancel = nullptr);
+
+// =============== Background builds ===============
+class FlameBuilder
+{
+public:
+    /// @brief Job — class/struct documentation.
+    struct Job
+    {
+        std::vector<FlameSpan> spans;
+        uint64_t t0 = 0, t1 = 0;
+        bool byThread = false;
+    };
+
+    FlameBuilder() = default;
+    ~FlameBuilder();
+    FlameBuilder(const FlameBuilder&) = delete;
+    FlameBuilder& operator=(const FlameBuilder&) = delete;
+
+    // finished builds wake the frame loop (any thread)
+    void set_wake(FrameScheduler* frames) { _wake.store(frames, std::memory_order_release); }
+
+    // Replaces the queued job, cancels the running one.
+    void submit(Job&& job);
+    bool busy() const { return _busy.load(std::memory_order_acquire); }
+    // Last finished tree (null before the first one).
+    std::shared_ptr<const FlameTree> result() const;
+
+private:
+    void run_();
+
+private:
+    std::thread _thread;
+    mutable std::mutex _mtx;
+    std::condition_variable _cv;
+    std::optional<Job> _pending;    // under _mtx
+    std::shared_ptr<const FlameTree> _result;   // under _mtx
+    bool _stop = false;
+    std::atomic<bool> _cancel{ false };
+    std::atomic<bool> _busy{ false };
+    std::atomic<FrameScheduler*> _wake{ nullptr };
+};
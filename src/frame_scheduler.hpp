@@ -0,0 +1,115 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+// =============== Redraw scheduling ===============
+// The main loop draws only when a subsystem asked for it: input (a few frames so ImGui hover /
+// click state settles), viewport animation, live data, loads, timers (replay, auto-reload,
+// keepalive). With nothing pending it blocks in glfwWaitEventsTimeout until the next deadline.
+// request() / requestAt() are UI thread only. wake() may be called from any thread (receive
+// threads): it records the reason and posts one empty event to unblock the wait.
+class FrameScheduler
+{
+public:
+    enum Reason : uint32_t
+    {
+        Input     = 1u << 0,
+        Animation = 1u << 1,
+        LiveData  = 1u << 2,
+        Loader    = 1u << 3,
+        Timer     = 1u << 4,
+    };
+
+    // ImGui resolves hover / active state one frame after the input
+    static constexpr int    kSettleFrames = 3;
+    // tooltips open after the hover delay (style.HoverDelayNormal + HoverStationaryDelay)
+    static constexpr double kHoverTailSeconds = 0.6;
+    static constexpr double kHoverTailStep = 0.1;
+    // blocking bound: anything polled without a wake source is seen within this
+    static constexpr double kMaxIdleSeconds = 1.0;
+
+    using Waker = void (*)();
+
+    // posts an empty event to the window system (glfwPostEmptyEvent)
+    void setWaker(Waker w) { _waker.store(w, std::memory_order_release); }
+    // draws every frame (profiling, vsync bound)
+    void setContinuous(bool on) { _continuous = on; }
+    bool continuous() const { return _continuous; }
+
+    // the next `frames` frames are drawn
+    void request(uint32_t reason, int frames = 1)
+    {
+        _pending = std::max(_pending, frames);
+        _reasons |= reason;
+    }
+    // a frame is drawn at (or soon after) time t
+    void requestAt(double t) { _deadline = std::min(_deadline, t); }
+    void requestIn(double seconds) { requestAt(now() + seconds); }
+    // input seen by the current frame
+    void noteInput()
+    {
+        request(Input, kSettleFrames);
+        _lastInput = now();
+    }
+
+    // any thread; coalesced, one empty event until the next frame picks it up
+    void wake(uint32_t reason)
+    {
+        if (_woken.fetch_or(reason, std::memory_order_acq_rel) == 0)
+            if (Waker w = _waker.load(std::memory_order_acquire))
+                w();
+    }
+
+    // Seconds the loop may block before the next frame, 0 = draw now.
+    double idleTimeout()
+    {
+        const double t = now();
+        if (const uint32_t woken = _woken.exchange(0, std::memory_order_acq_rel))
+            request(woken);
+        if (_continuous || _pending > 0)
+            return 0.0;
+        double next = std::min(_deadline, t + kMaxIdleSeconds);
+        if (t - _lastInput < kHoverTailSeconds)
+            next = std::min(next, t + kHoverTailStep);
+        return std::max(0.0, next - t);
+    }
+
+    // Called once per drawn frame, before the UI runs.
+    void beginFrame()
+    {
+        _frameReasons = _reasons;
+        _reasons = 0;
+        if (_pending > 0)
+            --_pending;
+        if (_deadline <= now())
+        {
+            _deadline = std::numeric_limits<double>::infinity();
+            _frameReasons |= Timer;
+        }
+        ++_drawn;
+    }
+
+    // seconds on a monotonic clock (deadlines)
+    static double now()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // reasons the current frame was drawn for
+    uint32_t frameReasons() const { return _frameReasons; }
+    uint64_t drawn() const { return _drawn; }
+
+private:
+    std::atomic<Waker> _waker{ nullptr };
+    std::atomic<uint32_t> _woken{ 0 };
+    int _pending = 1;   // first frame
+    uint32_t _reasons = 0;
+    uint32_t _frameReasons = 0;
+    double _deadline = std::numeric_limits<double>::infinity();
+    double _lastInput = -1e9;
+    uint64_t _drawn = 0;
+    bool _continuous = false;
+};
@@ -0,0 +1,241 @@
+#include "framing.hpp"
+
+// ---------- window helpers ----------
+bool FrameReassembler::isDone_(const Session& s, uint32_t seq)
+{
+    const uint32_t i = s.stats.highestSeq - seq;
+    return i < kWindow && ((s.done[i >> 6] >> (i & 63)) & 1ull);
+}
+
+void FrameReassembler::markDone_(Session& s, uint32_t seq)
+{
+    const uint32_t i = s.stats.highestSeq - seq;
+    if (i < kWindow) s.done[i >> 6] |= 1ull << (i & 63);
+}
+
+// highestSeq -> seq (seq ahead): shift the window, remember the skipped numbers as gaps
+void FrameReassembler::advance_(Session& s, uint32_t seq, uint64_t nowMs)
+{
+    const uint32_t d = seq - s.stats.highestSeq;
+    constexpr size_t kWords = kWindow / 64;
+    if (d >= kWindow)
+        std::fill(std::begin(s.done), std::end(s.done), 0ull);
+    else
+    {
+        const size_t ws = d >> 6, bs = d & 63;
+        for (size_t w = kWords; w-- > 0;)
+        {
+            uint64_t v = 0;
+            if (w >= ws)
+            {
+                v = s.done[w - ws] << bs;
+                if (bs && w > ws) v |= s.done[w - ws - 1] >> (64 - bs);
+            }
+            s.done[w] = v;
+        }
+    }
+
+    const uint32_t prev = s.stats.highestSeq;
+    s.stats.highestSeq = seq;
+
+    // gaps that fall out of the window can no longer be matched (expired partials may still be ahead)
+    for (auto it = s.missing.begin(); it != s.missing.end();)
+    {
+        if (int32_t(seq - it->first) >= int32_t(kWindow)) { s.stats.lost++; it = s.missing.erase(it); }
+        else ++it;
+    }
+    const uint32_t skipped = d - 1;
+    const uint32_t tracked = std::min<uint32_t>(skipped, kWindow - 1);
+    s.stats.lost += skipped - tracked;
+    for (uint32_t k = 0; k < tracked; ++k)
+    {
+        const uint32_t g = prev + (skipped - tracked) + 1 + k;
+        s.missing.emplace(g, nowMs);
+    }
+}
+
+// ---------- FrameReassembler ----------
+void FrameReassembler::complete_(Session& s, uint32_t seq, std::string&& msg, uint64_t nowMs, std::vector<std::string>& out)
+{
+    if (!s.started)
+    {
+        s.started = true;
+        s.stats.highestSeq = seq;
+    }
+    else if (int32_t(seq - s.stats.highestSeq) > 0)
+    {
+        advance_(s, seq, nowMs);
+        s.missing.erase(seq);   // a partial that timed out earlier, completed after all
+    }
+    else if (s.missing.erase(seq))
+        s.stats.reordered++;
+    markDone_(s, seq);
+
+    s.stats.messages++;
+    s.stats.bytes += msg.size();
+    out.push_back(std::move(msg));
+}
+
+void FrameReassembler::feed(const char* data, size_t len, uint64_t nowMs, std::vector<std::string>& out)
+{
+    const framing::FrameHeader h = framing::readHeader(data);
+    const char* payload = data + framing::kHeaderBytes;
+    const size_t n = len - framing::kHeaderBytes;
+
+    Session& s = _sessions[h.session];
+    s.stats.lastSeenMs = nowMs;
+
+    if (h.fragCount == 0 || h.fragIndex >= h.fragCount || h.totalLen > framing::kMaxMessage || size_t(h.offset) + n > h.totalLen)
+    {
+        s.stats.malformed++;
+        return;
+    }
+    if (s.started)
+    {
+        const int32_t d = int32_t(h.seq - s.stats.highestSeq);
+        // too old to tell, or already delivered
+        if (d <= -int32_t(kWindow) || (d <= 0 && isDone_(s, h.seq)))
+        {
+            s.stats.duplicates++;
+            return;
+        }
+    }
+
+    if (h.fragCount == 1)
+    {
+        if (n != h.totalLen) { s.stats.malformed++; return; }
+        s.stats.fragments++;
+        complete_(s, h.seq, std::string(payload, n), nowMs, out);
+        return;
+    }
+
+    const uint32_t chunk = fragmentChunk_(h, n);
+    if (!chunk)
+    {
+        s.stats.malformed++;
+        return;
+    }
+    auto pit = s.partial.find(h.seq);
+    if (pit == s.partial.end())
+    {
+        // bounded per session: a bogus totalLen / fresh seqs cannot pile up buffers until expire()
+        const bool tooFar = s.started && int32_t(h.seq - s.stats.highestSeq) >= int32_t(kWindow);
+        if (tooFar || s.partial.size() >= kMaxPartials || s.pendingBytes + h.totalLen > kMaxPendingBytes)
+        {
+            s.stats.malformed++;
+            return;
+        }
+        pit = s.partial.emplace(h.seq, Partial{}).first;
+        Partial& np = pit->second;
+        np.count = h.fragCount;
+        np.chunk = chunk;
+        np.buf.resize(h.totalLen);
+        np.have.assign((size_t(h.fragCount) + 63) / 64, 0);
+        np.firstMs = nowMs;
+        s.pendingBytes += h.totalLen;
+    }
+    Partial& p = pit->second;
+    if (p.count != h.fragCount || p.buf.size() != h.totalLen || p.chunk != chunk)
+    {
+        s.stats.malformed++;
+        return;
+    }
+
+    uint64_t& w = p.have[h.fragIndex >> 6];
+    const uint64_t bit = 1ull << (h.fragIndex & 63);
+    if (w & bit)
+    {
+        s.stats.duplicates++;
+        return;
+    }
+    w |= bit;
+    if (n) std::memcpy(p.buf.data() + h.offset, payload, n);
+    p.received++;
+    s.stats.fragments++;
+
+    if (p.received == p.count)
+    {
+        std::string msg = std::move(p.buf);
+        s.pendingBytes -= msg.size();
+        s.partial.erase(pit);
+        complete_(s, h.seq, std::move(msg), nowMs, out);
+    }
+}
+
+void FrameReassembler::expire(uint64_t nowMs)
+{
+    for (auto sit = _sessions.begin(); sit != _sessions.end();)
+    {
+        Session& s = sit->second;
+        if (nowMs - s.stats.lastSeenMs > kIdleTimeouts * _timeoutMs)
+        {
+            // nothing more will arrive: whatever is still pending is lost
+            s.stats.lost += s.partial.size() + s.missing.size();
+            for (const auto& kv : s.partial)
+                if (s.missing.count(kv.first)) s.stats.lost--;
+            accumulate_(_retired, s.stats);
+            sit = _sessions.erase(sit);
+            continue;
+        }
+        for (auto it = s.partial.begin(); it != s.partial.end();)
+        {
+            if (nowMs - it->second.firstMs <= _timeoutMs) { ++it; continue; }
+            s.stats.timeouts++;
+            s.pendingBytes -= it->second.buf.size();
+            // behind the highest seq it is already a tracked gap; ahead of it, it becomes one
+            // once a later seq arrives (advance_ keeps this entry and its timestamp)
+            if (ahead_(s, it->first))
+                s.missing.emplace(it->first, it->second.firstMs);
+            it = s.partial.erase(it);
+        }
+        for (auto it = s.missing.begin(); it != s.missing.end();)
+        {
+            if (nowMs - it->second <= _timeoutMs || ahead_(s, it->first)) { ++it; continue; }
+            s.stats.lost++;
+            it = s.missing.erase(it);
+        }
+        ++sit;
+    }
+}
+
+// framing::fragment() layout: fragments 0..count-2 carry chunk bytes at i * chunk, the last
+// one the remainder (1..chunk bytes), so count == ceil(totalLen / chunk)
+uint32_t FrameReassembler::fragmentChunk_(const framing::FrameHeader& h, size_t n)
+{
+    const bool last = h.fragIndex + 1u == h.fragCount;
+    uint64_t chunk;
+    if (!last)
+    {
+        chunk = n;
+        if (chunk == 0 || uint64_t(h.offset) != uint64_t(h.fragIndex) * chunk) return 0;
+    }
+    else
+    {
+        if (h.fragIndex == 0 || h.offset % h.fragIndex || n == 0) return 0;
+        chunk = h.offset / h.fragIndex;
+        if (n > chunk || uint64_t(h.offset) + n != h.totalLen) return 0;
+    }
+    if (chunk * (h.fragCount - 1u) >= h.totalLen || chunk * h.fragCount < h.totalLen) return 0;
+    return uint32_t(chunk);
+}
+
+void FrameReassembler::accumulate_(SessionStats& t, const SessionStats& s)
+{
+    t.messages += s.messages;
+    t.fragments += s.fragments;
+    t.bytes += s.bytes;
+    t.duplicates += s.duplicates;
+    t.reordered += s.reordered;
+    t.lost += s.lost;
+    t.timeouts += s.timeouts;
+    t.malformed += s.malformed;
+    t.lastSeenMs = std::max(t.lastSeenMs, s.lastSeenMs);
+}
+
+FrameReassembler::SessionStats FrameReassembler::totals() const
+{
+    SessionStats t = _retired;
+    for (const auto& kv : _sessions)
+        accumulate_(t, kv.second.stats);
+    return t;
+}
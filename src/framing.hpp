@@ -0,0 +1,191 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// =============== Framing ===============
+// Optional binary header in front of a live payload, so producers can send large
+// batches (fragmented over several datagrams) and the viewer can account for losses.
+// Legacy text datagrams (JSON / OFFER / PONG) never start with kMagic0.
+//
+//   0  u8  magic0 (0xF7)   1  u8 magic1 ('F')   2 u8 version   3 u8 flags
+//   4  u32 session         producer run id
+//   8  u32 seq             message sequence number (per session, wraps)
+//  12  u16 fragIndex      14  u16 fragCount
+//  16  u32 totalLen        whole message
+//  20  u32 offset          of this fragment in the message
+//  24  payload[datagram - 24]
+// All fields little-endian.
+namespace framing
+{
+    inline constexpr uint8_t  kMagic0 = 0xF7;
+    inline constexpr uint8_t  kMagic1 = 'F';
+    inline constexpr uint8_t  kVersion = 1;
+    inline constexpr size_t   kHeaderBytes = 24;
+    inline constexpr uint32_t kMaxMessage = 16u << 20;
+    // loopback / jumbo friendly default; use ~1400 on real networks
+    inline constexpr size_t   kDefaultDatagram = 60 * 1024;
+
+    /// @brief FrameHeader — class/struct documentation.
+    struct FrameHeader
+    {
+        uint8_t  flags = 0;
+        uint32_t session = 0;
+        uint32_t seq = 0;
+        uint16_t fragIndex = 0;
+        uint16_t fragCount = 1;
+        uint32_t totalLen = 0;
+        uint32_t offset = 0;
+    };
+
+    inline bool isFrame(const char* data, size_t len)
+    {
+        return len >= kHeaderBytes && uint8_t(data[0]) == kMagic0 && uint8_t(data[1]) == kMagic1 && uint8_t(data[2]) == kVersion;
+    }
+
+    inline void writeHeader(char* out, const FrameHeader& h)
+    {
+        out[0] = char(kMagic0); out[1] = char(kMagic1); out[2] = char(kVersion); out[3] = char(h.flags);
+        std::memcpy(out + 4, &h.session, 4);
+        std::memcpy(out + 8, &h.seq, 4);
+        std::memcpy(out + 12, &h.fragIndex, 2);
+        std::memcpy(out + 14, &h.fragCount, 2);
+        std::memcpy(out + 16, &h.totalLen, 4);
+        std::memcpy(out + 20, &h.offset, 4);
+    }
+
+    inline FrameHeader readHeader(const char* in)
+    {
+        FrameHeader h;
+        h.flags = uint8_t(in[3]);
+        std::memcpy(&h.session, in + 4, 4);
+        std::memcpy(&h.seq, in + 8, 4);
+        std::memcpy(&h.fragIndex, in + 12, 2);
+        std::memcpy(&h.fragCount, in + 14, 2);
+        std::memcpy(&h.totalLen, in + 16, 4);
+        std::memcpy(&h.offset, in + 20, 4);
+        return h;
+    }
+
+    // Producer side: splits one message into datagrams of at most maxDatagram bytes,
+    // send(const char*, size_t) is called once per fragment with a reused buffer.
+    template <class Send>
+    inline bool fragment(uint32_t session, uint32_t seq, std::string_view msg, size_t maxDatagram, Send&& send)
+    {
+        if (maxDatagram <= kHeaderBytes || msg.size() > kMaxMessage) return false;
+        const size_t chunk = maxDatagram - kHeaderBytes;
+        const size_t count = msg.empty() ? 1 : (msg.size() + chunk - 1) / chunk;
+        if (count > 0xFFFF) return false;
+
+        std::vector<char> buf(kHeaderBytes + std::min(chunk, msg.size()));
+        FrameHeader h;
+        h.session = session;
+        h.seq = seq;
+        h.fragCount = uint16_t(count);
+        h.totalLen = uint32_t(msg.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t off = i * chunk;
+            const size_t n = std::min(chunk, msg.size() - off);
+            h.fragIndex = uint16_t(i);
+            h.offset = uint32_t(off);
+            writeHeader(buf.data(), h);
+            if (n) std::memcpy(buf.data() + kHeaderBytes, msg.data() + off, n);
+            send(buf.data(), kHeaderBytes + n);
+        }
+        return true;
+    }
+}
+
+// =============== Reassembly ===============
+// Per session: fragments are gathered until complete, duplicate fragments/messages are
+// suppressed (sliding window over the last kWindow sequence numbers), sequence gaps are
+// tracked and declared lost once older than the timeout. A partial message that times out
+// ahead of the highest seq stays a pending gap until a later seq passes it, so every
+// sequence number is counted at most once. Sessions idle for kIdleTimeouts timeouts are
+// dropped, their counters folded into retired().
+// A session holds at most kMaxPartials partial messages / kMaxPendingBytes, only for seqs
+// less than kWindow ahead of its highest; fragments must sit at fragIndex * chunk (chunk =
+// payload of a non-last fragment), so a completed message has no hole. Anything else is
+// dropped as malformed.
+class FrameReassembler
+{
+public:
+    static constexpr uint32_t kWindow = 1024;
+    static constexpr uint64_t kIdleTimeouts = 30;
+    static constexpr size_t   kMaxPartials = 256;
+    static constexpr size_t   kMaxPendingBytes = 64u << 20;
+
+    /// @brief SessionStats — class/struct documentation.
+    struct SessionStats
+    {
+        uint64_t messages = 0;     // completed
+        uint64_t fragments = 0;    // accepted fragments
+        uint64_t bytes = 0;        // completed payload bytes
+        uint64_t duplicates = 0;   // duplicate fragments / messages dropped
+        uint64_t reordered = 0;    // completed after a later seq
+        uint64_t lost = 0;         // sequence numbers never completed
+        uint64_t timeouts = 0;     // partial messages expired
+        uint64_t malformed = 0;
+        uint32_t highestSeq = 0;
+        uint64_t lastSeenMs = 0;
+    };
+
+    explicit FrameReassembler(uint64_t timeoutMs = 2000) : _timeoutMs(timeoutMs) {}
+
+    // data must be a frame (framing::isFrame); completed messages are appended to out
+    void feed(const char* data, size_t len, uint64_t nowMs, std::vector<std::string>& out);
+    // expire partial messages and pending gaps older than the timeout, drop idle sessions
+    void expire(uint64_t nowMs);
+    void reset() { _sessions.clear(); _retired = {}; }
+
+    size_t sessionCount() const { return _sessions.size(); }
+    template <class Fn>
+    void forEachSession(Fn&& fn) const { for (const auto& kv : _sessions) fn(kv.first, kv.second.stats); }
+    SessionStats totals() const;
+    // sum of the dropped sessions
+    const SessionStats& retired() const { return _retired; }
+
+private:
+    /// @brief Partial — class/struct documentation.
+    struct Partial
+    {
+        std::string buf;
+        std::vector<uint64_t> have;   // one bit per fragment
+        uint32_t received = 0;
+        uint16_t count = 0;
+        uint32_t chunk = 0;      // payload bytes of every fragment but the last
+        uint64_t firstMs = 0;
+    };
+
+    /// @brief Session — class/struct documentation.
+    struct Session
+    {
+        SessionStats stats;
+        bool started = false;
+        // bit i => seq (highestSeq - i) completed
+        uint64_t done[kWindow / 64] = {};
+        std::unordered_map<uint32_t, Partial> partial;
+        std::map<uint32_t, uint64_t> missing;   // gap seq -> first noticed (ms)
+        size_t pendingBytes = 0;                 // sum of the partial buffers
+    };
+
+    void complete_(Session& s, uint32_t seq, std::string&& msg, uint64_t nowMs, std::vector<std::string>& out);
+    static bool isDone_(const Session& s, uint32_t seq);
+    static void markDone_(Session& s, uint32_t seq);
+    static void advance_(Session& s, uint32_t seq, uint64_t nowMs);
+    static bool ahead_(const Session& s, uint32_t seq) { return !s.started || int32_t(seq - s.stats.highestSeq) > 0; }
+    static void accumulate_(SessionStats& into, const SessionStats& s);
+    // chunk size implied by one fragment, 0 if its offset / length cannot be part of a valid split
+    static uint32_t fragmentChunk_(const framing::FrameHeader& h, size_t n);
+
+private:
+    uint64_t _timeoutMs;
+    std::unordered_map<uint32_t, Session> _sessions;
+    SessionStats _retired;
+};
@@ -0,0 +1,398 @@
+#include "headless.hpp"
+#include "parser.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    /// @brief Options — class/struct documentation.
+    struct Options
+    {
+        fs::path out = ".";
+        unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+        size_t   top = 20;
+        uint64_t minDurUs = 0;
+        bool     json = true;
+        bool     csv = true;
+        std::vector<fs::path> inputs;
+    };
+
+    /// @brief KindStats — class/struct documentation.
+    struct KindStats
+    {
+        std::string category;
+        std::string name;
+        uint64_t count = 0;
+        double   sum = 0.0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+    };
+
+    /// @brief SeriesStats — class/struct documentation.
+    struct SeriesStats
+    {
+        uint64_t count = 0;
+        double   min = 0.0;
+        double   max = 0.0;
+        double   mean = 0.0;
+        double   p95 = 0.0;
+    };
+
+    /// @brief TraceReport — class/struct documentation.
+    struct TraceReport
+    {
+        fs::path    file;
+        std::string stem;          // output file names
+        bool        ok = false;
+        std::string error;
+        size_t      events = 0;
+        size_t      metrics = 0;
+        uint64_t    tsMin = 0;
+        uint64_t    tsMax = 0;
+        std::vector<KindStats> kinds;    // by total time, descending
+        std::vector<Event> top;          // slowest first
+        SeriesStats cpu, cpuTotal, ramUsed;
+        uint64_t    ramTotal = 0;
+        double      parseSec = 0.0;
+        double      analyzeSec = 0.0;
+    };
+
+    void usage()
+    {
+        std::fprintf(stderr,
+            "usage: --headless [--out DIR] [--jobs N] [--top N] [--min-dur US] [--format json|csv|both] <file|dir>...\n"
+            "  per trace: <stem>.analysis.json, <stem>.kinds.csv; summary.csv for the whole run\n");
+    }
+
+    bool parse_args(int argc, char** argv, Options& o)
+    {
+        for (int i = 0; i < argc; ++i)
+        {
+            const std::string_view a = argv[i];
+            auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+            const char* v = nullptr;
+            if (a == "--headless") continue;
+            else if (a == "--out" && (v = next())) o.out = v;
+            else if (a == "--jobs" && (v = next())) o.jobs = unsigned(std::max(1, std::atoi(v)));
+            else if (a == "--top" && (v = next())) o.top = size_t(std::max(0, std::atoi(v)));
+            else if (a == "--min-dur" && (v = next())) o.minDurUs = uint64_t(std::atoll(v));
+            else if (a == "--format" && (v = next()))
+            {
+                const std::string_view f = v;
+                o.json = (f == "json" || f == "both");
+                o.csv = (f == "csv" || f == "both");
+                if (!o.json && !o.csv) return false;
+            }
+            else if (a.starts_with("--")) return false;
+            else o.inputs.emplace_back(argv[i]);
+        }
+        return !o.inputs.empty();
+    }
+
+    // runs fn(0..n-1) on up to jobs threads
+    template <class Fn>
+    void parallel_for(size_t n, unsigned jobs, Fn&& fn)
+    {
+        const size_t workers = std::min<size_t>(jobs, n);
+        if (workers <= 1)
+        {
+            for (size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+        std::atomic<size_t> next{ 0 };
+        std::vector<std::thread> th;
+        th.reserve(workers);
+        for (size_t w = 0; w < workers; ++w)
+            th.emplace_back([&] { for (size_t i; (i = next.fetch_add(1)) < n;) fn(i); });
+        for (auto& t : th) t.join();
+    }
+
+    // exact percentile of a sorted sample (nearest rank)
+    template <class T>
+    T percentile(const std::vector<T>& sorted, double p)
+    {
+        if (sorted.empty()) return T{};
+        const double r = std::ceil(p * double(sorted.size()));
+        const size_t rank = r < 1.0 ? 0 : std::min(sorted.size() - 1, size_t(r) - 1);
+        return sorted[rank];
+    }
+
+    SeriesStats series(std::vector<double>&& v)
+    {
+        SeriesStats s;
+        if (v.empty()) return s;
+        std::sort(v.begin(), v.end());
+        double sum = 0.0;
+        for (double x : v) sum += x;
+        s.count = v.size();
+        s.min = v.front();
+        s.max = v.back();
+        s.mean = sum / double(v.size());
+        s.p95 = percentile(v, 0.95);
+        return s;
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point t0)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    void analyze(TraceReport& r, const Options& o, unsigned innerJobs)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        std::string text;
+        if (!read_file(r.file.string(), text))
+        {
+            r.error = "Unable to read file";
+            return;
+        }
+        std::vector<Event> events;
+        std::vector<Metric> metrics;
+        std::unordered_map<std::string, EventStats> fileStats;
+        if (!parse_trace_payload(text, events, fileStats, metrics, o.minDurUs, &r.error))
+            return;
+        text = {};
+        r.parseSec = seconds_since(t0);
+
+        const auto t1 = std::chrono::steady_clock::now();
+        r.ok = true;
+        r.events = events.size();
+        r.metrics = metrics.size();
+
+        // kinds (category, name) -> durations
+        std::unordered_map<EventKindKey, uint32_t, EventKindKeyHash> ids;
+        std::vector<std::vector<uint64_t>> durs;
+        r.tsMin = events.empty() ? 0 : UINT64_MAX;
+        for (const Event& e : events)
+        {
+            auto [it, inserted] = ids.try_emplace(EventKindKey{ e.category, e.name }, uint32_t(r.kinds.size()));
+            if (inserted)
+            {
+                KindStats k;
+                k.category = e.category;
+                k.name = e.name;
+                r.kinds.push_back(std::move(k));
+                durs.emplace_back();
+            }
+            durs[it->second].push_back(e.dur);
+            r.tsMin = std::min(r.tsMin, e.ts);
+            r.tsMax = std::max(r.tsMax, e.ts + e.dur);
+        }
+        parallel_for(r.kinds.size(), innerJobs, [&](size_t i) {
+            std::vector<uint64_t>& d = durs[i];
+            std::sort(d.begin(), d.end());
+            KindStats& k = r.kinds[i];
+            k.count = d.size();
+            for (uint64_t x : d) k.sum += double(x);
+            k.min = d.front();
+            k.max = d.back();
+            k.p50 = percentile(d, 0.50);
+            k.p90 = percentile(d, 0.90);
+            k.p99 = percentile(d, 0.99);
+            std::vector<uint64_t>().swap(d);
+        });
+        std::sort(r.kinds.begin(), r.kinds.end(), [](const KindStats& a, const KindStats& b) { return a.sum > b.sum; });
+
+        // top N slowest
+        const size_t n = std::min(o.top, events.size());
+        auto slower = [](const Event& a, const Event& b) { return a.dur != b.dur ? a.dur > b.dur : a.ts < b.ts; };
+        std::partial_sort(events.begin(), events.begin() + (ptrdiff_t)n, events.end(), slower);
+        r.top.assign(std::make_move_iterator(events.begin()), std::make_move_iterator(events.begin() + (ptrdiff_t)n));
+
+        // metric tracks
+        std::vector<double> cpu, cpuTotal, ram;
+        cpu.reserve(metrics.size()); cpuTotal.reserve(metrics.size()); ram.reserve(metrics.size());
+        for (const Metric& m : metrics)
+        {
+            cpu.push_back(m.cpu);
+            cpuTotal.push_back(m.cpu_total);
+            ram.push_back(double(m.ram_used));
+            r.ramTotal = std::max(r.ramTotal, m.ram_total);
+        }
+        r.cpu = series(std::move(cpu));
+        r.cpuTotal = series(std::move(cpuTotal));
+        r.ramUsed = series(std::move(ram));
+        r.analyzeSec = seconds_since(t1);
+    }
+
+    // ---------- output ----------
+    std::string csv_field(std::string_view s)
+    {
+        if (s.find_first_of(",\"\n\r") == std::string_view::npos) return std::string(s);
+        std::string q = "\"";
+        for (char c : s) { if (c == '"') q += '"'; q += c; }
+        q += '"';
+        return q;
+    }
+
+    nlohmann::ordered_json series_json(const SeriesStats& s)
+    {
+        return { { "count", s.count }, { "min", s.min }, { "max", s.max }, { "mean", s.mean }, { "p95", s.p95 } };
+    }
+
+    bool write_json(const TraceReport& r, const fs::path& path)
+    {
+        nlohmann::ordered_json j;
+        j["file"] = r.file.string();
+        j["events"] = r.events;
+        j["metrics"] = r.metrics;
+        j["ts_min"] = r.tsMin;
+        j["ts_max"] = r.tsMax;
+        j["span_us"] = r.tsMax - r.tsMin;
+        auto& kinds = j["kinds"] = nlohmann::ordered_json::array();
+        for (const KindStats& k : r.kinds)
+        {
+            kinds.push_back({ { "category", k.category }, { "name", k.name }, { "count", k.count }, { "sum_us", k.sum },
+                { "min_us", k.min }, { "max_us", k.max }, { "mean_us", k.count ? k.sum / double(k.count) : 0.0 },
+                { "p50_us", k.p50 }, { "p90_us", k.p90 }, { "p99_us", k.p99 } });
+        }
+        auto& top = j["slowest"] = nlohmann::ordered_json::array();
+        for (const Event& e : r.top)
+        {
+            top.push_back({ { "name", e.name }, { "category", e.category }, { "ts", e.ts }, { "dur_us", e.dur },
+                { "pid", e.pid }, { "tid", e.tid }, { "id", e.id }, { "data", e.data } });
+        }
+        j["metric_summary"] = { { "cpu", series_json(r.cpu) }, { "cpu_total", series_json(r.cpuTotal) },
+            { "ram_used", series_json(r.ramUsed) }, { "ram_total_max", r.ramTotal } };
+        j["timing"] = { { "parse_s", r.parseSec }, { "analyze_s", r.analyzeSec } };
+
+        std::ofstream f(path, std::ios::binary);
+        if (!f) return false;
+        f << j.dump(2, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+        return bool(f);
+    }
+
+    bool write_kinds_csv(const TraceReport& r, const fs::path& path)
+    {
+        std::ofstream f(path, std::ios::binary);
+        if (!f) return false;
+        f << "category,name,count,sum_us,min_us,max_us,mean_us,p50_us,p90_us,p99_us\n";
+        char num[256];
+        for (const KindStats& k : r.kinds)
+        {
+            std::snprintf(num, sizeof(num), ",%llu,%.0f,%llu,%llu,%.2f,%llu,%llu,%llu\n", (unsigned long long)k.count, k.sum,
+                (unsigned long long)k.min, (unsigned long long)k.max, k.count ? k.sum / double(k.count) : 0.0,
+                (unsigned long long)k.p50, (unsigned long long)k.p90, (unsigned long long)k.p99);
+            f << csv_field(k.category) << ',' << csv_field(k.name) << num;
+        }
+        return bool(f);
+    }
+
+    bool write_summary_csv(const std::vector<TraceReport>& reports, const fs::path& path)
+    {
+        std::ofstream f(path, std::ios::binary);
+        if (!f) return false;
+        f << "file,ok,events,metrics,kinds,span_us,slowest_name,slowest_dur_us,cpu_mean,cpu_max,ram_used_max,parse_s,analyze_s,error\n";
+        char num[256];
+        for (const TraceReport& r : reports)
+        {
+            f << csv_field(r.file.string()) << ',' << (r.ok ? 1 : 0);
+            std::snprintf(num, sizeof(num), ",%zu,%zu,%zu,%llu,", r.events, r.metrics, r.kinds.size(), (unsigned long long)(r.tsMax - r.tsMin));
+            f << num << csv_field(r.top.empty() ? std::string_view{} : std::string_view(r.top.front().name));
+            std::snprintf(num, sizeof(num), ",%llu,%.2f,%.2f,%.0f,%.3f,%.3f,", r.top.empty() ? 0ull : (unsigned long long)r.top.front().dur,
+                r.cpu.mean, r.cpu.max, r.ramUsed.max, r.parseSec, r.analyzeSec);
+            f << num << csv_field(r.error) << '\n';
+        }
+        return bool(f);
+    }
+}
+
+int run_headless(int argc, char** argv)
+{
+    Options opt;
+    if (!parse_args(argc, argv, opt))
+    {
+        usage();
+        return 2;
+    }
+
+    // inputs -> trace files (directories: *.json, sorted)
+    std::vector<TraceReport> reports;
+    for (const fs::path& in : opt.inputs)
+    {
+        std::error_code ec;
+        if (fs::is_directory(in, ec))
+        {
+            std::vector<fs::path> files;
+            for (const auto& de : fs::directory_iterator(in, ec))
+                if (de.is_regular_file() && de.path().extension() == ".json")
+                    files.push_back(de.path());
+            std::sort(files.begin(), files.end());
+            for (auto& p : files) { reports.emplace_back(); reports.back().file = std::move(p); }
+        }
+        else
+        {
+            reports.emplace_back();
+            reports.back().file = in;
+        }
+    }
+    if (reports.empty())
+    {
+        std::fprintf(stderr, "no trace found\n");
+        return 1;
+    }
+    std::error_code ec;
+    fs::create_directories(opt.out, ec);
+
+    // unique output names (same stem in two directories)
+    std::set<std::string> used;
+    for (TraceReport& r : reports)
+    {
+        std::string stem = r.file.stem().string();
+        for (int i = 2; !used.insert(stem).second; ++i)
+            stem = r.file.stem().string() + "_" + std::to_string(i);
+        r.stem = std::move(stem);
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const unsigned outer = unsigned(std::min<size_t>(opt.jobs, reports.size()));
+    const unsigned inner = std::max(1u, opt.jobs / std::max(1u, outer));
+    std::mutex outMtx;
+    int failed = 0;
+    parallel_for(reports.size(), outer, [&](size_t i) {
+        TraceReport& r = reports[i];
+        analyze(r, opt, inner);
+        bool written = true;
+        if (r.ok && opt.json) written &= write_json(r, opt.out / (r.stem + ".analysis.json"));
+        if (r.ok && opt.csv) written &= write_kinds_csv(r, opt.out / (r.stem + ".kinds.csv"));
+        if (r.ok && !written) { r.ok = false; r.error = "Unable to write the report"; }
+
+        std::lock_guard<std::mutex> lk(outMtx);
+        if (r.ok)
+            std::printf("[ok]   %s: %zu events, %zu kinds, %zu metrics (parse %.2f s, analyze %.2f s)\n", r.file.string().c_str(),
+                r.events, r.kinds.size(), r.metrics, r.parseSec, r.analyzeSec);
+        else
+        {
+            std::printf("[fail] %s: %s\n", r.file.string().c_str(), r.error.c_str());
+            ++failed;
+        }
+        std::fflush(stdout);
+    });
+
+    if (!write_summary_csv(reports, opt.out / "summary.csv"))
+        std::fprintf(stderr, "unable to write %s\n", (opt.out / "summary.csv").string().c_str());
+    std::printf("%zu trace(s), %d failed, %.2f s on %u job(s) -> %s\n", reports.size(), failed, seconds_since(t0), opt.jobs,
+        opt.out.string().c_str());
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// =============== Headless batch analysis ===============
+// No window / GL context: parses traces (parser.hpp) and writes per trace
+//   <stem>.analysis.json   per kind stats, top N slowest events, metric summary
+//   <stem>.kinds.csv       per kind stats
+// plus summary.csv (one line per trace) in the output directory.
+//
+//   trace_viewer --headless [--out DIR] [--jobs N] [--top N] [--min-dur US] [--format json|csv|both] <file|dir>...
+//   trace_analyze ...  (same options, built without GLFW / OpenGL)
+//
+// Directories are scanned (not recursively) for *.json. Traces are processed in
+// parallel, the kinds of a trace too when there are fewer traces than jobs.
+// Returns 0 when every trace parsed, 1 otherwise (2 = bad arguments).
+int run_headless(int argc, char** argv);
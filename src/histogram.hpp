@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// =============== Duration histogram ===============
+// Log-scale (HDR like) buckets: values < 8 us get one bucket each, then every
+// power of two is split in 8 linear sub-buckets (~12% relative resolution).
+// Fixed-size array => O(1) insert, O(kBuckets) draw/percentile, whatever the event count.
+struct DurationHistogram
+{
+    static constexpr int kSubBits = 3;
+    static constexpr int kSub = 1 << kSubBits;
+    static constexpr int kBuckets = (64 - kSubBits + 1) * kSub;
+
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t total = 0;
+    uint64_t min_us = UINT64_MAX;
+    uint64_t max_us = 0;
+    double   sum_us = 0.0;
+
+    static int bucketOf(uint64_t us) noexcept
+    {
+        if (us < uint64_t(kSub)) return int(us);
+        const int e = int(std::bit_width(us)) - 1;             // >= kSubBits
+        const int sub = int((us >> (e - kSubBits)) & (kSub - 1));
+        return (e - kSubBits + 1) * kSub + sub;
+    }
+
+    // inclusive lower bound of bucket b (us)
+    static uint64_t bucketLower(int b) noexcept
+    {
+        if (b < kSub) return uint64_t(b);
+        const int e = b / kSub - 1 + kSubBits;
+        const uint64_t sub = uint64_t(b % kSub);
+        return (uint64_t(kSub) + sub) << (e - kSubBits);
+    }
+
+    // exclusive upper bound of bucket b (us)
+    static uint64_t bucketUpper(int b) noexcept
+    {
+        return (b + 1 < kBuckets) ? bucketLower(b + 1) : UINT64_MAX;
+    }
+
+    void add(uint64_t us) noexcept
+    {
+        counts[bucketOf(us)]++;
+        total++;
+        sum_us += double(us);
+        min_us = std::min(min_us, us);
+        max_us = std::max(max_us, us);
+    }
+
+    // retention: forget one sample (min/max fall back to bucket bounds)
+    void remove(uint64_t us) noexcept
+    {
+        const int b = bucketOf(us);
+        if (!total || !counts[b]) return;
+        counts[b]--;
+        total--;
+        sum_us -= double(us);
+        if (!total) { clear(); return; }
+        if (us <= min_us)
+        {
+            int f = b;
+            while (!counts[f]) ++f;
+            min_us = std::max(min_us, bucketLower(f));
+        }
+        if (us >= max_us)
+        {
+            int l = b;
+            while (!counts[l]) --l;
+            max_us = std::min(max_us, bucketUpper(l) - 1);
+        }
+    }
+
+    void clear() noexcept { *this = DurationHistogram{}; }
+
+    int firstBucket() const noexcept { return total ? bucketOf(min_us) : 0; }
+    int lastBucket()  const noexcept { return total ? bucketOf(max_us) : 0; }
+
+    // approximated percentile (bucket lower bound, clamped to observed min/max)
+    uint64_t percentile(double p) const noexcept
+    {
+        if (!total) return 0;
+        const uint64_t rank = std::min<uint64_t>(total - 1, uint64_t(std::clamp(p, 0.0, 1.0) * double(total)));
+        uint64_t acc = 0;
+        for (int b = firstBucket(); b <= lastBucket(); ++b)
+        {
+            acc += counts[b];
+            if (acc > rank)
+                return std::clamp(bucketLower(b), min_us, max_us);
+        }
+        return max_us;
+    }
+};
+
+// =============== Selection bitset ===============
+// One bit per event index; built once per brush change then extended incrementally.
+struct EventBitset
+{
+    std::vector<uint64_t> words;
+    size_t size = 0;
+    size_t setCount = 0;
+
+    void clear() { words.clear(); size = 0; setCount = 0; }
+    void resize(size_t n) { words.resize((n + 63) >> 6, 0); size = n; }
+    void set(size_t i) { uint64_t& w = words[i >> 6]; const uint64_t m = 1ull << (i & 63); if (!(w & m)) { w |= m; ++setCount; } }
+    bool test(size_t i) const { return i < size && (words[i >> 6] >> (i & 63)) & 1ull; }
+    // retention: drop the first n bits (n multiple of 64)
+    void dropFront(size_t n)
+    {
+        if (n >= size) { clear(); return; }
+        const size_t w = n >> 6;
+        for (size_t i = 0; i < w; ++i) setCount -= size_t(std::popcount(words[i]));
+        words.erase(words.begin(), words.begin() + (ptrdiff_t)w);
+        size -= n;
+    }
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// =============== Ingest telemetry ===============
+// Counters of the live pipeline: receive thread -> UI drain -> parse -> index -> retention.
+// Written with relaxed atomics from whichever thread owns the stage, read by the overlay.
+struct IngestStats
+{
+    // network (receive thread)
+    std::atomic<uint64_t> datagrams{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<uint64_t> kernelDrops{ 0 };   // SO_RXQ_OVFL (cumulative, Linux)
+    std::atomic<uint64_t> rxStalls{ 0 };      // no free slot: UI behind
+    std::atomic<uint32_t> queueDepth{ 0 };    // datagrams waiting for the UI
+    std::atomic<uint32_t> queueHigh{ 0 };
+
+    // UI side
+    std::atomic<uint64_t> payloads{ 0 };      // messages handed to tick_live
+    std::atomic<uint64_t> parseOk{ 0 };
+    std::atomic<uint64_t> parseFail{ 0 };
+    std::atomic<uint64_t> undecodable{ 0 };   // bin1 records naming a lost string definition
+    std::atomic<uint64_t> events{ 0 };
+    std::atomic<uint64_t> metrics{ 0 };
+    std::atomic<uint64_t> shmRecords{ 0 };    // same-host shared memory rings
+
+    // per stage processing time (ns)
+    std::atomic<uint64_t> recvNs{ 0 };
+    std::atomic<uint64_t> drainNs{ 0 };
+    std::atomic<uint64_t> parseNs{ 0 };
+    std::atomic<uint64_t> indexNs{ 0 };
+    std::atomic<uint64_t> retentionNs{ 0 };
+
+    void reset()
+    {
+        for (auto* c : { &datagrams, &bytes, &kernelDrops, &rxStalls, &payloads, &parseOk, &parseFail,
+                         &undecodable, &events, &metrics, &shmRecords, &recvNs, &drainNs, &parseNs, &indexNs, &retentionNs })
+            c->store(0, std::memory_order_relaxed);
+        queueDepth.store(0, std::memory_order_relaxed);
+        queueHigh.store(0, std::memory_order_relaxed);
+    }
+
+    static void add(std::atomic<uint64_t>& c, uint64_t v) { c.fetch_add(v, std::memory_order_relaxed); }
+    static void max(std::atomic<uint32_t>& c, uint32_t v)
+    {
+        uint32_t cur = c.load(std::memory_order_relaxed);
+        while (v > cur && !c.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+    }
+};
+
+// RAII stage timer: IngestStageTimer t(stats.parseNs);
+class IngestStageTimer
+{
+public:
+    explicit IngestStageTimer(std::atomic<uint64_t>& acc) : _acc(acc), _t0(std::chrono::steady_clock::now()) {}
+    ~IngestStageTimer()
+    {
+        IngestStats::add(_acc, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _t0).count()));
+    }
+    IngestStageTimer(const IngestStageTimer&) = delete;
+    IngestStageTimer& operator=(const IngestStageTimer&) = delete;
+private:
+    std::atomic<uint64_t>& _acc;
+    std::chrono::steady_clock::time_point _t0;
+};
+
+// =============== Rates ===============
+// Plain snapshot + per second rates over the last sampling window.
+struct IngestSnapshot
+{
+    uint64_t datagrams = 0, bytes = 0, kernelDrops = 0, rxStalls = 0;
+    uint64_t payloads = 0, parseOk = 0, parseFail = 0, undecodable = 0, events = 0, metrics = 0, shmRecords = 0;
+    uint64_t recvNs = 0, drainNs = 0, parseNs = 0, indexNs = 0, retentionNs = 0;
+    uint32_t queueDepth = 0, queueHigh = 0;
+
+    static IngestSnapshot of(const IngestStats& s)
+    {
+        auto ld = [](const auto& a) { return a.load(std::memory_order_relaxed); };
+        IngestSnapshot o;
+        o.datagrams = ld(s.datagrams); o.bytes = ld(s.bytes); o.kernelDrops = ld(s.kernelDrops); o.rxStalls = ld(s.rxStalls);
+        o.payloads = ld(s.payloads); o.parseOk = ld(s.parseOk); o.parseFail = ld(s.parseFail); o.undecodable = ld(s.undecodable);
+        o.events = ld(s.events); o.metrics = ld(s.metrics); o.shmRecords = ld(s.shmRecords);
+        o.recvNs = ld(s.recvNs); o.drainNs = ld(s.drainNs); o.parseNs = ld(s.parseNs); o.indexNs = ld(s.indexNs); o.retentionNs = ld(s.retentionNs);
+        o.queueDepth = ld(s.queueDepth); o.queueHigh = ld(s.queueHigh);
+        return o;
+    }
+};
+
+/// @brief IngestRates — class/struct documentation.
+struct IngestRates
+{
+    double datagramsPerSec = 0.0;
+    double bytesPerSec = 0.0;
+    double eventsPerSec = 0.0;
+    double metricsPerSec = 0.0;
+    double parseFailPerSec = 0.0;
+    double dropsPerSec = 0.0;
+    double shmRecordsPerSec = 0.0;
+    // share of wall time spent per stage over the window (0..1)
+    double recvLoad = 0.0, drainLoad = 0.0, parseLoad = 0.0, indexLoad = 0.0, retentionLoad = 0.0;
+
+    IngestSnapshot last{};
+    double lastSec = -1.0;
+
+    // call every frame; rates refresh once per window
+    void sample(const IngestStats& s, double nowSec, double windowSec = 1.0)
+    {
+        if (lastSec < 0.0) { last = IngestSnapshot::of(s); lastSec = nowSec; return; }
+        const double dt = nowSec - lastSec;
+        if (dt < windowSec) return;
+        const IngestSnapshot cur = IngestSnapshot::of(s);
+        auto rate = [dt](uint64_t a, uint64_t b) { return b >= a ? double(b - a) / dt : 0.0; };
+        auto load = [dt](uint64_t a, uint64_t b) { return b >= a ? double(b - a) * 1e-9 / dt : 0.0; };
+        datagramsPerSec = rate(last.datagrams, cur.datagrams);
+        bytesPerSec = rate(last.bytes, cur.bytes);
+        eventsPerSec = rate(last.events, cur.events);
+        metricsPerSec = rate(last.metrics, cur.metrics);
+        parseFailPerSec = rate(last.parseFail, cur.parseFail);
+        dropsPerSec = rate(last.kernelDrops, cur.kernelDrops);
+        shmRecordsPerSec = rate(last.shmRecords, cur.shmRecords);
+        recvLoad = load(last.recvNs, cur.recvNs);
+        drainLoad = load(last.drainNs, cur.drainNs);
+        parseLoad = load(last.parseNs, cur.parseNs);
+        indexLoad = load(last.indexNs, cur.indexNs);
+        retentionLoad = load(last.retentionNs, cur.retentionNs);
+        last = cur;
+        lastSec = nowSec;
+    }
+};
+
+// JSON snapshot (counters + current rates)
+inline bool write_ingest_stats_json(const std::string& path, const IngestSnapshot& s, const IngestRates& r, std::string* err = nullptr)
+{
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+    {
+        if (err) *err = "Unable to write " + path;
+        return false;
+    }
+    using ull = unsigned long long;
+    std::fprintf(f,
+        "{\n"
+        "  \"counters\": {\n"
+        "    \"datagrams\": %llu, \"bytes\": %llu, \"kernel_drops\": %llu, \"rx_stalls\": %llu,\n"
+        "    \"queue_depth\": %u, \"queue_high\": %u,\n"
+        "    \"payloads\": %llu, \"parse_ok\": %llu, \"parse_fail\": %llu, \"undecodable\": %llu, \"events\": %llu, \"metrics\": %llu, \"shm_records\": %llu\n"
+        "  },\n"
+        "  \"stage_ns\": { \"recv\": %llu, \"drain\": %llu, \"parse\": %llu, \"index\": %llu, \"retention\": %llu },\n"
+        "  \"rates\": {\n"
+        "    \"datagrams_per_s\": %.1f, \"bytes_per_s\": %.1f, \"events_per_s\": %.1f, \"metrics_per_s\": %.1f,\n"
+        "    \"parse_fail_per_s\": %.1f, \"drops_per_s\": %.1f, \"shm_records_per_s\": %.1f\n"
+        "  },\n"
+        "  \"stage_load\": { \"recv\": %.4f, \"drain\": %.4f, \"parse\": %.4f, \"index\": %.4f, \"retention\": %.4f }\n"
+        "}\n",
+        ull(s.datagrams), ull(s.bytes), ull(s.kernelDrops), ull(s.rxStalls), s.queueDepth, s.queueHigh,
+        ull(s.payloads), ull(s.parseOk), ull(s.parseFail), ull(s.undecodable), ull(s.events), ull(s.metrics), ull(s.shmRecords),
+        ull(s.recvNs), ull(s.drainNs), ull(s.parseNs), ull(s.indexNs), ull(s.retentionNs),
+        r.datagramsPerSec, r.bytesPerSec, r.eventsPerSec, r.metricsPerSec, r.parseFailPerSec, r.dropsPerSec, r.shmRecordsPerSec,
+        r.recvLoad, r.drainLoad, r.parseLoad, r.indexLoad, r.retentionLoad);
+    const bool ok = std::fclose(f) == 0;
+    if (!ok && err) *err = "Write failed: " + path;
+    return ok;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// =============== K-way merge ===============
+// Merges k runs, each already sorted by key, into out (appended) in O(n log k).
+// Ties keep the run order, then the order inside the run (stable).
+template <class T, class Key>
+inline void kway_merge(std::vector<std::vector<T>>& runs, std::vector<T>& out, Key&& key)
+{
+    size_t total = 0, nonEmpty = 0, last = 0;
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+        total += runs[r].size();
+        if (!runs[r].empty()) { ++nonEmpty; last = r; }
+    }
+    out.reserve(out.size() + total);
+    if (nonEmpty == 1)
+    {
+        std::move(runs[last].begin(), runs[last].end(), std::back_inserter(out));
+        runs[last].clear();
+        return;
+    }
+
+    using K = std::decay_t<decltype(key(std::declval<const T&>()))>;
+    /// @brief Head — class/struct documentation.
+    struct Head
+    {
+        K key;
+        size_t run;
+        size_t pos;
+        bool operator>(const Head& o) const { return key != o.key ? o.key < key : o.run < run; }
+    };
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    for (size_t r = 0; r < runs.size(); ++r)
+        if (!runs[r].empty()) heap.push(Head{ key(runs[r][0]), r, 0 });
+
+    while (!heap.empty())
+    {
+        Head h = heap.top();
+        heap.pop();
+        std::vector<T>& run = runs[h.run];
+        out.push_back(std::move(run[h.pos]));
+        if (++h.pos < run.size())
+        {
+            h.key = key(run[h.pos]);
+            heap.push(h);
+        }
+    }
+    for (auto& r : runs) r.clear();
+}
@@ -0,0 +1,106 @@
+#include "label_cache.hpp"
+
+#include <imgui_internal.h>
+
+#include <algorithm>
+
+namespace
+{
+    // code point at s[i], n = its UTF-8 length
+    unsigned next_char(std::string_view s, size_t i, size_t& n)
+    {
+        const unsigned char b = static_cast<unsigned char>(s[i]);
+        if (b < 0x80)
+        {
+            n = 1;
+            return b;
+        }
+        unsigned c = 0;
+        n = size_t(std::max(1, ImTextCharFromUtf8(&c, s.data() + i, s.data() + s.size())));
+        return c;
+    }
+}
+
+void LabelCache::beginFrame()
+{
+    ImFont* font = ImGui::GetFont();
+    const float size = ImGui::GetFontSize();
+    if (font == _font && size == _size)
+        return;
+    _font = font;
+    _size = size;
+    _latin.fill(0.f);
+    for (unsigned c = 0; c < _latin.size(); ++c)
+        _latin[c] = advance(c);
+    _dots = measure(kDots);
+    _prefix.clear();
+}
+
+float LabelCache::advance(unsigned c)
+{
+    if (c < _latin.size() && _latin[c] > 0.f)
+        return _latin[c];
+#if IMGUI_VERSION_NUM >= 19200
+    return ImGui::GetFontBaked()->GetCharAdvance(ImWchar(c));
+#else
+    return _font->GetCharAdvance(ImWchar(c)) * (_size / _font->FontSize);
+#endif
+}
+
+float LabelCache::measure(std::string_view text)
+{
+    float w = 0.f;
+    for (size_t i = 0, n = 0; i < text.size(); i += n)
+        w += advance(next_char(text, i, n));
+    return w;
+}
+
+const std::vector<float>& LabelCache::prefix(uint32_t id, std::string_view text)
+{
+    if (id >= _prefix.size())
+        _prefix.resize(size_t(id) + 1);
+    std::vector<float>& p = _prefix[id];
+    if (p.size() == text.size() + 1)
+        return p;
+
+    // offsets inside a multi byte character repeat the width before it (never a cut point)
+    p.assign(text.size() + 1, 0.f);
+    float x = 0.f;
+    for (size_t i = 0, n = 0; i < text.size(); i += n)
+    {
+        const float a = advance(next_char(text, i, n));
+        n = std::min(n, text.size() - i);
+        for (size_t k = 1; k < n; ++k)
+            p[i + k] = x;
+        x += a;
+        p[i + n] = x;
+    }
+    return p;
+}
+
+LabelCache::Fit LabelCache::fit(uint32_t id, std::string_view text, float maxPx)
+{
+    Fit f;
+    if (maxPx <= 0.f || text.empty())
+        return f;
+    const std::vector<float>& p = prefix(id, text);
+    if (p.back() <= maxPx)
+        return { text.size(), false, p.back(), p.back() };
+
+    const float room = maxPx - _dots;
+    if (room < 0.f)
+        return f;
+    // last offset whose prefix fits, moved back to a character start
+    size_t n = size_t(std::upper_bound(p.begin(), p.end(), room) - p.begin()) - 1;
+    while (n > 0 && (static_cast<unsigned char>(text[n]) & 0xC0) == 0x80)
+        --n;
+    return { n, true, p[n], p[n] + _dots };
+}
+
+void LabelCache::draw(ImDrawList* dl, const ImVec2& pos, ImU32 color, std::string_view text, const Fit& f)
+{
+    if (f.bytes)
+        dl->AddText(pos, color, text.data(), text.data() + f.bytes);
+    if (f.elided)
+        dl->AddText(ImVec2(pos.x + f.prefixWidth, pos.y), color, kDots.data(), kDots.data() + kDots.size());
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <imgui.h>
+
+// =============== Label widths ===============
+// Event labels are elided to their box width every frame. Instead of CalcTextSize on
+// trial substrings, each label (keyed by its interned id, Event::kind) keeps the prefix
+// width at every byte offset, built once from a glyph advance table of the current font:
+// fitting a label is then a binary search, nothing is allocated.
+// Tables are rebuilt when the font or its size changes; clear() when ids are reassigned.
+class LabelCache
+{
+public:
+    /// @brief Fit — class/struct documentation.
+    struct Fit
+    {
+        size_t bytes = 0;         // prefix drawn
+        bool   elided = false;    // "..." follows the prefix
+        float  prefixWidth = 0.f;
+        float  width = 0.f;       // prefix + "..." in px
+        bool empty() const { return bytes == 0 && !elided; }
+    };
+
+    // Once per frame, before any fit() / measure().
+    void beginFrame();
+    void clear() { _prefix.clear(); }
+
+    // Longest prefix of text (+ "..." when cut) that fits maxPx.
+    Fit fit(uint32_t id, std::string_view text, float maxPx);
+    // Whole uncached text (short counters), measured from the advance table.
+    Fit whole(std::string_view text)
+    {
+        const float w = measure(text);
+        return { text.size(), false, w, w };
+    }
+    // Draws the fitted prefix and the ellipsis at pos.
+    static void draw(ImDrawList* dl, const ImVec2& pos, ImU32 color, std::string_view text, const Fit& f);
+
+private:
+    float advance(unsigned c);
+    float measure(std::string_view text);
+    const std::vector<float>& prefix(uint32_t id, std::string_view text);
+
+private:
+    static constexpr std::string_view kDots = "...";
+
+    ImFont* _font = nullptr;
+    float _size = 0.f;
+    std::array<float, 256> _latin{};        // advances of U+0000..U+00FF
+    float _dots = 0.f;
+    // by id: width before byte i (text.size() + 1 entries), empty = not built
+    std::vector<std::vector<float>> _prefix;
+};
@@ -5,10 +5,19 @@
 #include "backends/imgui_impl_opengl3.h"
 
 #include "ViewerApp.hpp"
+#include "headless.hpp"
 #include "style.hpp"
+#include "self_profile.hpp"
 
-int main(int, char**)
+#include <string_view>
+
+int main(int argc, char** argv)
 {
+    // batch analysis: no window, no GL context
+    for (int i = 1; i < argc; ++i)
+        if (std::string_view(argv[i]) == "--headless")
+            return run_headless(argc - 1, argv + 1);
+
     if (!glfwInit()) return 1;
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -26,31 +35,54 @@ int main(int, char**)
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
-    ViewerApp app;
     SetupImGuiStylePro();
 
 #ifdef IMGUI_HAS_VIEWPORT
     ImGui_ImplGlfw_SetCallbacksChainForAllWindows(true);
 #endif
 
-    while (!glfwWindowShouldClose(window))
+    // scoped: the app owns GL objects, released before the context goes away
     {
-        glfwPollEvents();
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        // main frame
-        app.drawUI();
-
-        ImGui::Render();
-        int dw, dh;
-        glfwGetFramebufferSize(window, &dw, &dh);
-        glViewport(0, 0, dw, dh);
-        glClearColor(0.06f, 0.08f, 0.11f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
+        ViewerApp app;
+        FrameScheduler& frames = app.frames();
+        frames.setWaker(&glfwPostEmptyEvent);
+        selfprof::setThreadName("ui");
+        while (!glfwWindowShouldClose(window))
+        {
+            // idle: block until input, a wake up (live data) or the next deadline
+            const double idle = frames.idleTimeout();
+            if (idle > 0.0)
+                glfwWaitEventsTimeout(idle);
+            else
+                glfwPollEvents();
+            frames.beginFrame();
+            selfprof::beginFrame();
+            {
+                PROFILE_SCOPE("NewFrame");
+                ImGui_ImplOpenGL3_NewFrame();
+                ImGui_ImplGlfw_NewFrame();
+                ImGui::NewFrame();
+            }
+
+            // main frame
+            app.drawUI();
+
+            {
+                PROFILE_SCOPE("render");
+                ImGui::Render();
+                int dw, dh;
+                glfwGetFramebufferSize(window, &dw, &dh);
+                glViewport(0, 0, dw, dh);
+                glClearColor(0.06f, 0.08f, 0.11f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
+            {
+                PROFILE_SCOPE("present");
+                glfwSwapBuffers(window);
+            }
+            selfprof::endFrame();
+        }
     }
 
     ImGui_ImplOpenGL3_Shutdown();
@@ -0,0 +1,77 @@
+#include "metric_index.hpp"
+#include <algorithm>
+#include <limits>
+
+void MetricSeriesIndex::clear()
+{
+    _raw.clear();
+    _min.clear();
+    _max.clear();
+}
+
+void MetricSeriesIndex::indexFrom(const std::vector<Metric>& metrics, size_t beginIdx)
+{
+    if (beginIdx == 0 || beginIdx > _raw.size())
+    {
+        clear();
+        beginIdx = 0;
+    }
+
+    _raw.resize(metrics.size());
+    for (size_t i = beginIdx; i < metrics.size(); ++i)
+        _raw[i] = float(_get(metrics[i]));
+
+    // propagate the dirty tail up the pyramid
+    size_t changed = beginIdx;
+    size_t below = _raw.size();
+    for (size_t level = 1; below > 1; ++level)
+    {
+        const size_t sz = (below + 1) / 2;
+        if (_min.size() < level)
+        {
+            _min.emplace_back();
+            _max.emplace_back();
+        }
+        auto& mn = _min[level - 1];
+        auto& mx = _max[level - 1];
+        mn.resize(sz);
+        mx.resize(sz);
+        for (size_t j = changed >> 1; j < sz; ++j)
+        {
+            const size_t a = 2 * j, b = 2 * j + 1;
+            float lo = nodeMin(level - 1, a), hi = nodeMax(level - 1, a);
+            if (b < below)
+            {
+                lo = std::min(lo, nodeMin(level - 1, b));
+                hi = std::max(hi, nodeMax(level - 1, b));
+            }
+            mn[j] = lo;
+            mx[j] = hi;
+        }
+        changed >>= 1;
+        below = sz;
+    }
+}
+
+std::pair<float, float> MetricSeriesIndex::minMax(size_t i0, size_t i1) const
+{
+    float lo = std::numeric_limits<float>::max();
+    float hi = std::numeric_limits<float>::lowest();
+    i1 = std::min(i1, _raw.size());
+    for (size_t level = 0; i0 < i1; ++level, i0 >>= 1, i1 >>= 1)
+    {
+        if (i0 & 1)
+        {
+            lo = std::min(lo, nodeMin(level, i0));
+            hi = std::max(hi, nodeMax(level, i0));
+            ++i0;
+        }
+        if (i1 & 1)
+        {
+            --i1;
+            lo = std::min(lo, nodeMin(level, i1));
+            hi = std::max(hi, nodeMax(level, i1));
+        }
+    }
+    return { lo, hi };
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "model.hpp"
+
+// =============== Metric series index ===============
+// Min/max pyramid over one field of the ts-sorted metrics (bottom-up segment tree).
+// Level 0 is the raw series (first/last of any bucket are raw[begin] / raw[end-1]),
+// level l+1 pairs the nodes of level l. Range min/max is O(log n) whatever the
+// zoom, which is what the per-pixel-column M4 reduction needs.
+class MetricSeriesIndex
+{
+public:
+    using Getter = double (*)(const Metric&);
+
+    explicit MetricSeriesIndex(Getter getter) : _get(getter) {}
+
+    void clear();
+    // (re)index samples [beginIdx, end) of the series; beginIdx == 0 rebuilds everything.
+    void indexFrom(const std::vector<Metric>& metrics, size_t beginIdx);
+
+    size_t size() const { return _raw.size(); }
+    float  value(size_t i) const { return _raw[i]; }
+
+    // min/max over samples [i0, i1)
+    std::pair<float, float> minMax(size_t i0, size_t i1) const;
+
+private:
+    float nodeMin(size_t level, size_t j) const { return level ? _min[level - 1][j] : _raw[j]; }
+    float nodeMax(size_t level, size_t j) const { return level ? _max[level - 1][j] : _raw[j]; }
+
+private:
+    Getter _get;
+    std::vector<float> _raw;
+    // _min[l] / _max[l] hold pyramid level l+1
+    std::vector<std::vector<float>> _min;
+    std::vector<std::vector<float>> _max;
+};
@@ -50,7 +50,8 @@ struct EventKindKeyHash
 
 // =============== Event ===============
 // producer: { name, cat, data, ph, ts, dur, pid, tid, id, color }
-// + client derived filed (normStart/normEnd).
+// + client derived fields (kind, paint, seq, ...). Timeline positions are computed from
+//   the absolute ts at draw time, so nothing needs updating when the range changes.
 // + "stats" local stored
 struct Event {
     // Producteur
@@ -68,9 +69,16 @@ struct Event {
     // Compat: stats holder
     EventStats  stats{};
 
-    // Derived client (normilized timeline [0..1])
-    double normStart = 0.0;
-    double normEnd = 0.0;
+    // Interned (category,name) id, assigned on ingest
+    uint32_t kind = 0;
+    // Resolved color (ColorTable swatch index), assigned on ingest
+    uint32_t paint = 0;
+    // Global ingest sequence number (EventStore)
+    uint64_t seq = 0;
+    // Live session that sent it (UdpClient source id, 0 = file / replay)
+    uint16_t source = 0;
+    // Async chain of the fragment (AsyncChainIndex slot + 1, 0 = none), assigned on ingest
+    uint32_t chain = 0;
 };
 
 // =============== Full Document ===============
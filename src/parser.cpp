@@ -1,4 +1,6 @@
 #include "parser.hpp"
+#include "self_profile.hpp"
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <nlohmann/json.hpp>
@@ -14,6 +16,16 @@ bool read_file(const std::string& path, std::string& out)
     return true;
 }
 
+// "id" may be a number or a string ("0x1f", Chrome trace style)
+static uint64_t parse_id(const json& o)
+{
+    auto it = o.find("id");
+    if (it == o.end()) return 0;
+    if (it->is_number_unsigned() || it->is_number_integer()) return it->get<uint64_t>();
+    if (it->is_string()) return std::strtoull(it->get_ref<const std::string&>().c_str(), nullptr, 0);
+    return 0;
+}
+
 static void parse_event_object(const json& o, std::vector<Event>& out, uint64_t durMinUs)
 {
     Event e;
@@ -23,6 +35,9 @@ static void parse_event_object(const json& o, std::vector<Event>& out, uint64_t
     e.ts = o.value("ts", 0ull);
     e.dur = o.value("dur", 0ull);
     e.color = o.value("color", std::string());
+    e.pid = o.value("pid", 1u);
+    e.tid = o.value("tid", 0u);
+    e.id = parse_id(o);
 
     if (durMinUs == 0 || e.dur >= durMinUs)
         out.push_back(std::move(e));
@@ -85,6 +100,7 @@ static void parse_one_object(const json& obj, std::vector<Event>& outEvents, std
 // ---------- API ----------
 bool parse_trace_payload(const std::string& jsonText, std::vector<Event>& outEvents, std::unordered_map<std::string, EventStats>& outStats, std::vector<Metric>& outMetrics, uint64_t durMinUs, std::string* outError)
 {
+    PROFILE_SCOPE("parse_trace_payload");
     json root;
     try
     {
@@ -137,3 +153,82 @@ bool parse_trace_payload(const std::string& jsonText, std::vector<Event>& outEve
     if (outError) *outError = "Unsupported JSON root";
     return false;
 }
+
+// ---------- Streaming API ----------
+// The parser callback drops every record object once it is converted (return false),
+// so only one record is materialized at a time.
+bool parse_trace_stream(std::istream& in, const std::function<void(Event&&)>& onEvent, const std::function<void(const Metric&)>& onMetric, uint64_t durMinUs, std::string* outError)
+{
+    return parse_trace_stream(in, onEvent, onMetric, {}, durMinUs, outError);
+}
+
+bool parse_trace_stream(std::istream& in, const std::function<void(Event&&)>& onEvent, const std::function<void(const Metric&)>& onMetric,
+                        const std::function<void(const std::string&, const EventStats&)>& onStat, uint64_t durMinUs, std::string* outError)
+{
+    PROFILE_SCOPE("parse_trace_stream");
+    enum class Root { Unknown, Array, Object };
+    Root root = Root::Unknown;
+    std::string section;   // key of the root object being parsed
+    std::vector<Event> evs;
+    std::vector<Metric> ms;
+    std::unordered_map<std::string, EventStats> stats;
+
+    auto flushRecords = [&] {
+        for (Event& e : evs) onEvent(std::move(e));
+        for (const Metric& m : ms) onMetric(m);
+        if (onStat)
+            for (const auto& kv : stats) onStat(kv.first, kv.second);
+        evs.clear();
+        ms.clear();
+        stats.clear();
+    };
+
+    json::parser_callback_t cb = [&](int depth, json::parse_event_t ev, json& parsed) -> bool
+    {
+        if (depth == 0 && root == Root::Unknown)
+        {
+            if (ev == json::parse_event_t::array_start) root = Root::Array;
+            else if (ev == json::parse_event_t::object_start) root = Root::Object;
+        }
+        if (ev == json::parse_event_t::key && depth == 1 && root == Root::Object)
+            section = parsed.is_string() ? parsed.get<std::string>() : std::string{};
+        if (ev != json::parse_event_t::object_end)
+            return true;
+
+        // 2) mixed array element
+        if (root == Root::Array && depth == 1)
+        {
+            parse_one_object(parsed, evs, stats, ms, durMinUs);
+            flushRecords();
+            return false;
+        }
+        // 1) {"traceEvents":[...], "metrics":[...]} element
+        if (root == Root::Object && depth == 2)
+        {
+            if (section == "traceEvents") parse_one_object(parsed, evs, stats, ms, durMinUs);
+            else if (section == "metrics") parse_metric_object(parsed, ms);
+            else if (section == "stats" && onStat) parse_stat_object(parsed, stats);
+            flushRecords();
+            return false;
+        }
+        // 3) unique object (only its remaining members are kept)
+        if (root == Root::Object && depth == 0)
+        {
+            parse_one_object(parsed, evs, stats, ms, durMinUs);
+            flushRecords();
+        }
+        return true;
+    };
+
+    try
+    {
+        const json skeleton = json::parse(in, cb);  // records dropped, only the root shell is left
+    }
+    catch (const std::exception& e)
+    {
+        if (outError)
+            *outError = e.what();
+        return false;
+    }
+    return true;
+}
@@ -2,6 +2,8 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <functional>
+#include <istream>
 #include "model.hpp"
 
 // Parse JSON trace into events.
@@ -16,3 +18,11 @@
 // True in success
 bool parse_trace_payload(const std::string& jsonText, std::vector<Event>& out, std::unordered_map<std::string, EventStats>& outGlobalStats, std::vector<Metric>& outMetrics, uint64_t durMinUs = 0, std::string* outError = nullptr);
 bool read_file(const std::string& path, std::string& out);
+
+// Streaming variant for traces larger than memory: records are handed over one by one
+// (same layouts as parse_trace_payload) and discarded once parsed.
+// "stats" entries are skipped. Returns false on a parse error.
+bool parse_trace_stream(std::istream& in, const std::function<void(Event&&)>& onEvent, const std::function<void(const Metric&)>& onMetric, uint64_t durMinUs = 0, std::string* outError = nullptr);
+// Same, "stats" entries handed over too (by name, a later one replaces an earlier one).
+bool parse_trace_stream(std::istream& in, const std::function<void(Event&&)>& onEvent, const std::function<void(const Metric&)>& onMetric,
+                        const std::function<void(const std::string&, const EventStats&)>& onStat, uint64_t durMinUs = 0, std::string* outError = nullptr);
@@ -0,0 +1,230 @@
+#include "self_profile.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace selfprof
+{
+    namespace
+    {
+        // One zone slot, a seqlock: seq is 0 while the owner writes it, then (ring index + 1).
+        // Other threads (exportTrace) keep a copy only if seq is the expected index before
+        // and after reading the fields, so a slot overwritten meanwhile is skipped. Release
+        // field stores / acquire field loads order them against seq (no fence, TSan clean).
+        struct Slot
+        {
+            std::atomic<uint64_t> seq{ 0 };
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<uint64_t> t0{ 0 };
+            std::atomic<uint64_t> t1{ 0 };
+            std::atomic<uint32_t> depth{ 0 };
+        };
+
+        // single writer (its thread)
+        struct ThreadRing
+        {
+            std::unique_ptr<Slot[]> slots{ new Slot[kRingSize] };
+            std::atomic<uint64_t> head{ 0 };
+            uint32_t tid = 0;
+            std::string name;
+        };
+
+        std::mutex g_ringsMtx;
+        std::vector<std::shared_ptr<ThreadRing>> g_rings;   // kept after their thread exits
+        thread_local std::shared_ptr<ThreadRing> t_ring;    // created by the first zone
+        thread_local std::string t_name;                    // setThreadName before that
+
+        ThreadRing& thread_ring()
+        {
+            if (!t_ring)
+            {
+                t_ring = std::make_shared<ThreadRing>();
+                std::lock_guard<std::mutex> lk(g_ringsMtx);
+                t_ring->tid = uint32_t(g_rings.size()) + 1;
+                t_ring->name = t_name.empty() ? "thread " + std::to_string(t_ring->tid) : t_name;
+                g_rings.push_back(t_ring);
+            }
+            return *t_ring;
+        }
+
+        Zone load(const Slot& s, std::memory_order mo)
+        {
+            return Zone{ s.name.load(mo), s.t0.load(mo), s.t1.load(mo), s.depth.load(mo) };
+        }
+
+        // any thread: false when slot i is being written or was overwritten by a later lap
+        bool load_consistent(const Slot& s, uint64_t i, Zone& out)
+        {
+            const uint64_t seq = s.seq.load(std::memory_order_acquire);
+            if (seq != i + 1) return false;
+            out = load(s, std::memory_order_acquire);
+            return s.seq.load(std::memory_order_relaxed) == seq;
+        }
+
+        // UI thread state
+        uint64_t g_frameT0 = 0;
+        bool g_frameOpen = false;
+        FrameReport g_report;
+        std::vector<float> g_history;
+        size_t g_historyPos = 0;
+
+        void json_string(std::FILE* f, const std::string& s)
+        {
+            std::fputc('"', f);
+            for (char c : s)
+            {
+                if (c == '"' || c == '\\') std::fputc('\\', f);
+                if (static_cast<unsigned char>(c) >= 0x20) std::fputc(c, f);
+            }
+            std::fputc('"', f);
+        }
+    }
+
+    std::atomic<bool> detail::g_enabled{ false };
+
+    void detail::record(const char* name, uint64_t t0, uint64_t t1, uint32_t depth)
+    {
+        ThreadRing& r = thread_ring();
+        const uint64_t h = r.head.load(std::memory_order_relaxed);
+        Slot& s = r.slots[h & (kRingSize - 1)];
+        s.seq.store(0, std::memory_order_relaxed);
+        s.name.store(name, std::memory_order_release);
+        s.t0.store(t0, std::memory_order_release);
+        s.t1.store(t1, std::memory_order_release);
+        s.depth.store(depth, std::memory_order_release);
+        s.seq.store(h + 1, std::memory_order_release);
+        r.head.store(h + 1, std::memory_order_release);
+    }
+
+    void setEnabled(bool on)
+    {
+        detail::g_enabled.store(on, std::memory_order_relaxed);
+    }
+
+    void setThreadName(const char* name)
+    {
+        // no ring (a few MB) for threads that never record a zone
+        t_name = name;
+        if (!t_ring) return;
+        std::lock_guard<std::mutex> lk(g_ringsMtx);
+        t_ring->name = name;
+    }
+
+    void beginFrame()
+    {
+        if (!enabled()) return;
+        g_frameOpen = true;
+        g_frameT0 = detail::now();
+        ++detail::t_depth;
+    }
+
+    void endFrame()
+    {
+        if (!g_frameOpen) return;
+        g_frameOpen = false;
+        --detail::t_depth;
+        const uint64_t t1 = detail::now();
+        detail::record("frame", g_frameT0, t1, detail::t_depth);
+
+        // zones of this frame: the ring tail back to the frame start (completion order)
+        ThreadRing& r = thread_ring();
+        const uint64_t head = r.head.load(std::memory_order_relaxed) - 1;   // without "frame"
+        std::vector<StageTime>& stages = g_report.stages;
+        std::vector<uint64_t> firstT0;
+        stages.clear();
+        for (uint64_t i = head, n = 0; i-- > 0 && n < kRingSize - 1; ++n)
+        {
+            const Zone z = load(r.slots[i & (kRingSize - 1)], std::memory_order_relaxed);   // own ring
+            if (z.t0 < g_frameT0) break;
+            auto it = std::find_if(stages.begin(), stages.end(), [&](const StageTime& s) { return s.name == z.name; });
+            if (it == stages.end())
+            {
+                stages.push_back({ z.name, z.depth, 0, 0.0 });
+                firstT0.push_back(z.t0);
+                it = stages.end() - 1;
+            }
+            const size_t k = size_t(it - stages.begin());
+            it->calls += 1;
+            it->ms += double(z.t1 - z.t0) * 1e-6;
+            it->depth = std::min(it->depth, z.depth);
+            firstT0[k] = std::min(firstT0[k], z.t0);
+        }
+        std::vector<size_t> order(stages.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return firstT0[a] < firstT0[b]; });
+        std::vector<StageTime> sorted;
+        sorted.reserve(stages.size());
+        for (size_t i : order) sorted.push_back(stages[i]);
+        stages.swap(sorted);
+
+        g_report.frameMs = double(t1 - g_frameT0) * 1e-6;
+        ++g_report.frame;
+        if (g_history.size() < kHistory) g_history.push_back(float(g_report.frameMs));
+        else g_history[g_historyPos] = float(g_report.frameMs);
+        g_historyPos = (g_historyPos + 1) % kHistory;
+        g_report.history.assign(g_history.begin() + ptrdiff_t(g_history.size() < kHistory ? 0 : g_historyPos), g_history.end());
+        g_report.history.insert(g_report.history.end(), g_history.begin(), g_history.begin() + ptrdiff_t(g_history.size() < kHistory ? 0 : g_historyPos));
+    }
+
+    const FrameReport& report()
+    {
+        return g_report;
+    }
+
+    bool exportTrace(const std::string& path, std::string* err)
+    {
+        std::vector<std::shared_ptr<ThreadRing>> rings;
+        {
+            std::lock_guard<std::mutex> lk(g_ringsMtx);
+            rings = g_rings;
+        }
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f)
+        {
+            if (err) *err = "Unable to write " + path;
+            return false;
+        }
+
+        // the writers keep going: slots they overwrite meanwhile fail the sequence check
+        std::vector<Zone> zones;
+        bool first = true;
+        std::fputs("[\n", f);
+        for (const auto& r : rings)
+        {
+            const uint64_t head = r->head.load(std::memory_order_acquire);
+            const uint64_t n = std::min<uint64_t>(head, kRingSize);
+            zones.clear();
+            zones.reserve(size_t(n));
+            for (uint64_t i = head - n; i < head; ++i)
+            {
+                Zone z;
+                if (load_consistent(r->slots[i & (kRingSize - 1)], i, z))
+                    zones.push_back(z);
+            }
+            std::string name;
+            {
+                std::lock_guard<std::mutex> lk(g_ringsMtx);
+                name = r->name;
+            }
+            for (const Zone& z : zones)
+            {
+                std::fputs(first ? "  " : ",\n  ", f);
+                first = false;
+                std::fputs("{\"type\":\"event\",\"name\":", f);
+                json_string(f, z.name);
+                std::fputs(",\"cat\":", f);
+                json_string(f, name);
+                // us, rounded outward so sub-microsecond zones stay visible
+                const unsigned long long ts = z.t0 / 1000, end = (z.t1 + 999) / 1000;
+                std::fprintf(f, ",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u,\"data\":\"depth %u, %.3f us\"}",
+                    ts, end - ts, r->tid, z.depth, double(z.t1 - z.t0) * 1e-3);
+            }
+        }
+        std::fputs("\n]\n", f);
+        const bool ok = std::fclose(f) == 0;
+        if (!ok && err) *err = "Write failed: " + path;
+        return ok;
+    }
+}
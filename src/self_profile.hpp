@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =============== Self profiling ===============
+// Scoped zones of the viewer itself (PROFILE_SCOPE("name")), recorded into one ring per thread
+// (kRingSize zones, the oldest overwritten), allocated by the thread's first zone. Off: a relaxed
+// load per zone; on: two clock reads and a few relaxed atomic stores (per slot seqlock, so
+// exportTrace can copy the rings while they are written), no lock. Zone names are stored
+// as pointers: string literals only.
+// The UI thread brackets its frames with beginFrame() / endFrame(); endFrame() breaks the frame
+// down per zone for the HUD. exportTrace() writes every ring as a trace file the viewer loads
+// (category = thread name, tid = ring).
+namespace selfprof
+{
+    inline constexpr size_t kRingSize = size_t(1) << 16;
+    inline constexpr size_t kHistory = 240;   // frame times kept for the HUD plot
+
+    /// @brief Zone — class/struct documentation.
+    struct Zone
+    {
+        const char* name;
+        uint64_t t0;      // ns, steady clock
+        uint64_t t1;
+        uint32_t depth;   // nesting on its thread
+    };
+
+    /// @brief StageTime — class/struct documentation.
+    struct StageTime
+    {
+        const char* name = nullptr;
+        uint32_t depth = 0;
+        uint32_t calls = 0;
+        double ms = 0.0;          // inclusive, summed over the calls
+    };
+
+    /// @brief FrameReport — class/struct documentation.
+    struct FrameReport
+    {
+        uint64_t frame = 0;
+        double frameMs = 0.0;
+        std::vector<StageTime> stages;   // first call order
+        std::vector<float> history;      // frame ms, oldest first
+    };
+
+    namespace detail
+    {
+        extern std::atomic<bool> g_enabled;
+        inline thread_local uint32_t t_depth = 0;
+        void record(const char* name, uint64_t t0, uint64_t t1, uint32_t depth);
+        inline uint64_t now()
+        {
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+
+    inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool on);
+    // label of the calling thread in exports ("ui", "parser", ...)
+    void setThreadName(const char* name);
+
+    // UI thread: frame zone + per zone breakdown of the frame (report())
+    void beginFrame();
+    void endFrame();
+    const FrameReport& report();
+
+    // Every ring, oldest first, as a JSON trace (events with type, name, cat, ts, dur, tid).
+    bool exportTrace(const std::string& path, std::string* err = nullptr);
+
+    /// @brief Scope — class/struct documentation.
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name)
+            : _name(enabled() ? name : nullptr)
+        {
+            if (!_name) return;
+            _depth = detail::t_depth++;
+            _t0 = detail::now();
+        }
+        ~Scope()
+        {
+            if (!_name) return;
+            detail::record(_name, _t0, detail::now(), _depth);
+            --detail::t_depth;
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* _name;
+        uint64_t _t0 = 0;
+        uint32_t _depth = 0;
+    };
+}
+
+#define SELFPROF_CONCAT_(a, b) a##b
+#define SELFPROF_CONCAT(a, b) SELFPROF_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ::selfprof::Scope SELFPROF_CONCAT(selfprofScope_, __LINE__){ name }
@@ -0,0 +1,153 @@
+#include "shm_ring.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#endif
+
+bool ShmRingConsumer::open(const std::string& name, std::string* err)
+{
+    close();
+#ifdef _WIN32
+    (void)name;
+    if (err) *err = "Shared memory transport not available on this platform";
+    return false;
+#else
+    const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        // not on this host (or already gone)
+        if (err) *err = "No shared memory " + name;
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || size_t(st.st_size) < shm::kHeaderBytes)
+    {
+        ::close(fd);
+        if (err) *err = "Invalid shared memory " + name;
+        return false;
+    }
+    const size_t bytes = size_t(st.st_size);
+    void* map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+        if (err) *err = "Unable to map shared memory " + name;
+        return false;
+    }
+    auto* hdr = static_cast<shm::Header*>(map);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const bool valid = hdr->magic == shm::kMagic && hdr->version == shm::kVersion && hdr->capacity
+        && (hdr->capacity & (hdr->capacity - 1)) == 0 && shm::segmentBytes(hdr->capacity, hdr->heapBytes) <= bytes;
+    if (!valid)
+    {
+        ::munmap(map, bytes);
+        if (err) *err = "Incompatible shared memory ring " + name;
+        return false;
+    }
+    // single consumer: refuse a ring another live viewer is draining
+    const uint32_t me = uint32_t(::getpid());
+    uint32_t owner = hdr->consumerPid.load(std::memory_order_relaxed);
+    if (owner && owner != me && ::kill(pid_t(owner), 0) == 0)
+    {
+        ::munmap(map, bytes);
+        if (err) *err = "Shared memory ring already consumed by pid " + std::to_string(owner);
+        return false;
+    }
+    hdr->consumerPid.store(me, std::memory_order_relaxed);
+
+    _map = map;
+    _bytes = bytes;
+    _name = name;
+    _hdr = hdr;
+    _recs = shm::records(map);
+    _heap = shm::heap(map, hdr->capacity);
+    _mask = hdr->capacity - 1;
+    _tail = hdr->tail.load(std::memory_order_acquire);
+    _consumed = 0;
+    return true;
+#endif
+}
+
+void ShmRingConsumer::close()
+{
+#ifndef _WIN32
+    if (_map)
+    {
+        _hdr->consumerHeartbeatUs.store(0, std::memory_order_relaxed);
+        _hdr->consumerPid.store(0, std::memory_order_relaxed);
+        ::munmap(_map, _bytes);
+    }
+#endif
+    _map = nullptr;
+    _hdr = nullptr;
+    _recs = nullptr;
+    _heap = nullptr;
+}
+
+void ShmRingConsumer::heartbeat(uint64_t nowUs)
+{
+    if (_hdr)
+        _hdr->consumerHeartbeatUs.store(nowUs, std::memory_order_relaxed);
+}
+
+void ShmRingConsumer::str_(uint32_t ref, std::string& out) const
+{
+    out.clear();
+    if (ref == 0) return;
+    const uint32_t off = ref - 1;
+    if (size_t(off) + 2 > _hdr->heapBytes) return;
+    uint16_t len;
+    std::memcpy(&len, _heap + off, 2);
+    if (size_t(off) + 2 + len > _hdr->heapBytes) return;
+    out.assign(_heap + off + 2, len);
+}
+
+size_t ShmRingConsumer::drain(std::vector<Event>& events, std::vector<Metric>& metrics, uint16_t source, size_t maxRecords)
+{
+    if (!_hdr) return 0;
+    const uint64_t cap = _mask + 1;
+    size_t n = 0;
+    for (; n < maxRecords; ++n)
+    {
+        shm::Record& r = _recs[_tail & _mask];
+        if (r.seq.load(std::memory_order_acquire) != _tail + 1)
+            break;
+        if (r.type == shm::RecEvent)
+        {
+            Event& e = events.emplace_back();
+            str_(r.name, e.name);
+            str_(r.cat, e.category);
+            str_(r.color, e.color);
+            str_(r.data, e.data);
+            e.ts = r.ts;
+            e.dur = r.dur;
+            e.pid = r.pid;
+            e.tid = r.tid;
+            e.id = r.id;
+            e.source = source;
+        }
+        else if (r.type == shm::RecMetric)
+        {
+            float cpu, cpuTotal;
+            std::memcpy(&cpu, &r.name, 4);
+            std::memcpy(&cpuTotal, &r.cat, 4);
+            Metric m;
+            m.ts = r.ts;
+            m.cpu = cpu;
+            m.cpu_total = cpuTotal;
+            m.ram_used = r.dur;
+            m.ram_total = r.id;
+            metrics.push_back(m);
+        }
+        // hand the slot back to the producers
+        r.seq.store(_tail + cap, std::memory_order_release);
+        ++_tail;
+    }
+    if (n)
+    {
+        _hdr->tail.store(_tail, std::memory_order_relaxed);
+        _consumed += n;
+    }
+    return n;
+}
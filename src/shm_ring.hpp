@@ -0,0 +1,355 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "model.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// =============== Shared memory ring (same host) ===============
+// A producer on the viewer's host can publish a POSIX shared memory segment instead of
+// streaming datagrams; it is announced in the OFFER ("shm=/name"), the viewer maps it and
+// says so in its PINGs ("shm=1"), after which the producer stops sending data over UDP.
+//
+//   [0, 4096)            Header (control words on their own cache lines)
+//   [4096, +cap * 64)    Record slots, cap = power of two
+//   [.., +heapBytes)     String heap: u16 len | bytes, append only
+//
+// Multi producer / single consumer bounded queue (per slot sequence numbers): a producer
+// claims position p when slot[p & mask].seq == p (CAS on head), fills it and publishes
+// seq = p + 1; the consumer reads it and frees the slot with seq = p + cap. A full ring
+// never blocks a producer: the record is dropped and counted. No syscall on either side
+// once mapped.
+// Strings are interned by the producer into the heap and referenced by offset + 1
+// (0 = empty); the heap is bounded, so keep "data" low cardinality on this path.
+namespace shm
+{
+    inline constexpr uint32_t kMagic = 0x4D485354;   // "TSHM"
+    inline constexpr uint32_t kVersion = 1;
+    inline constexpr size_t   kHeaderBytes = 4096;
+    inline constexpr size_t   kRecordBytes = 64;
+    inline constexpr uint32_t kDefaultCapacity = 1u << 20;
+    inline constexpr uint32_t kDefaultHeap = 4u << 20;
+    // a producer only writes while the viewer heartbeat is fresher than this
+    inline constexpr uint64_t kConsumerTimeoutUs = 3'000'000;
+
+    enum RecordType : uint32_t { RecEvent = 1, RecMetric = 2 };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory atomics must be address free");
+
+    /// @brief Header — class/struct documentation.
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;      // records
+        uint32_t heapBytes;
+        uint32_t producerPid;
+        uint32_t session;
+        alignas(64) std::atomic<uint64_t> head;      // next position to claim (producers)
+        alignas(64) std::atomic<uint64_t> tail;      // next position to read (consumer)
+        std::atomic<uint64_t> consumerHeartbeatUs;   // viewer wall clock, 0 = detached
+        std::atomic<uint32_t> consumerPid;
+        alignas(64) std::atomic<uint64_t> dropped;   // records refused on a full ring
+        std::atomic<uint32_t> heapUsed;
+    };
+    static_assert(sizeof(Header) <= kHeaderBytes);
+
+    // Metric records reuse the event fields: dur = ram_used, id = ram_total,
+    // name / cat = cpu / cpu_total (float bits).
+    struct Record
+    {
+        std::atomic<uint64_t> seq;
+        uint32_t type;
+        uint32_t pid;
+        uint64_t ts;
+        uint64_t dur;
+        uint64_t id;
+        uint32_t name;
+        uint32_t cat;
+        uint32_t color;
+        uint32_t data;
+        uint32_t tid;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(Record) == kRecordBytes);
+
+    inline size_t segmentBytes(uint32_t capacity, uint32_t heapBytes)
+    {
+        return kHeaderBytes + size_t(capacity) * kRecordBytes + heapBytes;
+    }
+    inline Record* records(void* base) { return reinterpret_cast<Record*>(static_cast<char*>(base) + kHeaderBytes); }
+    inline char* heap(void* base, uint32_t capacity) { return static_cast<char*>(base) + kHeaderBytes + size_t(capacity) * kRecordBytes; }
+}
+
+// =============== Producer side ===============
+// create() once, then event() / metric() from any thread (lock-free); intern() takes a
+// mutex the first time a string is seen. create() fails (errno EEXIST) when the name is
+// taken by a live producer, and only replaces a segment whose producer pid is gone.
+class ShmRingProducer
+{
+public:
+    ShmRingProducer() = default;
+    ~ShmRingProducer() { close(); }
+    ShmRingProducer(const ShmRingProducer&) = delete;
+    ShmRingProducer& operator=(const ShmRingProducer&) = delete;
+
+    bool create(const std::string& name, uint32_t session, uint32_t capacity = shm::kDefaultCapacity,
+                uint32_t heapBytes = shm::kDefaultHeap, std::string* err = nullptr)
+    {
+        close();
+#ifdef _WIN32
+        (void)name; (void)session; (void)capacity; (void)heapBytes;
+        if (err) *err = "Shared memory transport not available on this platform";
+        return false;
+#else
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+        {
+            if (err) *err = "Ring capacity must be a power of two";
+            return false;
+        }
+        const size_t bytes = shm::segmentBytes(capacity, heapBytes);
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 && errno == EEXIST)
+        {
+            // left over by a producer that died: take it over, never a live one's
+            uint32_t owner = 0;
+            if (!staleSegment_(name, owner))
+            {
+                if (err)
+                    *err = owner ? "Shared memory " + name + " is in use by pid " + std::to_string(owner)
+                                 : "Shared memory " + name + " already exists (remove it if no producer owns it)";
+                errno = EEXIST;
+                return false;
+            }
+            ::shm_unlink(name.c_str());
+            fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        }
+        if (fd < 0 || ::ftruncate(fd, off_t(bytes)) != 0)
+        {
+            if (fd >= 0) { ::close(fd); ::shm_unlink(name.c_str()); }
+            if (err) *err = "Unable to create shared memory " + name;
+            return false;
+        }
+        void* map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED)
+        {
+            ::shm_unlink(name.c_str());
+            if (err) *err = "Unable to map shared memory " + name;
+            return false;
+        }
+        _map = map;
+        _bytes = bytes;
+        _name = name;
+        _hdr = static_cast<shm::Header*>(map);
+        _recs = shm::records(map);
+        _heap = shm::heap(map, capacity);
+        _mask = capacity - 1;
+
+        for (uint32_t i = 0; i < capacity; ++i)
+            _recs[i].seq.store(i, std::memory_order_relaxed);
+        _hdr->capacity = capacity;
+        _hdr->heapBytes = heapBytes;
+        _hdr->producerPid = uint32_t(::getpid());
+        _hdr->session = session;
+        _hdr->version = shm::kVersion;
+        // magic last: a consumer never sees a half initialized segment
+        std::atomic_thread_fence(std::memory_order_release);
+        _hdr->magic = shm::kMagic;
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (_map)
+        {
+            ::munmap(_map, _bytes);
+            ::shm_unlink(_name.c_str());
+        }
+#endif
+        _map = nullptr;
+        _hdr = nullptr;
+        _recs = nullptr;
+        _heap = nullptr;
+        _ids.clear();
+    }
+
+    bool open() const { return _map != nullptr; }
+    const std::string& name() const { return _name; }
+
+    // a viewer maps the ring and keeps its heartbeat fresh
+    bool consumerAttached(uint64_t nowUs) const
+    {
+        if (!_hdr) return false;
+        const uint64_t hb = _hdr->consumerHeartbeatUs.load(std::memory_order_relaxed);
+        return hb != 0 && nowUs < hb + shm::kConsumerTimeoutUs;
+    }
+    uint64_t dropped() const { return _hdr ? _hdr->dropped.load(std::memory_order_relaxed) : 0; }
+
+    // string -> heap reference (0 = empty, or heap full)
+    uint32_t intern(std::string_view s)
+    {
+        if (s.empty() || !_hdr) return 0;
+        std::lock_guard<std::mutex> lk(_mtx);
+        auto it = _ids.find(std::string(s));
+        if (it != _ids.end()) return it->second;
+        const size_t len = std::min<size_t>(s.size(), 0xFFFF);
+        const uint32_t used = _hdr->heapUsed.load(std::memory_order_relaxed);
+        if (used + 2 + len > _hdr->heapBytes) return 0;
+        const uint16_t l16 = uint16_t(len);
+        std::memcpy(_heap + used, &l16, 2);
+        std::memcpy(_heap + used + 2, s.data(), len);
+        // bytes are visible before any record referencing them (release on the record seq)
+        _hdr->heapUsed.store(used + 2 + uint32_t(len), std::memory_order_relaxed);
+        return _ids.emplace(std::string(s), used + 1).first->second;
+    }
+
+    bool event(uint32_t name, uint32_t cat, uint64_t ts, uint64_t dur, uint32_t data = 0, uint32_t color = 0,
+               uint32_t pid = 1, uint32_t tid = 0, uint64_t id = 0)
+    {
+        uint64_t pos;
+        shm::Record* r = claim_(pos);
+        if (!r) return false;
+        r->type = shm::RecEvent;
+        r->pid = pid;
+        r->ts = ts;
+        r->dur = dur;
+        r->id = id;
+        r->name = name;
+        r->cat = cat;
+        r->color = color;
+        r->data = data;
+        r->tid = tid;
+        publish_(r, pos);
+        return true;
+    }
+
+    bool metric(uint64_t ts, float cpu, float cpuTotal, uint64_t ramUsed, uint64_t ramTotal)
+    {
+        uint64_t pos;
+        shm::Record* r = claim_(pos);
+        if (!r) return false;
+        r->type = shm::RecMetric;
+        r->ts = ts;
+        r->dur = ramUsed;
+        r->id = ramTotal;
+        std::memcpy(&r->name, &cpu, 4);
+        std::memcpy(&r->cat, &cpuTotal, 4);
+        publish_(r, pos);
+        return true;
+    }
+
+private:
+#ifndef _WIN32
+    // true when the existing segment's producer is gone; owner = its pid (0 if unreadable)
+    static bool staleSegment_(const std::string& name, uint32_t& owner)
+    {
+        owner = 0;
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return errno == ENOENT;   // removed meanwhile
+        struct stat st{};
+        void* map = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(shm::Header))
+            map = ::mmap(nullptr, sizeof(shm::Header), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+        const shm::Header* h = static_cast<const shm::Header*>(map);
+        if (h->magic == shm::kMagic)
+            owner = h->producerPid;
+        ::munmap(map, sizeof(shm::Header));
+        // no magic yet: maybe being created right now, leave it alone
+        if (!owner) return false;
+        return owner != uint32_t(::getpid()) && ::kill(pid_t(owner), 0) != 0 && errno == ESRCH;
+    }
+#endif
+
+    shm::Record* claim_(uint64_t& pos)
+    {
+        if (!_hdr) return nullptr;
+        pos = _hdr->head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            shm::Record* r = &_recs[pos & _mask];
+            const uint64_t seq = r->seq.load(std::memory_order_acquire);
+            if (seq == pos)
+            {
+                if (_hdr->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return r;
+            }
+            else if (seq < pos)
+            {
+                // slot still holds an unread record: ring full
+                _hdr->dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            else
+                pos = _hdr->head.load(std::memory_order_relaxed);
+        }
+    }
+    static void publish_(shm::Record* r, uint64_t pos) { r->seq.store(pos + 1, std::memory_order_release); }
+
+private:
+    void* _map = nullptr;
+    size_t _bytes = 0;
+    std::string _name;
+    shm::Header* _hdr = nullptr;
+    shm::Record* _recs = nullptr;
+    char* _heap = nullptr;
+    uint64_t _mask = 0;
+    std::mutex _mtx;
+    std::unordered_map<std::string, uint32_t> _ids;
+};
+
+// =============== Consumer side (viewer) ===============
+class ShmRingConsumer
+{
+public:
+    ShmRingConsumer() = default;
+    ~ShmRingConsumer() { close(); }
+    ShmRingConsumer(const ShmRingConsumer&) = delete;
+    ShmRingConsumer& operator=(const ShmRingConsumer&) = delete;
+
+    // maps an existing segment and claims it (one viewer per ring)
+    bool open(const std::string& name, std::string* err = nullptr);
+    void close();
+    bool isOpen() const { return _map != nullptr; }
+    const std::string& name() const { return _name; }
+
+    // decodes up to maxRecords published records, events tagged with source
+    size_t drain(std::vector<Event>& events, std::vector<Metric>& metrics, uint16_t source, size_t maxRecords);
+    void heartbeat(uint64_t nowUs);
+
+    uint64_t consumed() const { return _consumed; }
+    uint64_t dropped() const { return _hdr ? _hdr->dropped.load(std::memory_order_relaxed) : 0; }
+
+private:
+    void str_(uint32_t ref, std::string& out) const;
+
+private:
+    void* _map = nullptr;
+    size_t _bytes = 0;
+    std::string _name;
+    shm::Header* _hdr = nullptr;
+    shm::Record* _recs = nullptr;
+    const char* _heap = nullptr;
+    uint64_t _mask = 0;
+    uint64_t _tail = 0;
+    uint64_t _consumed = 0;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// =============== SPSC ring ===============
+// Lock-free single producer / single consumer queue, fixed power of two capacity.
+// head/tail are free running counters on separate cache lines; each side keeps a
+// cached copy of the other index so the common path touches no shared line.
+template <class T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+        : _buf(std::bit_ceil(capacity < 2 ? size_t(2) : capacity))
+        , _mask(_buf.size() - 1)
+    {
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return _buf.size(); }
+
+    // producer side
+    bool try_push(const T& v)
+    {
+        const size_t t = _tail.load(std::memory_order_relaxed);
+        if (t - _headCache >= _buf.size())
+        {
+            _headCache = _head.load(std::memory_order_acquire);
+            if (t - _headCache >= _buf.size()) return false;
+        }
+        _buf[t & _mask] = v;
+        _tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    bool try_pop(T& out)
+    {
+        const size_t h = _head.load(std::memory_order_relaxed);
+        if (h == _tailCache)
+        {
+            _tailCache = _tail.load(std::memory_order_acquire);
+            if (h == _tailCache) return false;
+        }
+        out = _buf[h & _mask];
+        _head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximated (exact from either side when the other is idle)
+    size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t kLine = 64;
+
+    std::vector<T> _buf;
+    size_t _mask;
+    alignas(kLine) std::atomic<size_t> _head{ 0 };   // consumer
+    size_t _tailCache = 0;                           // consumer's view of _tail
+    alignas(kLine) std::atomic<size_t> _tail{ 0 };   // producer
+    size_t _headCache = 0;                           // producer's view of _head
+};
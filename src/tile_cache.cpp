@@ -0,0 +1,182 @@
+#include "tile_cache.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+
+TileCache::~TileCache()
+{
+    for (auto& t : _tiles)
+        release_(*t);
+}
+
+void TileCache::beginFrame()
+{
+    ++_frame;
+    _passes.clear();
+    _rendered = 0;
+}
+
+TileCache::Tile* TileCache::find(const Key& k)
+{
+    for (auto& t : _tiles)
+    {
+        if (t->valid && t->key == k)
+        {
+            t->lastUsed = _frame;
+            return t.get();
+        }
+    }
+    return nullptr;
+}
+
+TileCache::Tile* TileCache::acquire(const Key& k, const ImVec2& size)
+{
+    if (size.x <= 0.f || size.y <= 0.f || size.y > kMaxTileH)
+        return nullptr;
+
+    // a free slot, a new one while under budget, else the least recently used off screen
+    Tile* slot = nullptr;
+    for (auto& t : _tiles)
+        if (!t->valid) { slot = t.get(); break; }
+    if (!slot && _tiles.size() < kMaxTiles)
+        slot = _tiles.emplace_back(std::make_unique<Tile>()).get();
+    if (!slot)
+    {
+        for (auto& t : _tiles)
+            if (t->lastUsed < _frame && (!slot || t->lastUsed < slot->lastUsed))
+                slot = t.get();
+        if (!slot)
+            return nullptr;   // every tile is on screen
+    }
+
+    const ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+    const int w = std::max(1, int(std::ceil(size.x * scale.x)));
+    const int h = std::max(1, int(std::ceil(size.y * scale.y)));
+    if (!allocate_(*slot, w, h))
+        return nullptr;
+    slot->key = k;
+    slot->valid = true;
+    slot->size = size;
+    slot->lastUsed = _frame;
+    slot->groups.clear();
+    ++_rendered;
+    return slot;
+}
+
+void TileCache::invalidate()
+{
+    for (auto& t : _tiles)
+    {
+        t->valid = false;
+        t->groups.clear();
+    }
+}
+
+bool TileCache::allocate_(Tile& t, int w, int h)
+{
+    if (t.tex && t.texW == w && t.texH == h)
+        return true;
+    if (!t.tex)
+    {
+        glGenTextures(1, &t.tex);
+        glGenFramebuffers(1, &t.fbo);
+    }
+    GLint prevTex = 0, prevFbo = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTex);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+
+    glBindTexture(GL_TEXTURE_2D, t.tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindFramebuffer(GL_FRAMEBUFFER, t.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, t.tex, 0);
+    const bool ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, GLuint(prevFbo));
+    glBindTexture(GL_TEXTURE_2D, GLuint(prevTex));
+    if (!ok)
+    {
+        release_(t);
+        return false;
+    }
+    t.texW = w;
+    t.texH = h;
+    return true;
+}
+
+void TileCache::release_(Tile& t)
+{
+    if (t.fbo) glDeleteFramebuffers(1, &t.fbo);
+    if (t.tex) glDeleteTextures(1, &t.tex);
+    t.fbo = t.tex = 0;
+    t.texW = t.texH = 0;
+    t.valid = false;
+}
+
+// ---------- Draw list redirection ----------
+void TileCache::beginRender(ImDrawList* dl, Tile& t, const ImVec2& origin)
+{
+    _passes.push_back({ this, &t, origin });
+    dl->AddCallback(&TileCache::renderBegin, &_passes.back());
+    // no CPU side culling of text outside the window clip rect
+    dl->PushClipRect(origin, ImVec2(origin.x + t.size.x, origin.y + t.size.y), false);
+}
+
+void TileCache::endRender(ImDrawList* dl)
+{
+    dl->PopClipRect();
+    dl->AddCallback(&TileCache::renderEnd, this);
+    dl->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void TileCache::beginComposite(ImDrawList* dl)
+{
+    dl->AddCallback(&TileCache::compositeBegin, nullptr);
+}
+
+void TileCache::endComposite(ImDrawList* dl)
+{
+    dl->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void TileCache::renderBegin(const ImDrawList*, const ImDrawCmd* cmd)
+{
+    const Pass& p = *static_cast<const Pass*>(cmd->UserCallbackData);
+    const Tile& t = *p.tile;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &p.owner->_prevFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, t.fbo);
+    glViewport(0, 0, t.texW, t.texH);
+    // the backend scissors in window framebuffer space: the tile bounds clip instead
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // same orthographic projection as the backend, over the tile rect
+    const float L = p.origin.x, R = p.origin.x + t.size.x;
+    const float T = p.origin.y, B = p.origin.y + t.size.y;
+    const float ortho[4][4] = {
+        { 2.0f / (R - L), 0.0f, 0.0f, 0.0f },
+        { 0.0f, 2.0f / (T - B), 0.0f, 0.0f },
+        { 0.0f, 0.0f, -1.0f, 0.0f },
+        { (R + L) / (L - R), (T + B) / (B - T), 0.0f, 1.0f },
+    };
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glUniformMatrix4fv(glGetUniformLocation(GLuint(program), "ProjMtx"), 1, GL_FALSE, &ortho[0][0]);
+}
+
+void TileCache::renderEnd(const ImDrawList*, const ImDrawCmd* cmd)
+{
+    const TileCache* self = static_cast<const TileCache*>(cmd->UserCallbackData);
+    glBindFramebuffer(GL_FRAMEBUFFER, GLuint(self->_prevFbo));
+}
+
+void TileCache::compositeBegin(const ImDrawList*, const ImDrawCmd*)
+{
+    glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <imgui.h>
+
+#include "model.hpp"
+
+// =============== Timeline tile cache ===============
+// The lane area of a category block is rasterized into time aligned offscreen tiles
+// (FBO textures, kTileW px wide at the current scale). While panning, the cached tiles are
+// composited with AddImage and only the tiles scrolling in are rendered.
+// Rendering reuses the ImGui draw list: commands added between beginRender() / endRender()
+// are redirected into the tile FBO by draw callbacks (projection set to the tile rect),
+// so the regular drawing helpers work unchanged. Tiles hold premultiplied colors.
+// Keys carry everything the pixels depend on; stale tiles are recycled (LRU).
+
+/// @brief LaneGroup — class/struct documentation.
+struct LaneGroup
+{
+    float x1 = 0.f;
+    float x2 = 0.f;
+    int lane = 0;                 // packed (visible) lane index in the block
+    std::vector<Event*> ev;
+};
+
+class TileCache
+{
+public:
+    static constexpr float  kTileW = 512.f;
+    static constexpr float  kMaxTileH = 4096.f;
+    static constexpr size_t kMaxTiles = 96;
+
+    /// @brief Key — class/struct documentation.
+    struct Key
+    {
+        uint64_t block = 0;       // block name + lane layout
+        int64_t  index = 0;       // tile index along the time axis
+        uint64_t scale = 0;       // px per us (bits)
+        uint64_t gen = 0;         // content generation (data, filter, brush)
+        bool operator==(const Key& o) const { return block == o.block && index == o.index && scale == o.scale && gen == o.gen; }
+    };
+
+    /// @brief Tile — class/struct documentation.
+    struct Tile
+    {
+        Key key;
+        bool valid = false;
+        uint32_t tex = 0;
+        uint32_t fbo = 0;
+        int texW = 0;
+        int texH = 0;
+        ImVec2 size;              // logical px
+        uint64_t lastUsed = 0;
+        std::vector<LaneGroup> groups;   // x relative to the tile origin (hit testing)
+    };
+
+    TileCache() = default;
+    TileCache(const TileCache&) = delete;
+    TileCache& operator=(const TileCache&) = delete;
+    // GL objects are released here: destroy while the context is current
+    ~TileCache();
+
+    void beginFrame();
+    // Cached tile for k (marked used this frame), nullptr on a miss.
+    Tile* find(const Key& k);
+    // Tile to render k into: a free slot or the least recently used one not used this frame.
+    Tile* acquire(const Key& k, const ImVec2& size);
+    // Drops every key (data changed); textures are kept for reuse.
+    void invalidate();
+
+    // Commands added to dl in between are drawn into t, origin = screen position of its top left.
+    void beginRender(ImDrawList* dl, Tile& t, const ImVec2& origin);
+    void endRender(ImDrawList* dl);
+    // AddImage of tiles in between blend as premultiplied.
+    void beginComposite(ImDrawList* dl);
+    void endComposite(ImDrawList* dl);
+    static ImTextureID textureId(const Tile& t) { return (ImTextureID)(intptr_t)t.tex; }
+
+    size_t rendered() const { return _rendered; }
+    size_t size() const { return _tiles.size(); }
+
+private:
+    /// @brief Pass — class/struct documentation.
+    struct Pass
+    {
+        TileCache* owner;
+        Tile* tile;
+        ImVec2 origin;
+    };
+
+    static void renderBegin(const ImDrawList* dl, const ImDrawCmd* cmd);
+    static void renderEnd(const ImDrawList* dl, const ImDrawCmd* cmd);
+    static void compositeBegin(const ImDrawList* dl, const ImDrawCmd* cmd);
+    bool allocate_(Tile& t, int w, int h);
+    void release_(Tile& t);
+
+private:
+    std::vector<std::unique_ptr<Tile>> _tiles;   // stable addresses (callback user data)
+    std::deque<Pass> _passes;
+    uint64_t _frame = 0;
+    size_t _rendered = 0;
+    int _prevFbo = 0;
+};
@@ -0,0 +1,449 @@
+#include "trace_stream.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "parser.hpp"
+#include "wire_binary.hpp"
+
+namespace trace_stream
+{
+    namespace
+    {
+        std::string lower_extension(const std::string& path)
+        {
+            const size_t dot = path.find_last_of('.');
+            const size_t slash = path.find_last_of("/\\");
+            if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+                return {};
+            std::string ext = path.substr(dot);
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+            return ext;
+        }
+
+        // =============== JSON reader ===============
+        // parse_trace_stream is push based: it runs on a worker and hands batches over
+        // through a small bounded queue, so several inputs can be pulled side by side (merge).
+        class JsonReader final : public Reader
+        {
+        public:
+            static constexpr size_t kBatch = 4096;
+            static constexpr size_t kMaxQueued = 4;
+
+            explicit JsonReader(std::unique_ptr<std::ifstream> in) : _in(std::move(in))
+            {
+                _worker = std::thread([this] { run_(); });
+            }
+
+            ~JsonReader() override
+            {
+                {
+                    std::lock_guard<std::mutex> lk(_mutex);
+                    _cancel = true;
+                }
+                _cv.notify_all();
+                if (_worker.joinable())
+                    _worker.join();
+            }
+
+            size_t read(std::vector<Record>& out, size_t max) override
+            {
+                size_t n = 0;
+                while (n < max)
+                {
+                    if (_current.empty() || _pos == _current.size())
+                    {
+                        std::unique_lock<std::mutex> lk(_mutex);
+                        _cv.wait(lk, [this] { return !_queue.empty() || _done; });
+                        if (_queue.empty())
+                        {
+                            _error = _parseError;
+                            break;
+                        }
+                        _current = std::move(_queue.front());
+                        _queue.pop_front();
+                        _pos = 0;
+                        lk.unlock();
+                        _cv.notify_all();
+                    }
+                    const size_t take = std::min(max - n, _current.size() - _pos);
+                    for (size_t i = 0; i < take; ++i)
+                        out.push_back(std::move(_current[_pos + i]));
+                    _pos += take;
+                    n += take;
+                }
+                return n;
+            }
+
+        private:
+            /// @brief Cancelled — class/struct documentation.
+            struct Cancelled : std::exception
+            {
+                const char* what() const noexcept override { return "cancelled"; }
+            };
+
+            void push_(Record&& r)
+            {
+                _batch.push_back(std::move(r));
+                if (_batch.size() >= kBatch)
+                    flush_();
+            }
+
+            void flush_()
+            {
+                std::unique_lock<std::mutex> lk(_mutex);
+                _cv.wait(lk, [this] { return _queue.size() < kMaxQueued || _cancel; });
+                if (_cancel)
+                    throw Cancelled{};
+                _queue.push_back(std::move(_batch));
+                _batch = {};
+                _batch.reserve(kBatch);
+                lk.unlock();
+                _cv.notify_all();
+            }
+
+            void run_()
+            {
+                _batch.reserve(kBatch);
+                std::string err;
+                bool ok = false;
+                try
+                {
+                    ok = parse_trace_stream(*_in,
+                        [this](Event&& e) { Record r; r.event = std::move(e); push_(std::move(r)); },
+                        [this](const Metric& m) { Record r; r.isMetric = true; r.metric = m; push_(std::move(r)); },
+                        0, &err);
+                    if (ok && !_batch.empty())
+                        flush_();
+                }
+                catch (const Cancelled&)
+                {
+                }
+                std::lock_guard<std::mutex> lk(_mutex);
+                if (!ok && !_cancel)
+                    _parseError = err.empty() ? std::string("JSON parse error") : err;
+                _done = true;
+                _cv.notify_all();
+            }
+
+        private:
+            std::unique_ptr<std::ifstream> _in;
+            std::thread _worker;
+            std::mutex _mutex;
+            std::condition_variable _cv;
+            std::deque<std::vector<Record>> _queue;
+            std::vector<Record> _batch;       // worker side
+            std::vector<Record> _current;     // reader side
+            size_t _pos = 0;
+            std::string _parseError;
+            bool _done = false;
+            bool _cancel = false;
+        };
+
+        // =============== Binary reader ===============
+        class BinaryReader final : public Reader
+        {
+        public:
+            explicit BinaryReader(std::unique_ptr<std::ifstream> in) : _in(std::move(in)) {}
+
+            size_t read(std::vector<Record>& out, size_t max) override
+            {
+                size_t n = 0;
+                while (n < max)
+                {
+                    if (_pos == _records.size() && !nextBlock_())
+                        break;
+                    const size_t take = std::min(max - n, _records.size() - _pos);
+                    for (size_t i = 0; i < take; ++i)
+                        out.push_back(std::move(_records[_pos + i]));
+                    _pos += take;
+                    n += take;
+                }
+                return n;
+            }
+
+        private:
+            bool nextBlock_()
+            {
+                _records.clear();
+                _pos = 0;
+                while (_records.empty())
+                {
+                    uint32_t len = 0;
+                    if (!_in->read(reinterpret_cast<char*>(&len), 4))
+                        return false;  // clean end of file
+                    if (len < wire::kHeaderBytes || len > kMaxBlockBytes)
+                    {
+                        _error = "Corrupted block";
+                        return false;
+                    }
+                    _block.resize(len);
+                    if (!_in->read(_block.data(), std::streamsize(len)))
+                    {
+                        _error = "Truncated block";
+                        return false;
+                    }
+                    if (!wire::isBinary(_block))
+                    {
+                        _error = "Corrupted block";
+                        return false;
+                    }
+                    // a new session restarts the string table
+                    uint32_t session;
+                    std::memcpy(&session, _block.data() + 4, 4);
+                    if (session != _session)
+                    {
+                        _decoder = wire::Decoder{};
+                        _session = session;
+                    }
+                    std::string err;
+                    const bool ok = _decoder.decodeEach(_block,
+                        [this](Event&& e) { Record& r = _records.emplace_back(); r.event = std::move(e); },
+                        [this](const Metric& m) { Record& r = _records.emplace_back(); r.isMetric = true; r.metric = m; },
+                        [](const std::string&, const EventStats&) {},   // like the JSON reader
+                        &err);
+                    if (!ok)
+                    {
+                        _error = err;
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+        private:
+            std::unique_ptr<std::ifstream> _in;
+            wire::Decoder _decoder;
+            uint32_t _session = UINT32_MAX;
+            std::string _block;
+            std::vector<Record> _records;
+            size_t _pos = 0;
+        };
+
+        // =============== JSON writer ===============
+        class JsonWriter final : public Writer
+        {
+        public:
+            static constexpr size_t kFlushBytes = 1 << 20;
+
+            explicit JsonWriter(std::unique_ptr<std::ofstream> out) : _out(std::move(out))
+            {
+                _buf.reserve(kFlushBytes + 4096);
+                _buf += "[\n";
+            }
+
+            bool write(const Record& r) override
+            {
+                if (!_first) _buf += ",\n";
+                _first = false;
+                if (r.isMetric)
+                {
+                    const Metric& m = r.metric;
+                    _buf += "{\"type\":\"metric\",\"ts\":";
+                    num_(m.ts);
+                    _buf += ",\"cpu\":";
+                    num_(m.cpu);
+                    _buf += ",\"cpu_total\":";
+                    num_(m.cpu_total);
+                    _buf += ",\"ram_used\":";
+                    num_(m.ram_used);
+                    _buf += ",\"ram_total\":";
+                    num_(m.ram_total);
+                    _buf += '}';
+                }
+                else
+                {
+                    const Event& e = r.event;
+                    _buf += "{\"type\":\"event\",\"name\":";
+                    str_(e.name);
+                    _buf += ",\"cat\":";
+                    str_(e.category);
+                    _buf += ",\"ts\":";
+                    num_(e.ts);
+                    _buf += ",\"dur\":";
+                    num_(e.dur);
+                    _buf += ",\"pid\":";
+                    num_(e.pid);
+                    _buf += ",\"tid\":";
+                    num_(e.tid);
+                    if (e.id) { _buf += ",\"id\":"; num_(e.id); }
+                    if (!e.color.empty()) { _buf += ",\"color\":"; str_(e.color); }
+                    if (!e.data.empty()) { _buf += ",\"data\":"; str_(e.data); }
+                    _buf += '}';
+                }
+                return _buf.size() < kFlushBytes || flush_();
+            }
+
+            bool finish() override
+            {
+                _buf += "\n]\n";
+                if (!flush_()) return false;
+                _out->flush();
+                return bool(*_out);
+            }
+
+        private:
+            bool flush_()
+            {
+                _out->write(_buf.data(), std::streamsize(_buf.size()));
+                _buf.clear();
+                return bool(*_out);
+            }
+
+            template <class T>
+            void num_(T v)
+            {
+                char tmp[32];
+                const auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+                _buf.append(tmp, res.ptr);
+            }
+
+            void str_(const std::string& s)
+            {
+                static constexpr char kHex[] = "0123456789abcdef";
+                _buf += '"';
+                for (const char ch : s)
+                {
+                    const unsigned char c = (unsigned char)ch;
+                    switch (c)
+                    {
+                    case '"':  _buf += "\\\""; break;
+                    case '\\': _buf += "\\\\"; break;
+                    case '\n': _buf += "\\n"; break;
+                    case '\r': _buf += "\\r"; break;
+                    case '\t': _buf += "\\t"; break;
+                    default:
+                        if (c < 0x20) { _buf += "\\u00"; _buf += kHex[c >> 4]; _buf += kHex[c & 15]; }
+                        else _buf += ch;
+                    }
+                }
+                _buf += '"';
+            }
+
+        private:
+            std::unique_ptr<std::ofstream> _out;
+            std::string _buf;
+            bool _first = true;
+        };
+
+        // =============== Binary writer ===============
+        class BinaryWriter final : public Writer
+        {
+        public:
+            explicit BinaryWriter(std::unique_ptr<std::ofstream> out) : _out(std::move(out))
+            {
+                _out->write(kMagic, 4);
+                _out->write(reinterpret_cast<const char*>(&kVersion), 4);
+                _enc.begin();
+            }
+
+            bool write(const Record& r) override
+            {
+                if (r.isMetric)
+                {
+                    const Metric& m = r.metric;
+                    _enc.metric(m.ts, float(m.cpu), float(m.cpu_total), m.ram_used, m.ram_total);
+                }
+                else
+                {
+                    const Event& e = r.event;
+                    _enc.event(e.name, e.category, e.ts, e.dur, e.data, e.color, e.pid, e.tid, e.id);
+                }
+                _pending = true;
+                // a record the reader would reject
+                if (_enc.size() > kMaxBlockBytes) return false;
+                return _enc.size() < kBlockBytes || flushBlock_();
+            }
+
+            bool finish() override
+            {
+                if (_pending && !flushBlock_()) return false;
+                _out->flush();
+                return bool(*_out);
+            }
+
+        private:
+            bool flushBlock_()
+            {
+                const std::string& msg = _enc.finish();
+                const uint32_t len = uint32_t(msg.size());
+                _out->write(reinterpret_cast<const char*>(&len), 4);
+                _out->write(msg.data(), std::streamsize(msg.size()));
+                _pending = false;
+                if (++_blocks % kBlocksPerSession == 0)
+                    _enc = wire::Encoder(++_session);
+                _enc.begin();
+                return bool(*_out);
+            }
+
+        private:
+            std::unique_ptr<std::ofstream> _out;
+            uint32_t _session = 0;
+            wire::Encoder _enc{ 0 };
+            uint64_t _blocks = 0;
+            bool _pending = false;
+        };
+    }
+
+    bool detect_format(const std::string& path, Format& out)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        char magic[4] = {};
+        in.read(magic, 4);
+        out = (in.gcount() == 4 && std::memcmp(magic, kMagic, 4) == 0) ? Format::Binary : Format::Json;
+        return true;
+    }
+
+    bool format_from_extension(const std::string& path, Format& out)
+    {
+        const std::string ext = lower_extension(path);
+        if (ext == ".json") { out = Format::Json; return true; }
+        if (ext == ".trcb" || ext == ".bin") { out = Format::Binary; return true; }
+        return false;
+    }
+
+    std::unique_ptr<Reader> open_reader(const std::string& path, std::string* err)
+    {
+        Format fmt;
+        if (!detect_format(path, fmt))
+        {
+            if (err) *err = "Cannot open " + path;
+            return nullptr;
+        }
+        auto in = std::make_unique<std::ifstream>(path, std::ios::binary);
+        if (fmt == Format::Json)
+            return std::make_unique<JsonReader>(std::move(in));
+
+        char magic[4];
+        uint32_t version = 0;
+        in->read(magic, 4);
+        in->read(reinterpret_cast<char*>(&version), 4);
+        if (!*in || version != kVersion)
+        {
+            if (err) *err = "Unsupported binary trace version in " + path;
+            return nullptr;
+        }
+        return std::make_unique<BinaryReader>(std::move(in));
+    }
+
+    std::unique_ptr<Writer> open_writer(const std::string& path, Format format, std::string* err)
+    {
+        auto out = std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc);
+        if (!*out)
+        {
+            if (err) *err = "Cannot create " + path;
+            return nullptr;
+        }
+        if (format == Format::Json)
+            return std::make_unique<JsonWriter>(std::move(out));
+        return std::make_unique<BinaryWriter>(std::move(out));
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model.hpp"
+
+// =============== Trace streams ===============
+// Record at a time readers / writers (trace_tool): memory stays bounded whatever the
+// size of the trace.
+//   JSON   : read: every layout parse_trace_payload accepts ("stats" are skipped)
+//            written: mixed array ({"type":"event"|"metric",...} elements)
+//   binary : container of bin1 messages (wire_binary.hpp)
+//            "TRCB" | u32 version | blocks...     block = u32 len | bin1 message
+// The binary writer restarts its string table (new session) every kBlocksPerSession
+// blocks, so neither side keeps an intern table proportional to the file. A block is
+// at most kMaxBlockBytes (a larger length is a corrupted file).
+// bin1 metrics carry cpu / cpu_total as f32: JSON -> binary is lossy for those two
+// fields (12.345678 comes back as 12.345678329467773), everything else round trips.
+namespace trace_stream
+{
+    inline constexpr char     kMagic[4] = { 'T', 'R', 'C', 'B' };
+    inline constexpr uint32_t kVersion = 1;
+    inline constexpr size_t   kBlockBytes = 256 * 1024;
+    inline constexpr size_t   kMaxBlockBytes = 64 * kBlockBytes;   // one oversized record at most
+    inline constexpr uint32_t kBlocksPerSession = 64;
+
+    enum class Format { Json, Binary };
+
+    /// @brief Record — class/struct documentation.
+    struct Record
+    {
+        bool isMetric = false;
+        Event event;
+        Metric metric;
+
+        uint64_t ts() const { return isMetric ? metric.ts : event.ts; }
+    };
+
+    // Sniffs the magic; false if the file cannot be opened.
+    bool detect_format(const std::string& path, Format& out);
+    // ".json" -> Json, ".trcb" / ".bin" -> Binary; false otherwise.
+    bool format_from_extension(const std::string& path, Format& out);
+
+    class Reader
+    {
+    public:
+        virtual ~Reader() = default;
+        // Appends up to max records to out; returns how many (0 = end of input or error).
+        virtual size_t read(std::vector<Record>& out, size_t max) = 0;
+        // Set once read() returned 0 because of a malformed input.
+        const std::string& error() const { return _error; }
+
+    protected:
+        std::string _error;
+    };
+
+    class Writer
+    {
+    public:
+        virtual ~Writer() = default;
+        virtual bool write(const Record& r) = 0;
+        // Writes the trailer and flushes; the writer is unusable afterwards.
+        virtual bool finish() = 0;
+    };
+
+    // The JSON reader parses on its own thread, a few batches ahead of read().
+    std::unique_ptr<Reader> open_reader(const std::string& path, std::string* err = nullptr);
+    std::unique_ptr<Writer> open_writer(const std::string& path, Format format, std::string* err = nullptr);
+}
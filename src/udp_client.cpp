@@ -1,9 +1,16 @@
 #include "udp_client.hpp"
+#include "self_profile.hpp"
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <array>
+
+#if defined(__linux__)
+#include <sys/uio.h>
+#endif
 
 // =====  =====
 std::uint64_t UdpClient::now_ms_()
@@ -84,19 +91,14 @@ std::string UdpClient::get_ip_from_sockaddr_(const sockaddr_in & a)
 
 // ===== Ctor / Dtor =====
 UdpClient::UdpClient(std::uint16_t start_port, std::uint16_t end_port, std::uint64_t keepalive_ms)
-    : _rtt_sum_ms{ 0 }
-    , s_{ }
+    : s_{ }
     , start_port_(start_port)
     , end_port_(end_port)
     , last_probe_ms_{ 0 }
     , current_port_{ start_port }
     , _servers{ }
-    , _readed{ false }
-    , srv_addr_{ }
+    , _readed{ }
     , keepalive_ms_(keepalive_ms)
-    , next_ping_ms_{ 0 }
-    , last_pong_ms_{ 0 }
-    , seq_{ 0 }
 {
     net_init_();
     s_ = make_udp_(/*broadcast*/true, /*reuse*/true);
@@ -109,10 +111,27 @@ UdpClient::UdpClient(std::uint16_t start_port, std::uint16_t end_port, std::uint
         std::perror("bind(client)");
         std::exit(1);
     }
+    // bursts are absorbed by the kernel while the UI is busy (capped by rmem_max on Linux)
+    int rcvbuf = kRxSocketBuffer;
+    if (setsockopt(s_, SOL_SOCKET, SO_RCVBUF, (char*)&rcvbuf, sizeof(rcvbuf)) < 0)
+        std::perror("setsockopt(SO_RCVBUF)");
+#ifdef SO_RXQ_OVFL
+    int ovfl = 1;
+    setsockopt(s_, SOL_SOCKET, SO_RXQ_OVFL, (char*)&ovfl, sizeof(ovfl));
+#endif
     last_probe_ms_ = now_ms_();
+
+    rx_slab_.resize(kRxSlots * kRxSlotBytes);
+    for (std::uint32_t i = 0; i < kRxSlots; ++i)
+        rx_free_.try_push(i);
+    rx_run_ = true;
+    rx_thread_ = std::thread([this] { rx_loop_(); });
 }
 
 UdpClient::~UdpClient() {
+    rx_run_ = false;
+    if (rx_thread_.joinable())
+        rx_thread_.join();
 #ifdef _WIN32
     if (s_ != INVALID_SOCKET) closesocket(s_);
 #else
@@ -123,14 +142,101 @@ UdpClient::~UdpClient() {
 
 std::string UdpClient::server_endpoint() const
 {
-    return connected_ ? get_ip_from_sockaddr_(srv_addr_) + ":" + std::to_string(srv_port_) : std::string{};
+    if (sessions_.empty())
+        return {};
+    if (sessions_.size() > 1)
+        return std::to_string(sessions_.size()) + " servers";
+    return sessions_[0].info.ip + ":" + std::to_string(sessions_[0].info.port);
+}
+
+bool UdpClient::connected() const
+{
+    for (const Session& s : sessions_)
+        if (s.alive) return true;
+    return false;
+}
+
+const char* UdpClient::protocol() const
+{
+    std::size_t bin = 0, alive = 0;
+    for (const Session& s : sessions_)
+    {
+        if (!s.alive) continue;
+        ++alive;
+        bin += s.binary ? 1 : 0;
+    }
+    return bin == 0 ? "json" : bin == alive ? "bin1" : "mixed";
+}
+
+bool UdpClient::shm_active() const
+{
+    return std::any_of(sessions_.begin(), sessions_.end(), [](const Session& s) { return s.ring != nullptr; });
+}
+
+std::vector<LiveSessionInfo> UdpClient::sessions() const
+{
+    std::vector<LiveSessionInfo> out;
+    out.reserve(sessions_.size());
+    for (const Session& s : sessions_)
+    {
+        LiveSessionInfo i;
+        i.source = s.source;
+        i.server = s.info;
+        i.connected = s.alive;
+        i.protocol = s.binary ? "bin1" : "json";
+        i.latency_ms = s.rtt_ms.empty() ? 0 : std::uint32_t(s.rtt_sum_ms / s.rtt_ms.size());
+        i.clock_synced = s.clock.valid();
+        i.clock_offset_us = s.clock.offsetUs();
+        i.clock_drift_ppm = s.clock.driftPpm();
+        i.clock_delay_us = s.clock.minDelayUs();
+        i.shm = s.ring != nullptr;
+        i.shm_records = s.ring ? s.ring->consumed() : 0;
+        i.shm_dropped = s.ring ? s.ring->dropped() : 0;
+        out.push_back(std::move(i));
+    }
+    return out;
+}
+
+std::string UdpClient::source_name(std::uint16_t source) const
+{
+    for (const Session& s : sessions_)
+        if (s.source == source) return s.info.name;
+    return {};
+}
+
+std::size_t UdpClient::drain_shm(std::vector<std::vector<Event>>& runs, std::vector<Metric>& metrics, const OnShmDrained& onDrained)
+{
+    std::size_t n = 0;
+    const std::uint64_t t = clock_now_us();
+    for (Session& s : sessions_)
+    {
+        if (!s.ring) continue;
+        s.ring->heartbeat(t);
+        if (s.source >= runs.size())
+            runs.resize(std::size_t(s.source) + 1);
+        const std::size_t first = runs[s.source].size();
+        const std::size_t firstM = metrics.size();
+        const std::size_t got = s.ring->drain(runs[s.source], metrics, s.source, kShmDrainMax);
+        n += got;
+        if (got && onDrained)
+            onDrained(s.source, first, firstM);
+    }
+    return n;
+}
+
+const ClockSync* UdpClient::clock(std::uint16_t source) const
+{
+    for (const Session& s : sessions_)
+        if (s.source == source) return s.clock.valid() ? &s.clock : nullptr;
+    return nullptr;
 }
 
 // ===== Découverte =====
+// keeps probing while connected, so more servers can join the live set
 std::vector<ServerInfo> UdpClient::scan()
 {
     const auto t = now_ms_();
-    if (!connected_ && (t - last_probe_ms_) > 5000)
+    if ((t - last_probe_ms_) > 5000)
     {
         for (std::uint16_t p = start_port_; p <= end_port_; ++p)
             probe_once_(p);
@@ -201,7 +307,37 @@ std::string UdpClient::parse_offer_name_(std::string_view offer)
     return std::string(sv);
 }
 
-void UdpClient::start_session(const ServerInfo& s)
+bool UdpClient::parse_stamp_(std::string_view msg, std::string_view key, std::uint64_t& out)
+{
+    auto i = msg.find(key);
+    if (i == std::string_view::npos)
+        return false;
+    i += key.size();
+    auto res = std::from_chars(msg.data() + i, msg.data() + msg.size(), out, 10);
+    return res.ec == std::errc{};
+}
+
+std::string UdpClient::parse_offer_proto_(std::string_view offer)
+{
+    auto i = offer.find("proto=");
+    if (i == std::string_view::npos)
+        return {};
+    i += 6;
+    auto j = offer.find_first_of(" \t\r\n", i);
+    return std::string(offer.substr(i, (j == std::string_view::npos ? offer.size() - i : j - i)));
+}
+
+std::string UdpClient::parse_offer_shm_(std::string_view offer)
+{
+    auto i = offer.find("shm=");
+    if (i == std::string_view::npos)
+        return {};
+    i += 4;
+    auto j = offer.find_first_of(" \t\r\n", i);
+    return std::string(offer.substr(i, (j == std::string_view::npos ? offer.size() - i : j - i)));
+}
+
+std::uint16_t UdpClient::start_session(const ServerInfo& s)
 {
     sockaddr_in b{};
     b.sin_family = AF_INET;
@@ -209,177 +345,443 @@ void UdpClient::start_session(const ServerInfo& s)
 
 #ifdef _WIN32
     // nécessite <ws2tcpip.h>
-    if (InetPtonA(AF_INET, s.ip.c_str(), &b.sin_addr) != 1) {
-        // IP invalide
-        connected_ = false;
-        return;
-    }
+    if (InetPtonA(AF_INET, s.ip.c_str(), &b.sin_addr) != 1)
+        return 0; // IP invalide
 #else
-    if (inet_pton(AF_INET, s.ip.c_str(), &b.sin_addr) != 1) {
-        // IP invalide
-        connected_ = false;
-        return;
-    }
+    if (inet_pton(AF_INET, s.ip.c_str(), &b.sin_addr) != 1)
+        return 0; // IP invalide
 #endif
-    connected_ = true;
-    srv_addr_ = b;
-    srv_port_ = s.port;
-
-    last_pong_ms_ = now_ms_();
-    next_ping_ms_ = last_pong_ms_;
-    seq_ = 0;
+    // same endpoint again: revive it under its source id (lanes stay the same)
+    Session* ses = nullptr;
+    for (Session& o : sessions_)
+        if (o.addr.sin_addr.s_addr == b.sin_addr.s_addr && o.addr.sin_port == b.sin_port)
+            ses = &o;
+    if (!ses)
+    {
+        if (next_source_ == 0xFFFF)
+            return 0;
+        ses = &sessions_.emplace_back();
+        ses->source = next_source_++;
+    }
+    ses->info = s;
+    ses->addr = b;
+    ses->alive = true;
+    ses->last_pong_ms = now_ms_();
+    ses->next_ping_ms = ses->last_pong_ms;
+    ses->seq = 0;
+    ses->sync_seq = 0;
+    ses->want_binary = s.proto.find(wire::kProtoTag) != std::string::npos;
+    ses->binary = false;
+    ses->has_frame_session = false;
+    ses->ping_sent_us.clear();
+    ses->clock.reset();
+    ses->rtt_ms.clear();
+    ses->rtt_sum_ms = 0;
+    // the ring only opens on the producer's host; otherwise data keeps coming over UDP
+    ses->ring.reset();
+    if (!s.shm.empty())
+    {
+        ses->ring = std::make_unique<ShmRingConsumer>();
+        std::string err;
+        if (!ses->ring->open(s.shm, &err))
+            ses->ring.reset();
+    }
+    return ses->source;
+}
 
-    _ping_sent_ms.clear();
-    _rtt_ms.clear();
-    _rtt_sum_ms = 0;
+void UdpClient::stop_session(std::uint16_t source)
+{
+    std::erase_if(sessions_, [source](const Session& s) { return s.source == source; });
+    last_hit_ = 0;
 }
 
 void UdpClient::stop_session()
 {
-    connected_ = false;
+    sessions_.clear();
+    last_hit_ = 0;
+    next_source_ = 1;
+    framer_.reset();
     _servers.clear();
-
-    _ping_sent_ms.clear();
-    _rtt_ms.clear();
-    _rtt_sum_ms = 0;
 }
 
 // ===== Session =====
 void UdpClient::send_ping_if_needed_()
 {
-    if (!connected_)
-        return;
-
     const auto t = now_ms_();
-    if (t < next_ping_ms_)
-        return;
-
-    char msg[64];
-    const unsigned id = ++seq_;
-    std::snprintf(msg, sizeof(msg), "PING %u", id);
-    sockaddr_in dst = srv_addr_;
-    dst.sin_port = htons(srv_port_);
-    int r = sendto(s_, msg, (int)std::strlen(msg), 0, (sockaddr*)&dst, sizeof(dst));
-    if (r < 0 && !would_block_())
-        std::perror("sendto(PING)");
-    else
-        _ping_sent_ms.emplace(id, t);
+    for (Session& ses : sessions_)
+    {
+        if (t < ses.next_ping_ms)
+            continue;
+        // down: one outstanding probe at a time, its PONG (or any datagram) revives the session
+        if (!ses.alive)
+            ses.ping_sent_us.clear();
+
+        char msg[64];
+        const unsigned id = ++ses.seq;
+        int n = std::snprintf(msg, sizeof(msg), "PING %u", id);
+        if (ses.want_binary)
+            n += std::snprintf(msg + n, sizeof(msg) - n, " proto=%.*s", (int)wire::kProtoTag.size(), wire::kProtoTag.data());
+        if (ses.ring)
+            std::snprintf(msg + n, sizeof(msg) - n, " shm=1");
+        const std::uint64_t t1 = clock_now_us();
+        int r = sendto(s_, msg, (int)std::strlen(msg), 0, (sockaddr*)&ses.addr, sizeof(ses.addr));
+        if (r < 0 && !would_block_())
+            std::perror("sendto(PING)");
+        else
+            ses.ping_sent_us.emplace(id, t1);
 
-    next_ping_ms_ = t + keepalive_ms_;
+        // short burst until the clock estimate has a few samples, then the keepalive pace
+        const bool syncing = ses.alive && ses.clock.samples() < kClockBurst && ses.seq - ses.sync_seq < 4 * kClockBurst;
+        const std::uint64_t pace = ses.alive ? keepalive_ms_ : kDownPingFactor * keepalive_ms_;
+        ses.next_ping_ms = t + (syncing ? std::max<std::uint64_t>(keepalive_ms_ / 20, 20) : pace);
+    }
 }
 
-void UdpClient::read_all_()
+// sender -> session: exact endpoint, else the producer run id of a framed payload
+// (never just the host: several producers may share one)
+UdpClient::Session* UdpClient::find_session_(const sockaddr_in& from, const char* buf, std::size_t len)
 {
-    for (;;)
+    if (sessions_.empty())
+        return nullptr;
+    const auto same = [&](const Session& s) { return s.addr.sin_addr.s_addr == from.sin_addr.s_addr && s.addr.sin_port == from.sin_port; };
+    if (last_hit_ < sessions_.size() && same(sessions_[last_hit_]))
+        return &sessions_[last_hit_];
+    for (std::size_t i = 0; i < sessions_.size(); ++i)
     {
-        char buf[2048]; sockaddr_in from{}; socklen_t fl = sizeof(from);
-        int read_size = recvfrom(s_, buf, (int)sizeof(buf) - 1, 0, (sockaddr*)&from, &fl);
-        if (read_size < 0)
+        if (same(sessions_[i]))
         {
-            if (would_block_())
-                break;
-            std::perror("recvfrom(client)");
-            break;
+            last_hit_ = i;
+            return &sessions_[i];
         }
-        buf[read_size] = '\0';
+    }
+    if (!framing::isFrame(buf, len))
+        return nullptr;
+    const std::uint32_t run = framing::readHeader(buf).session;
+    for (Session& s : sessions_)
+        if (s.has_frame_session && s.frame_session == run && s.addr.sin_addr.s_addr == from.sin_addr.s_addr)
+            return &s;
+    return nullptr;
+}
 
-        if (!connected_ && static_cast<std::size_t>(read_size) >= kOfferPrefix.size() && std::string_view(buf, kOfferPrefix.size()) == kOfferPrefix)
-        {
-            auto offer_port = parse_offer_port_(buf, 0);
-            auto server_name = parse_offer_name_(buf);
-            auto ip = get_ip_from_sockaddr_(from);
-            std::string key = ip + ":" + std::to_string(offer_port);
+// a down session answered: back to the keepalive pace, clock re-synced (the producer may have restarted)
+void UdpClient::revive_(Session& s)
+{
+    s.alive = true;
+    s.last_pong_ms = now_ms_();
+    s.next_ping_ms = s.last_pong_ms;
+    s.sync_seq = s.seq;
+    s.clock.reset();
+    s.rtt_ms.clear();
+    s.rtt_sum_ms = 0;
+    if (!s.ring && !s.info.shm.empty())
+    {
+        s.ring = std::make_unique<ShmRingConsumer>();
+        if (!s.ring->open(s.info.shm))
+            s.ring.reset();
+    }
+}
 
-            bool exists = false;
-            for (auto& s : _servers)
-            {
-                if (s.name == server_name && s.port == offer_port && s.ip == ip)
-                {
-                    exists = true;
-                    s.last_seen = now_ms_();
-                    continue;
-                }
-            }
-            if (!exists)
-                _servers.push_back(ServerInfo{ server_name, ip, offer_port, now_ms_()});
-    
+// ===== Receive thread =====
+bool UdpClient::wait_readable_(int timeout_ms) const
+{
+    fd_set rd;
+    FD_ZERO(&rd);
+    FD_SET(s_, &rd);
+    timeval tv{};
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    return select((int)s_ + 1, &rd, nullptr, nullptr, &tv) > 0;
+}
+
+// Pulls datagrams into free slab slots and publishes them to the UI; never allocates.
+void UdpClient::rx_loop_()
+{
+    std::vector<std::uint32_t> spare;
+    spare.reserve(kRxSlots);
+#if defined(__linux__)
+    std::array<mmsghdr, kRxBatch> msgs{};
+    std::array<iovec, kRxBatch> iov{};
+    std::array<sockaddr_in, kRxBatch> from{};
+#ifdef SO_RXQ_OVFL
+    alignas(cmsghdr) std::array<std::array<char, CMSG_SPACE(sizeof(std::uint32_t))>, kRxBatch> ctrl{};
+#endif
+#endif
+
+    while (rx_run_.load(std::memory_order_acquire))
+    {
+        std::uint32_t slot;
+        while (rx_free_.try_pop(slot))
+            spare.push_back(slot);
+        if (spare.empty())
+        {
+            // UI is behind: leave the datagrams in the kernel buffer
+            if (IngestStats* st = stats_.load(std::memory_order_acquire))
+                IngestStats::add(st->rxStalls, 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
             continue;
         }
+        if (!wait_readable_(50))
+            continue;
 
-        if (read_size >= 4 && std::string_view(buf, 4) == std::string_view("PONG", 4))
+        IngestStats* st = stats_.load(std::memory_order_acquire);
+        const auto t0 = std::chrono::steady_clock::now();
+        const std::size_t n = std::min(spare.size(), kRxBatch);
+        std::size_t got = 0;
+        std::uint64_t bytes = 0;
+#if defined(__linux__)
+        for (std::size_t i = 0; i < n; ++i)
         {
-            last_pong_ms_ = now_ms_();
-
-            // Parse "PONG <seq>"
-            std::uint32_t pong_seq = 0;
-            if (read_size > 5)
+            const std::uint32_t sl = spare[spare.size() - 1 - i];
+            iov[i].iov_base = rx_slab_.data() + std::size_t(sl) * kRxSlotBytes;
+            iov[i].iov_len = kRxSlotBytes - 1;
+            msgs[i].msg_hdr = {};
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+#ifdef SO_RXQ_OVFL
+            msgs[i].msg_hdr.msg_control = ctrl[i].data();
+            msgs[i].msg_hdr.msg_controllen = ctrl[i].size();
+#endif
+        }
+        const int r = recvmmsg(s_, msgs.data(), (unsigned)n, MSG_DONTWAIT, nullptr);
+        if (r < 0)
+        {
+            if (!would_block_())
+                std::perror("recvmmsg(client)");
+            continue;
+        }
+        const std::uint64_t rx_us = clock_now_us();
+        for (got = 0; got < std::size_t(r); ++got)
+        {
+            rx_ready_.try_push(RxPacket{ spare[spare.size() - 1 - got], msgs[got].msg_len, from[got], rx_us });
+            bytes += msgs[got].msg_len;
+#ifdef SO_RXQ_OVFL
+            // cumulative count of datagrams the kernel dropped on this socket
+            for (cmsghdr* c = CMSG_FIRSTHDR(&msgs[got].msg_hdr); st && c; c = CMSG_NXTHDR(&msgs[got].msg_hdr, c))
             {
-                const char* p = buf + 4;
-                while (*p == ' ' || *p == '\t') ++p;
-                const char* q = p;
-                while (*q >= '0' && *q <= '9') ++q;
-                if (q > p)
-                {
-                    std::from_chars_result fr = std::from_chars(p, q, pong_seq, 10);
-                    (void)fr;
-                }
+                if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SO_RXQ_OVFL) continue;
+                std::uint32_t drops;
+                std::memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+                if (drops > st->kernelDrops.load(std::memory_order_relaxed))
+                    st->kernelDrops.store(drops, std::memory_order_relaxed);
             }
-
-            auto it = _ping_sent_ms.find(pong_seq);
-            if (it != _ping_sent_ms.end())
+#endif
+        }
+#else
+        for (; got < n; ++got)
+        {
+            const std::uint32_t sl = spare[spare.size() - 1 - got];
+            sockaddr_in src{}; socklen_t fl = sizeof(src);
+            const int r = recvfrom(s_, rx_slab_.data() + std::size_t(sl) * kRxSlotBytes, (int)kRxSlotBytes - 1, 0, (sockaddr*)&src, &fl);
+            if (r < 0)
             {
-                std::uint64_t tnow = now_ms_();
-                std::uint32_t rtt = (tnow > it->second) ? (std::uint32_t)(tnow - it->second) : 0;
-                _rtt_ms.push_back(rtt);
-                _rtt_sum_ms += rtt;
-                if (_rtt_ms.size() > kMaxRttSamples) {
-                    _rtt_sum_ms -= _rtt_ms.front();
-                    _rtt_ms.pop_front();
-                }
-                _ping_sent_ms.erase(it);
+                if (!would_block_())
+                    std::perror("recvfrom(client)");
+                break;
             }
+            rx_ready_.try_push(RxPacket{ sl, std::uint32_t(r), src, clock_now_us() });
+            bytes += std::uint64_t(r);
+        }
+#endif
+        spare.resize(spare.size() - got);
+        if (got)
+            if (FrameScheduler* f = wake_.load(std::memory_order_acquire))
+                f->wake(FrameScheduler::LiveData);
+        if (st)
+        {
+            IngestStats::add(st->recvNs, std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count()));
+            IngestStats::add(st->datagrams, got);
+            IngestStats::add(st->bytes, bytes);
+            const auto depth = std::uint32_t(rx_ready_.size());
+            st->queueDepth.store(depth, std::memory_order_relaxed);
+            IngestStats::max(st->queueHigh, depth);
+        }
+    }
+}
+
+// UI side: drains what the receive thread published and recycles the slots
+void UdpClient::read_all_()
+{
+    IngestStats* st = stats_.load(std::memory_order_relaxed);
+    std::optional<IngestStageTimer> timer;
+    if (st) timer.emplace(st->drainNs);
+    RxPacket p;
+    while (rx_ready_.try_pop(p))
+    {
+        char* buf = rx_slab_.data() + std::size_t(p.slot) * kRxSlotBytes;
+        buf[p.len] = '\0';
+        handle_datagram_(buf, int(p.len), p.from, p.rx_us);
+        rx_free_.try_push(p.slot);
+    }
+    if (st) st->queueDepth.store(std::uint32_t(rx_ready_.size()), std::memory_order_relaxed);
+}
+
+void UdpClient::handle_datagram_(const char* buf, int read_size, const sockaddr_in& from, std::uint64_t rx_us)
+{
+    Session* ses = find_session_(from, buf, std::size_t(read_size));
+    const std::uint16_t source = ses ? ses->source : 0;
+    // OFFERs are broadcast answers, not a sign the session itself is back
+    const bool offer = std::size_t(read_size) >= kOfferPrefix.size() && std::string_view(buf, kOfferPrefix.size()) == kOfferPrefix;
+    if (ses && !ses->alive && !offer)
+        revive_(*ses);
+
+    if (framing::isFrame(buf, std::size_t(read_size)))
+    {
+        if (!ses)
+            return; // not (or no longer) in the live set
+        if (ses->addr.sin_port == from.sin_port)
+        {
+            ses->frame_session = framing::readHeader(buf).session;
+            ses->has_frame_session = true;
+        }
+        framer_.feed(buf, std::size_t(read_size), now_ms_(), framed_);
+        for (std::string& m : framed_)
+            _readed.push_back(LivePayload{ source, std::move(m) });
+        framed_.clear();
+        return;
+    }
 
-            // (Optionnel) purger les ping trop vieux pour éviter la fuite mémoire
-            if (!_ping_sent_ms.empty()) {
-                const std::uint64_t cutoff = now_ms_() - 10 * keepalive_ms_;
-                for (auto m = _ping_sent_ms.begin(); m != _ping_sent_ms.end(); ) {
-                    if (m->second < cutoff) m = _ping_sent_ms.erase(m);
-                    else ++m;
-                }
+    if (offer)
+    {
+        auto offer_port = parse_offer_port_(buf, 0);
+        auto server_name = parse_offer_name_(buf);
+        auto proto = parse_offer_proto_(buf);
+        auto shm_name = parse_offer_shm_(buf);
+        auto ip = get_ip_from_sockaddr_(from);
+        std::string key = ip + ":" + std::to_string(offer_port);
+
+        bool exists = false;
+        for (auto& s : _servers)
+        {
+            if (s.name == server_name && s.port == offer_port && s.ip == ip)
+            {
+                exists = true;
+                s.last_seen = now_ms_();
+                s.proto = proto;
+                s.shm = shm_name;
+                continue;
             }
         }
-        else if (read_size >= 10 && std::string_view(buf, 10) == std::string_view("SERVER_MSG", 10))
+        if (!exists)
+            _servers.push_back(ServerInfo{ server_name, ip, offer_port, now_ms_(), proto, shm_name });
+        // re-discovered while down: a restarted producer may offer another encoding / ring
+        for (Session& s : sessions_)
         {
-            std::cout << "Server message: " << buf << std::endl;
+            if (s.alive || s.info.ip != ip || s.info.port != offer_port)
+                continue;
+            s.info.proto = proto;
+            s.info.shm = shm_name;
+            s.want_binary = proto.find(wire::kProtoTag) != std::string::npos;
+            s.next_ping_ms = 0;
         }
-        else
+
+        return;
+    }
+
+    if (read_size >= 4 && std::string_view(buf, 4) == std::string_view("PONG", 4))
+    {
+        if (ses)
+            handle_pong_(*ses, buf, read_size, rx_us);
+    }
+    else if (read_size >= 10 && std::string_view(buf, 10) == std::string_view("SERVER_MSG", 10))
+    {
+        std::cout << "Server message: " << buf << std::endl;
+    }
+    else if (ses)
+    {
+        _readed.push_back(LivePayload{ source, std::string(buf, read_size) });
+    }
+}
+
+void UdpClient::handle_pong_(Session& ses, const char* buf, int read_size, std::uint64_t rx_us)
+{
+    ses.last_pong_ms = now_ms_();
+    ses.alive = true;
+    // "PONG <seq> proto=bin1": producer switched to the binary encoding
+    if (ses.want_binary && std::string_view(buf, std::size_t(read_size)).find(wire::kProtoTag) != std::string_view::npos)
+        ses.binary = true;
+
+    // Parse "PONG <seq>"
+    std::uint32_t pong_seq = 0;
+    if (read_size > 5)
+    {
+        const char* p = buf + 4;
+        while (*p == ' ' || *p == '\t') ++p;
+        const char* q = p;
+        while (*q >= '0' && *q <= '9') ++q;
+        if (q > p)
         {
-            _readed.push_back(std::string(buf, read_size));
+            std::from_chars_result fr = std::from_chars(p, q, pong_seq, 10);
+            (void)fr;
+        }
+    }
+
+    auto it = ses.ping_sent_us.find(pong_seq);
+    if (it != ses.ping_sent_us.end())
+    {
+        const std::uint64_t t1 = it->second;
+        std::uint32_t rtt = (rx_us > t1) ? (std::uint32_t)((rx_us - t1) / 1000) : 0;
+        ses.rtt_ms.push_back(rtt);
+        ses.rtt_sum_ms += rtt;
+        if (ses.rtt_ms.size() > kMaxRttSamples) {
+            ses.rtt_sum_ms -= ses.rtt_ms.front();
+            ses.rtt_ms.pop_front();
+        }
+        // "PONG <seq> t2=<us> t3=<us>": producer receive / send stamps (NTP style)
+        const std::string_view pong(buf, std::size_t(read_size));
+        std::uint64_t t2 = 0, t3 = 0;
+        if (parse_stamp_(pong, "t2=", t2) && parse_stamp_(pong, "t3=", t3))
+            ses.clock.addSample(t1, t2, t3, rx_us);
+        ses.ping_sent_us.erase(it);
+    }
+
+    // (Optionnel) purger les ping trop vieux pour éviter la fuite mémoire
+    if (!ses.ping_sent_us.empty()) {
+        const std::uint64_t cutoff = rx_us - 10 * keepalive_ms_ * 1000;
+        for (auto m = ses.ping_sent_us.begin(); m != ses.ping_sent_us.end(); ) {
+            if (m->second < cutoff) m = ses.ping_sent_us.erase(m);
+            else ++m;
         }
     }
 }
 
 std::uint32_t UdpClient::latency()
 {
-    if (_rtt_ms.empty()) return 0;
-    return static_cast<std::uint32_t>(_rtt_sum_ms / _rtt_ms.size());
+    std::uint64_t sum = 0, n = 0;
+    for (const Session& s : sessions_)
+    {
+        if (!s.alive || s.rtt_ms.empty()) continue;
+        sum += s.rtt_sum_ms / s.rtt_ms.size();
+        ++n;
+    }
+    return n ? static_cast<std::uint32_t>(sum / n) : 0;
 }
 
+// a silent server is kept (marked down, still pinged) so its source id / lanes survive a reconnect
 void UdpClient::check_timeout_()
 {
-    if (connected_ && now_ms_() - last_pong_ms_ > 3 * keepalive_ms_)
-        stop_session();
+    const auto t = now_ms_();
+    for (Session& s : sessions_)
+    {
+        if (s.alive && t - s.last_pong_ms > 3 * keepalive_ms_)
+        {
+            s.alive = false;
+            s.binary = false;
+            s.ping_sent_us.clear();
+            s.ring.reset();
+        }
+    }
 }
 
-void UdpClient::tick(std::vector<std::string>& out_read)
+void UdpClient::tick(std::vector<LivePayload>& out_read)
 {
+    PROFILE_SCOPE("UdpClient::tick");
     read_all_();
+    framer_.expire(now_ms_());
     send_ping_if_needed_();
     check_timeout_();
     for (auto it = _readed.begin(); it != _readed.end(); ++it)
-    {
-        std::string& s = (*it);
-        out_read.push_back(std::move(s));
-    }
+        out_read.push_back(std::move(*it));
     _readed.clear();
 }
@@ -8,6 +8,18 @@
 #include <optional>
 #include <vector>
 #include <charconv>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <functional>
+
+#include "spsc_ring.hpp"
+#include "framing.hpp"
+#include "wire_binary.hpp"
+#include "ingest_stats.hpp"
+#include "frame_scheduler.hpp"
+#include "clock_sync.hpp"
+#include "shm_ring.hpp"
 
 #ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
@@ -31,6 +43,7 @@ using socklen_t = int;
 #include <unistd.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <sys/select.h>
 using socket_t = int;
 #endif
 
@@ -41,6 +54,34 @@ struct ServerInfo
 	std::string ip;
 	uint16_t port;
 	uint64_t last_seen;
+	std::string proto;   // OFFER "proto=" (comma separated, empty = JSON only)
+	std::string shm;     // OFFER "shm=" shared memory ring name (same host transport)
+};
+
+/// @brief LivePayload — class/struct documentation.
+struct LivePayload
+{
+	std::uint16_t source = 0;   // live session that sent it (UdpClient::start_session), 0 = none
+	std::string data;
+};
+
+/// @brief LiveSessionInfo — class/struct documentation.
+struct LiveSessionInfo
+{
+	std::uint16_t source = 0;
+	ServerInfo server;
+	bool connected = false;
+	const char* protocol = "json";
+	std::uint32_t latency_ms = 0;
+	// producer clock vs viewer clock (PONG t2/t3 stamps)
+	bool clock_synced = false;
+	double clock_offset_us = 0.0;
+	double clock_drift_ppm = 0.0;
+	std::uint64_t clock_delay_us = 0;
+	// data through the shared memory ring instead of UDP
+	bool shm = false;
+	std::uint64_t shm_records = 0;
+	std::uint64_t shm_dropped = 0;
 };
 
 /// @brief UdpClient — class/struct documentation.
@@ -53,14 +94,40 @@ public:
 	UdpClient& operator=(const UdpClient&) = delete;
 
 
-	void tick(std::vector<std::string>& out_read);
+	void tick(std::vector<LivePayload>& out_read);
 	std::vector<ServerInfo> scan();
-	void start_session(const ServerInfo& s);
+	// adds a server to the live set (several run at once); returns its source id (>= 1)
+	std::uint16_t start_session(const ServerInfo& s);
+	void stop_session(std::uint16_t source);
+	// drops every session
 	void stop_session();
+	// mean RTT over the connected sessions
 	std::uint32_t latency();
 
-	bool connected() const { return connected_; }
-	std::string server_endpoint() const; // "ip:port"
+	// at least one session alive
+	bool connected() const;
+	std::size_t session_count() const { return sessions_.size(); }
+	std::vector<LiveSessionInfo> sessions() const;
+	// "name" of a source id, empty if unknown
+	std::string source_name(std::uint16_t source) const;
+	// producer clock estimate of a source (null if unknown / never synced)
+	const ClockSync* clock(std::uint16_t source) const;
+	// same-host sessions: decodes the shared memory rings into runs[source] / metrics,
+	// returns the number of records consumed. onDrained(source, firstEvent, firstMetric) is
+	// called after each session with the start of what it appended (producer clock)
+	using OnShmDrained = std::function<void(std::uint16_t source, std::size_t firstEvent, std::size_t firstMetric)>;
+	std::size_t drain_shm(std::vector<std::vector<Event>>& runs, std::vector<Metric>& metrics, const OnShmDrained& onDrained = {});
+	std::string server_endpoint() const; // "ip:port" (first session) or "N servers"
+	// telemetry sink for the receive / drain stages (owned by the caller, may be null)
+	void set_stats(IngestStats* stats) { stats_.store(stats, std::memory_order_release); }
+	// woken (LiveData) by the receive thread when datagrams are queued (may be null)
+	void set_wake(FrameScheduler* frames) { wake_.store(frames, std::memory_order_release); }
+	// a session reads through shared memory (polled, no wake up)
+	bool shm_active() const;
+	// live encoding agreed on the PING/PONG handshake ("bin1", "json" or "mixed")
+	const char* protocol() const;
+	// framed (fragmented / sequenced) payloads: per session loss accounting
+	const FrameReassembler& framing() const { return framer_; }
 
 
 private:
@@ -69,11 +136,10 @@ private:
 	static constexpr std::string_view kOfferPrefix{ "OFFER" };
 	static constexpr std::string_view kMagicToken{ "MAGIC{vS9zyH:2p^nQ!eF#7L}" };
 
-	// ===== Latency =====
-	std::unordered_map<std::uint32_t, std::uint64_t> _ping_sent_ms;
-	std::deque<std::uint32_t> _rtt_ms;
-	std::uint64_t _rtt_sum_ms;
 	static constexpr std::size_t kMaxRttSamples = 64;
+	static constexpr std::size_t kClockBurst = 8;   // fast PINGs at session start
+	static constexpr std::uint64_t kDownPingFactor = 4;   // a down session is re-pinged every 4 keepalives
+	static constexpr std::size_t kShmDrainMax = 1u << 20;   // records per source and tick
 
 	// ===== Socket & dcouverte =====
 	socket_t s_;
@@ -82,19 +148,75 @@ private:
 	std::uint64_t last_probe_ms_;
 	std::uint16_t current_port_;
 	std::vector<ServerInfo> _servers;
-	std::vector<std::string> _readed;
-
-
-	// ===== Session / keepalive =====
-	bool connected_;
-	sockaddr_in srv_addr_;
-	std::uint16_t srv_port_;
+	std::vector<LivePayload> _readed;
+	FrameReassembler framer_;
+	std::vector<std::string> framed_;   // messages completed by the last fragment
+
+
+	// ===== Sessions / keepalive =====
+	// one per connected server, all multiplexed on s_ (matched on the sender address, or on
+	// the frame session id). A silent session is marked down and keeps being pinged; any
+	// datagram from it brings it back
+	/// @brief Session — class/struct documentation.
+	struct Session
+	{
+		ServerInfo info;
+		sockaddr_in addr{};
+		std::uint16_t source = 0;
+		bool alive = true;
+		std::uint64_t next_ping_ms = 0;
+		std::uint64_t last_pong_ms = 0;
+		std::uint32_t seq = 0;
+		std::uint32_t sync_seq = 0;   // first PING of the current clock sync burst
+		bool want_binary = false;   // server offered bin1, asked for in PINGs
+		bool binary = false;        // confirmed by a PONG
+		// producer run id of its framed payloads (learned from the session address), lets
+		// fragments sent from another port still find the session
+		std::uint32_t frame_session = 0;
+		bool has_frame_session = false;
+
+		// ===== Latency / clock =====
+		std::unordered_map<std::uint32_t, std::uint64_t> ping_sent_us;   // t1 (wall clock)
+		ClockSync clock;
+
+		// same-host shared memory transport (OFFER "shm="), mapped on start_session
+		std::unique_ptr<ShmRingConsumer> ring;
+		std::deque<std::uint32_t> rtt_ms;
+		std::uint64_t rtt_sum_ms = 0;
+	};
+	std::vector<Session> sessions_;
+	std::uint16_t next_source_ = 1;
+	std::size_t last_hit_ = 0;
 	std::uint64_t keepalive_ms_;
-	std::uint64_t next_ping_ms_;
-	std::uint64_t last_pong_ms_;
-	std::uint32_t seq_;
 
 
+	// ===== Receive thread =====
+	// recv thread -> slab slot -> rx_ready_ -> UI (classify, copy) -> rx_free_ -> recv thread
+	static constexpr std::size_t kRxSlotBytes = 64 * 1024;     // any UDP datagram + '\0'
+	static constexpr std::size_t kRxSlots = 256;
+	static constexpr std::size_t kRxBatch = 32;                // datagrams per recvmmsg
+	static constexpr int kRxSocketBuffer = 8 * 1024 * 1024;    // SO_RCVBUF request
+
+	/// @brief RxPacket — class/struct documentation.
+	struct RxPacket
+	{
+		std::uint32_t slot;
+		std::uint32_t len;
+		sockaddr_in from;
+		std::uint64_t rx_us;   // wall clock at reception (PONG t4)
+	};
+	std::vector<char> rx_slab_;
+	SpscRing<RxPacket> rx_ready_{ kRxSlots };
+	SpscRing<std::uint32_t> rx_free_{ kRxSlots };
+	std::thread rx_thread_;
+	std::atomic<bool> rx_run_{ false };
+	std::atomic<IngestStats*> stats_{ nullptr };
+	std::atomic<FrameScheduler*> wake_{ nullptr };
+
+	void rx_loop_();
+	bool wait_readable_(int timeout_ms) const;
+	void handle_datagram_(const char* buf, int read_size, const sockaddr_in& from, std::uint64_t rx_us);
+
 	// --- internes ---
 	static std::uint64_t now_ms_();
 	static void net_init_();
@@ -109,7 +231,13 @@ private:
 	void read_all_();
 	void send_ping_if_needed_();
 	void check_timeout_();
+	Session* find_session_(const sockaddr_in& from, const char* buf, std::size_t len);
+	void revive_(Session& s);
+	void handle_pong_(Session& s, const char* buf, int read_size, std::uint64_t rx_us);
 
 	static std::uint16_t parse_offer_port_(std::string_view offer, std::uint16_t fallback);
 	static std::string parse_offer_name_(std::string_view offer);
+	static std::string parse_offer_proto_(std::string_view offer);
+	static std::string parse_offer_shm_(std::string_view offer);
+	static bool parse_stamp_(std::string_view msg, std::string_view key, std::uint64_t& out);
 };
@@ -69,22 +69,6 @@ inline std::string fmtTime(double us)
     }
 }
 
-inline std::string elideToWidth(const std::string& s, float maxPx)
-{
-    if (maxPx <= 0.f || s.empty()) return {};
-    if (ImGui::CalcTextSize(s.c_str()).x <= maxPx) return s;
-    static constexpr const char* dots = "...";
-    float wd = ImGui::CalcTextSize(dots).x;
-    if (wd >= maxPx) return {};
-    int lo = 0, hi = int(s.size());
-    while (lo < hi) {
-        int mid = (lo + hi + 1) / 2;
-        std::string st = s.substr(0, mid) + dots;
-        if (ImGui::CalcTextSize(st.c_str()).x <= maxPx) lo = mid; else hi = mid - 1;
-    }
-    return s.substr(0, lo) + dots;
-}
-
 inline double nice_step_us(double rangeUs, int targetTicks)
 {
     if (rangeUs <= 0) return 1.0;
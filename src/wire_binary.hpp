@@ -0,0 +1,313 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "model.hpp"
+
+// =============== Binary wire protocol (bin1) ===============
+// Negotiated on the handshake: OFFER advertises "proto=bin1", the viewer asks for it
+// in its PINGs ("PING <seq> proto=bin1") and the producer confirms in the PONG.
+// A message (one datagram, or one reassembled framed payload):
+//   u8 0xF7 | u8 'B' | u8 version | u8 flags | u32 session | records...
+// Records (varint = LEB128, zz = zigzag varint):
+//   0x01 STRING  : varint id | varint len | bytes           (defined once per session)
+//   0x02 EVENT   : zz dts | varint dur | varint name | varint cat | varint color
+//                  | varint pid | varint tid | varint id | varint dataLen | data
+//   0x03 METRIC  : zz dts | f32 cpu | f32 cpu_total | varint ram_used | varint ram_total
+//   0x04 STAT    : varint name | varint count | f64 avg_us | varint min_us | varint max_us
+// dts is relative to the previous record of the same type in the message (first one: 0),
+// so a lost datagram never corrupts the next one. String id 0 = empty string; an event or
+// stat naming a string the decoder never saw (its definition was lost) is dropped.
+namespace wire
+{
+    inline constexpr uint8_t kMagic0 = 0xF7;
+    inline constexpr uint8_t kMagic1 = 'B';
+    inline constexpr uint8_t kVersion = 1;
+    inline constexpr size_t  kHeaderBytes = 8;
+    inline constexpr std::string_view kProtoTag{ "bin1" };
+
+    enum Record : uint8_t { RecString = 0x01, RecEvent = 0x02, RecMetric = 0x03, RecStat = 0x04 };
+
+    inline bool isBinary(std::string_view msg)
+    {
+        return msg.size() >= kHeaderBytes && uint8_t(msg[0]) == kMagic0 && uint8_t(msg[1]) == kMagic1 && uint8_t(msg[2]) == kVersion;
+    }
+
+    // ---------- varints ----------
+    inline void putVarint(std::string& out, uint64_t v)
+    {
+        while (v >= 0x80) { out.push_back(char(uint8_t(v) | 0x80)); v >>= 7; }
+        out.push_back(char(v));
+    }
+    inline void putZigzag(std::string& out, int64_t v)
+    {
+        putVarint(out, (uint64_t(v) << 1) ^ uint64_t(v >> 63));
+    }
+    inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7)
+        {
+            const uint8_t b = *p++;
+            v |= uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+    inline bool getZigzag(const uint8_t*& p, const uint8_t* end, int64_t& v)
+    {
+        uint64_t u;
+        if (!getVarint(p, end, u)) return false;
+        v = int64_t(u >> 1) ^ -int64_t(u & 1);
+        return true;
+    }
+
+    // =============== Encoder (producer side) ===============
+    // Builds messages; begin() / event() / metric() / finish(). Strings are interned and
+    // their definitions are re-sent every kRedefineEvery messages so late joiners and
+    // lost datagrams heal.
+    class Encoder
+    {
+    public:
+        static constexpr uint32_t kRedefineEvery = 256;
+
+        explicit Encoder(uint32_t session = 0) : _session(session) {}
+
+        void begin()
+        {
+            _msg.clear();
+            _msg.push_back(char(kMagic0));
+            _msg.push_back(char(kMagic1));
+            _msg.push_back(char(kVersion));
+            _msg.push_back(0);
+            _msg.append(reinterpret_cast<const char*>(&_session), 4);
+            _prevEventTs = 0;
+            _prevMetricTs = 0;
+            ++_msgIndex;
+        }
+
+        void event(std::string_view name, std::string_view cat, uint64_t ts, uint64_t dur,
+                   std::string_view data = {}, std::string_view color = {},
+                   uint32_t pid = 1, uint32_t tid = 0, uint64_t id = 0)
+        {
+            const uint64_t n = intern(name), c = intern(cat), col = intern(color);
+            _msg.push_back(char(RecEvent));
+            putZigzag(_msg, int64_t(ts - _prevEventTs));
+            _prevEventTs = ts;
+            putVarint(_msg, dur);
+            putVarint(_msg, n);
+            putVarint(_msg, c);
+            putVarint(_msg, col);
+            putVarint(_msg, pid);
+            putVarint(_msg, tid);
+            putVarint(_msg, id);
+            putVarint(_msg, data.size());
+            _msg.append(data);
+        }
+
+        void metric(uint64_t ts, float cpu, float cpuTotal, uint64_t ramUsed, uint64_t ramTotal)
+        {
+            _msg.push_back(char(RecMetric));
+            putZigzag(_msg, int64_t(ts - _prevMetricTs));
+            _prevMetricTs = ts;
+            _msg.append(reinterpret_cast<const char*>(&cpu), 4);
+            _msg.append(reinterpret_cast<const char*>(&cpuTotal), 4);
+            putVarint(_msg, ramUsed);
+            putVarint(_msg, ramTotal);
+        }
+
+        // producer side aggregate, same as a JSON {"type":"stat"} object
+        void stat(std::string_view name, uint64_t count, double avgUs, uint64_t minUs, uint64_t maxUs)
+        {
+            const uint64_t n = intern(name);
+            _msg.push_back(char(RecStat));
+            putVarint(_msg, n);
+            putVarint(_msg, count);
+            _msg.append(reinterpret_cast<const char*>(&avgUs), 8);
+            putVarint(_msg, minUs);
+            putVarint(_msg, maxUs);
+        }
+
+        size_t size() const { return _msg.size(); }
+        const std::string& finish() const { return _msg; }
+
+    private:
+        uint64_t intern(std::string_view s)
+        {
+            if (s.empty()) return 0;
+            auto it = _ids.find(std::string(s));
+            if (it == _ids.end())
+                it = _ids.emplace(std::string(s), Entry{ uint32_t(_ids.size() + 1), 0 }).first;
+            Entry& e = it->second;
+            if (e.sentMsg == 0 || _msgIndex - e.sentMsg >= kRedefineEvery)
+            {
+                _msg.push_back(char(RecString));
+                putVarint(_msg, e.id);
+                putVarint(_msg, s.size());
+                _msg.append(s);
+                e.sentMsg = _msgIndex;
+            }
+            return e.id;
+        }
+
+    private:
+        /// @brief Entry — class/struct documentation.
+        struct Entry
+        {
+            uint32_t id;
+            uint32_t sentMsg;
+        };
+        uint32_t _session;
+        std::string _msg;
+        std::unordered_map<std::string, Entry> _ids;
+        uint32_t _msgIndex = 0;
+        uint64_t _prevEventTs = 0;
+        uint64_t _prevMetricTs = 0;
+    };
+
+    // =============== Decoder (viewer side) ===============
+    // One string table per producer session.
+    class Decoder
+    {
+    public:
+        // Same outputs as parse_trace_payload: stats are replaced by name.
+        bool decode(std::string_view msg, std::vector<Event>& outEvents, std::unordered_map<std::string, EventStats>& outStats,
+                    std::vector<Metric>& outMetrics, std::string* err = nullptr)
+        {
+            return decodeEach(msg,
+                [&](Event&& e) { outEvents.push_back(std::move(e)); },
+                [&](const Metric& m) { outMetrics.push_back(m); },
+                [&](const std::string& name, const EventStats& st) { outStats[name] = st; }, err);
+        }
+
+        // Same, records handed over in message order.
+        template <class OnEvent, class OnMetric, class OnStat>
+        bool decodeEach(std::string_view msg, OnEvent&& onEvent, OnMetric&& onMetric, OnStat&& onStat, std::string* err = nullptr)
+        {
+            if (!isBinary(msg)) { if (err) *err = "Not a bin1 message"; return false; }
+            uint32_t session;
+            std::memcpy(&session, msg.data() + 4, 4);
+            std::vector<std::string>& strings = _tables[session];
+
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(msg.data()) + kHeaderBytes;
+            const uint8_t* end = reinterpret_cast<const uint8_t*>(msg.data()) + msg.size();
+            // defined strings are never empty, only id 0 is
+            auto defined = [&](uint64_t id) { return id == 0 || (id < strings.size() && !strings[id].empty()); };
+
+            uint64_t evTs = 0, mTs = 0;
+            while (p < end)
+            {
+                const uint8_t tag = *p++;
+                if (tag == RecString)
+                {
+                    uint64_t id, len;
+                    if (!getVarint(p, end, id) || !getVarint(p, end, len) || len > uint64_t(end - p) || id > kMaxStrings)
+                        return fail(err, "Truncated string record");
+                    if (strings.size() <= id) strings.resize(id + 1);
+                    strings[id].assign(reinterpret_cast<const char*>(p), size_t(len));
+                    p += len;
+                }
+                else if (tag == RecEvent)
+                {
+                    int64_t dts;
+                    uint64_t dur, n, c, col, pid, tid, id, dlen;
+                    if (!getZigzag(p, end, dts) || !getVarint(p, end, dur) || !getVarint(p, end, n) || !getVarint(p, end, c)
+                        || !getVarint(p, end, col) || !getVarint(p, end, pid) || !getVarint(p, end, tid) || !getVarint(p, end, id)
+                        || !getVarint(p, end, dlen) || dlen > uint64_t(end - p))
+                        return fail(err, "Truncated event record");
+                    evTs += uint64_t(dts);
+                    if (!defined(n) || !defined(c) || !defined(col))
+                    {
+                        p += dlen;
+                        ++_undecodable;
+                        continue;
+                    }
+                    Event e;
+                    e.name = strings_at(strings, n);
+                    e.category = strings_at(strings, c);
+                    e.color = strings_at(strings, col);
+                    e.ts = evTs;
+                    e.dur = dur;
+                    e.pid = uint32_t(pid);
+                    e.tid = uint32_t(tid);
+                    e.id = id;
+                    e.data.assign(reinterpret_cast<const char*>(p), size_t(dlen));
+                    p += dlen;
+                    onEvent(std::move(e));
+                }
+                else if (tag == RecMetric)
+                {
+                    int64_t dts;
+                    float cpu, cpuTotal;
+                    uint64_t used, total;
+                    if (!getZigzag(p, end, dts) || end - p < 8)
+                        return fail(err, "Truncated metric record");
+                    std::memcpy(&cpu, p, 4);
+                    std::memcpy(&cpuTotal, p + 4, 4);
+                    p += 8;
+                    if (!getVarint(p, end, used) || !getVarint(p, end, total))
+                        return fail(err, "Truncated metric record");
+                    mTs += uint64_t(dts);
+                    Metric m;
+                    m.ts = mTs;
+                    m.cpu = cpu;
+                    m.cpu_total = cpuTotal;
+                    m.ram_used = used;
+                    m.ram_total = total;
+                    onMetric(m);
+                }
+                else if (tag == RecStat)
+                {
+                    uint64_t n, count, minUs, maxUs;
+                    double avgUs;
+                    if (!getVarint(p, end, n) || !getVarint(p, end, count) || end - p < 8)
+                        return fail(err, "Truncated stat record");
+                    std::memcpy(&avgUs, p, 8);
+                    p += 8;
+                    if (!getVarint(p, end, minUs) || !getVarint(p, end, maxUs))
+                        return fail(err, "Truncated stat record");
+                    if (n == 0 || !defined(n))
+                    {
+                        ++_undecodable;
+                        continue;
+                    }
+                    EventStats st;
+                    st.count = count;
+                    st.avg_us = avgUs;
+                    st.min_us = minUs;
+                    st.max_us = maxUs;
+                    onStat(strings[n], st);
+                }
+                else
+                    return fail(err, "Unknown bin1 record");
+            }
+            return true;
+        }
+
+        void reset() { _tables.clear(); }
+        // events / stats dropped so far because they named an undefined string
+        uint64_t undecodable() const { return _undecodable; }
+
+    private:
+        static constexpr uint64_t kMaxStrings = 1u << 20;
+
+        static const std::string& strings_at(const std::vector<std::string>& strings, uint64_t id)
+        {
+            static const std::string kEmpty;
+            return id ? strings[id] : kEmpty;
+        }
+
+        static bool fail(std::string* err, const char* what)
+        {
+            if (err) *err = what;
+            return false;
+        }
+
+        std::unordered_map<uint32_t, std::vector<std::string>> _tables;
+        uint64_t _undecodable = 0;
+    };
+}
@@ -0,0 +1,510 @@
+// Headless benchmark of the timeline layout / draw code (ViewerApp::drawTimeline and the
+// category / async / metrics blocks it calls). No window, no GL context: an ImGui context
+// with a null renderer, synthetic stores of a given size and shape, and a scripted
+// sequence of viewports (fit, zoom, pan, vertical scroll, filter typing). Per phase it
+// reports CPU time per frame (NewFrame -> Render), draw list vertices and heap allocations.
+//   --shape S      flat        few categories, one lane each
+//                  categories  thousands of categories (row count bound)
+//                  overlap     deep nesting, dozens of lanes per category
+//                  live        several sources, appended in batches while following the tail
+//                  all         every shape above (default)
+//   --events N     events per shape (100M needs ~20 GB: Event is ~200 bytes)
+//   --gpu-boxes    instanced box path (its CPU side only) instead of ImDrawList rectangles
+//   --zones        per zone breakdown (self profiler) of each phase
+//   --json FILE    results, keyed "shape/phase"
+//   --baseline F   compares with an earlier --json: exit code 1 when p95 ms, vertices or
+//                  allocations per frame grew by more than --tolerance (fraction)
+//
+// usage: render_bench [--shape all] [--events 1000000] [--width 1920] [--height 1080]
+//                     [--seed 1] [--gpu-boxes] [--zones] [--json FILE]
+//                     [--baseline FILE] [--tolerance 0.15]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <imgui.h>
+#include <nlohmann/json.hpp>
+
+#include "ViewerApp.hpp"
+#include "self_profile.hpp"
+
+// ---------- Allocation counters (every operator new of the process, and ImGui's IM_ALLOC) ----------
+namespace
+{
+    std::atomic<uint64_t> g_allocs{ 0 };
+    std::atomic<uint64_t> g_allocBytes{ 0 };
+
+    void* counted_alloc(std::size_t n)
+    {
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+        g_allocBytes.fetch_add(n, std::memory_order_relaxed);
+        if (void* p = std::malloc(n ? n : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    // ImGui allocates through malloc (draw lists, vertex / index buffers), not operator new
+    void* imgui_alloc(size_t n, void*)
+    {
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+        g_allocBytes.fetch_add(n, std::memory_order_relaxed);
+        return std::malloc(n);
+    }
+    void imgui_free(void* p, void*) { std::free(p); }
+}
+
+void* operator new(std::size_t n) { return counted_alloc(n); }
+void* operator new[](std::size_t n) { return counted_alloc(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+    /// @brief Options — class/struct documentation.
+    struct Options
+    {
+        std::string shape = "all";
+        uint64_t events = 1'000'000;
+        float width = 1920.f;
+        float height = 1080.f;
+        uint32_t seed = 1;
+        bool gpuBoxes = false;
+        bool zones = false;
+        std::string json;
+        std::string baseline;
+        double tolerance = 0.15;
+    };
+
+    constexpr const char* kUsage =
+        "usage: render_bench [--shape flat|categories|overlap|live|all] [--events N] [--width W] [--height H]\n"
+        "                    [--seed N] [--gpu-boxes] [--zones] [--json FILE] [--baseline FILE] [--tolerance F]\n";
+
+    bool parse_args(int argc, char** argv, Options& o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view a = argv[i];
+            if (a == "--gpu-boxes") { o.gpuBoxes = true; continue; }
+            if (a == "--zones") { o.zones = true; continue; }
+            const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+            if (!v) { std::fputs(kUsage, stderr); return false; }
+            ++i;
+            if (a == "--shape") o.shape = v;
+            else if (a == "--events") o.events = uint64_t(std::max(1.0, std::atof(v)));
+            else if (a == "--width") o.width = float(std::max(320, std::atoi(v)));
+            else if (a == "--height") o.height = float(std::max(240, std::atoi(v)));
+            else if (a == "--seed") o.seed = uint32_t(std::atoi(v));
+            else if (a == "--json") o.json = v;
+            else if (a == "--baseline") o.baseline = v;
+            else if (a == "--tolerance") o.tolerance = std::max(0.0, std::atof(v));
+            else { std::fputs(kUsage, stderr); return false; }
+        }
+        return true;
+    }
+
+    double ms_since(std::chrono::steady_clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    // ---------- Synthetic stores ----------
+    Event make_event(uint32_t cat, uint32_t name, uint64_t ts, uint64_t dur, uint32_t tid, uint16_t source)
+    {
+        Event e;
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "cat_%04u", cat);
+        e.category = buf;
+        std::snprintf(buf, sizeof(buf), "work_%02u", name);
+        e.name = buf;
+        e.ts = ts;
+        e.dur = dur;
+        e.tid = tid;
+        e.source = source;
+        return e;
+    }
+
+    // sequential events per category, gaps in between (one lane per category)
+    std::vector<Event> gen_sequential(uint64_t n, uint32_t cats, std::mt19937& rng)
+    {
+        std::vector<Event> out;
+        out.reserve(size_t(n));
+        std::vector<uint64_t> cursor(cats, 1'000'000);
+        std::uniform_int_distribution<uint64_t> dur(5, 200), gap(0, 100);
+        std::uniform_int_distribution<uint32_t> name(0, 15);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            const uint32_t c = uint32_t(i % cats);
+            const uint64_t d = dur(rng);
+            out.push_back(make_event(c, name(rng), cursor[c], d, c, 0));
+            cursor[c] += d + gap(rng);
+        }
+        return out;
+    }
+
+    // call stacks up to 24 deep: each level nested in the one above
+    std::vector<Event> gen_overlap(uint64_t n, uint32_t cats, std::mt19937& rng)
+    {
+        std::vector<Event> out;
+        out.reserve(size_t(n));
+        std::vector<uint64_t> cursor(cats, 1'000'000);
+        std::uniform_int_distribution<uint32_t> depth(1, 24), name(0, 31);
+        std::uniform_int_distribution<uint64_t> root(500, 5000);
+        while (out.size() < n)
+        {
+            for (uint32_t c = 0; c < cats && out.size() < n; ++c)
+            {
+                const uint64_t d = root(rng);
+                const uint32_t levels = depth(rng);
+                for (uint32_t k = 0; k < levels && out.size() < n; ++k)
+                {
+                    const uint64_t inset = uint64_t(k) * (d / 64 + 1);
+                    if (2 * inset >= d) break;
+                    out.push_back(make_event(c, name(rng), cursor[c] + inset, d - 2 * inset, c, 0));
+                }
+                cursor[c] += d + 10;
+            }
+        }
+        return out;
+    }
+
+    // ---------- Scripted viewports ----------
+    /// @brief Step — class/struct documentation.
+    struct Step
+    {
+        const char* phase;
+        ViewerApp::BenchView view;
+        size_t append = 0;   // live: events appended before the frame
+    };
+
+    std::vector<Step> script_static(bool gpuBoxes)
+    {
+        std::vector<Step> s;
+        ViewerApp::BenchView v;
+        v.gpuBoxes = gpuBoxes;
+        for (int i = 0; i < 10; ++i)
+            s.push_back({ "fit", v });
+        // geometric zoom 1 -> 1e4 around 37 %
+        for (int i = 0; i < 90; ++i)
+        {
+            v.zoom = float(std::pow(1e4, i / 89.0));
+            const double span = 1.0 / v.zoom;
+            v.offset = std::clamp(0.37 - 0.5 * span, 0.0, 1.0 - span);
+            s.push_back({ "zoom", v });
+        }
+        // pan across the whole range at 200x
+        v.zoom = 200.f;
+        for (int i = 0; i < 90; ++i)
+        {
+            v.offset = (1.0 - 1.0 / v.zoom) * i / 89.0;
+            s.push_back({ "pan", v });
+        }
+        // vertical scroll through the rows
+        v.zoom = 1.f; v.offset = 0.0;
+        for (int i = 0; i < 40; ++i)
+        {
+            v.panY = -100.f * float(i);
+            s.push_back({ "scroll", v });
+        }
+        // typing a filter, then clearing it
+        v.panY = 0.f;
+        static const char* kTyped[] = { "w", "wo", "wor", "work", "work_", "work_1", "work_12", "" };
+        for (const char* f : kTyped)
+        {
+            v.filter = f;
+            for (int i = 0; i < 6; ++i)
+                s.push_back({ "filter", v });
+        }
+        return s;
+    }
+
+    /// @brief PhaseStats — class/struct documentation.
+    struct PhaseStats
+    {
+        std::vector<double> ms;
+        std::vector<int> vertices;
+        uint64_t allocs = 0;
+        uint64_t allocBytes = 0;
+        std::map<std::string, double> zoneMs;   // summed over the frames
+        std::vector<std::string> zoneOrder;
+
+        double percentile(double p) const
+        {
+            if (ms.empty()) return 0.0;
+            std::vector<double> v = ms;
+            const size_t k = std::min(v.size() - 1, size_t(p * double(v.size() - 1) + 0.5));
+            std::nth_element(v.begin(), v.begin() + ptrdiff_t(k), v.end());
+            return v[k];
+        }
+        double mean() const
+        {
+            double s = 0.0;
+            for (double x : ms) s += x;
+            return ms.empty() ? 0.0 : s / double(ms.size());
+        }
+        double allocsPerFrame() const { return ms.empty() ? 0.0 : double(allocs) / double(ms.size()); }
+        int maxVertices() const { return vertices.empty() ? 0 : *std::max_element(vertices.begin(), vertices.end()); }
+    };
+
+    // what a renderer backend would do with the font atlas texture requests
+    void null_renderer_textures()
+    {
+#if IMGUI_VERSION_NUM >= 19200
+        for (ImTextureData* tex : ImGui::GetPlatformIO().Textures)
+        {
+            if (tex->Status == ImTextureStatus_WantCreate || tex->Status == ImTextureStatus_WantUpdates)
+            {
+                tex->SetTexID(ImTextureID(1));
+                tex->SetStatus(ImTextureStatus_OK);
+            }
+            else if (tex->Status == ImTextureStatus_WantDestroy && tex->UnusedFrames > 0)
+            {
+                tex->SetTexID(ImTextureID_Invalid);
+                tex->SetStatus(ImTextureStatus_Destroyed);
+            }
+        }
+#endif
+    }
+
+    // one frame: NewFrame -> timeline -> Render; returns CPU ms
+    double run_frame(ViewerApp& app, const ViewerApp::BenchView& v, int& vertices)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        selfprof::beginFrame();
+        ImGui::NewFrame();
+        app.benchFrame(v);
+        ImGui::Render();
+        selfprof::endFrame();
+        const double ms = ms_since(t0);
+        vertices = ImGui::GetDrawData()->TotalVtxCount;
+        null_renderer_textures();
+        return ms;
+    }
+
+    void run_steps(ViewerApp& app, const std::vector<Step>& steps, std::vector<Event>* liveSrc, bool zones,
+        std::vector<std::pair<std::string, PhaseStats>>& out)
+    {
+        size_t liveNext = 0;
+        for (const Step& st : steps)
+        {
+            if (out.empty() || out.back().first != st.phase)
+                out.emplace_back(st.phase, PhaseStats{});
+            PhaseStats& ps = out.back().second;
+
+            // live: the batch is built outside the measured frame, appended inside (as tick_live)
+            std::vector<Event> batch;
+            if (liveSrc && st.append)
+            {
+                const size_t end = std::min(liveSrc->size(), liveNext + st.append);
+                batch.assign(std::make_move_iterator(liveSrc->begin() + ptrdiff_t(liveNext)), std::make_move_iterator(liveSrc->begin() + ptrdiff_t(end)));
+                liveNext = end;
+            }
+
+            const uint64_t a0 = g_allocs.load(std::memory_order_relaxed);
+            const uint64_t b0 = g_allocBytes.load(std::memory_order_relaxed);
+            const auto t0 = std::chrono::steady_clock::now();
+            if (!batch.empty())
+                app.benchAppend(std::move(batch));
+            const double appendMs = ms_since(t0);
+            int vertices = 0;
+            ps.ms.push_back(appendMs + run_frame(app, st.view, vertices));
+            ps.vertices.push_back(vertices);
+            ps.allocs += g_allocs.load(std::memory_order_relaxed) - a0;
+            ps.allocBytes += g_allocBytes.load(std::memory_order_relaxed) - b0;
+
+            if (zones)
+            {
+                for (const selfprof::StageTime& s : selfprof::report().stages)
+                {
+                    auto [it, added] = ps.zoneMs.try_emplace(s.name, 0.0);
+                    if (added) ps.zoneOrder.push_back(s.name);
+                    it->second += s.ms;
+                }
+            }
+        }
+    }
+
+    void print_phase(const std::string& phase, const PhaseStats& ps, bool zones)
+    {
+        std::printf("  %-12s %4zu frames  mean %8.3f  p50 %8.3f  p95 %8.3f  max %8.3f ms  vtx max %9d  allocs/frame %9.1f  %8.1f KiB/frame\n",
+            phase.c_str(), ps.ms.size(), ps.mean(), ps.percentile(0.5), ps.percentile(0.95),
+            ps.ms.empty() ? 0.0 : *std::max_element(ps.ms.begin(), ps.ms.end()), ps.maxVertices(), ps.allocsPerFrame(),
+            ps.ms.empty() ? 0.0 : double(ps.allocBytes) / 1024.0 / double(ps.ms.size()));
+        if (!zones)
+            return;
+        for (const std::string& z : ps.zoneOrder)
+            std::printf("      %-22s %8.3f ms/frame\n", z.c_str(), ps.zoneMs.at(z) / double(std::max<size_t>(1, ps.ms.size())));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parse_args(argc, argv, opt))
+        return 2;
+    const std::vector<std::string> shapes = opt.shape == "all"
+        ? std::vector<std::string>{ "flat", "categories", "overlap", "live" }
+        : std::vector<std::string>{ opt.shape };
+    for (const std::string& s : shapes)
+    {
+        if (s != "flat" && s != "categories" && s != "overlap" && s != "live")
+        {
+            std::fputs(kUsage, stderr);
+            return 2;
+        }
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(imgui_alloc, imgui_free);
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    io.DisplaySize = ImVec2(opt.width, opt.height);
+    io.DeltaTime = 1.0f / 60.0f;
+#if IMGUI_VERSION_NUM >= 19200
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+#else
+    {
+        unsigned char* px = nullptr;
+        int w = 0, h = 0;
+        io.Fonts->GetTexDataAsRGBA32(&px, &w, &h);
+    }
+#endif
+    selfprof::setThreadName("bench");
+    selfprof::setEnabled(opt.zones);
+
+    std::printf("render_bench: %llu events per shape, %.0fx%.0f, %s boxes\n", (unsigned long long)opt.events,
+        double(opt.width), double(opt.height), opt.gpuBoxes ? "instanced" : "ImDrawList");
+
+    nlohmann::json results = nlohmann::json::object();
+    {
+        ViewerApp app;
+        for (const std::string& shape : shapes)
+        {
+            std::mt19937 rng(opt.seed);
+            auto t0 = std::chrono::steady_clock::now();
+            std::vector<Event> events;
+            std::vector<Step> steps;
+            std::vector<Event> live;
+            if (shape == "flat")
+                events = gen_sequential(opt.events, 8, rng);
+            else if (shape == "categories")
+                events = gen_sequential(opt.events, 2000, rng);
+            else if (shape == "overlap")
+                events = gen_overlap(opt.events, 16, rng);
+            else
+            {
+                // 4 sources x 32 categories, one time ordered stream appended over 240 frames
+                live = gen_sequential(opt.events, 128, rng);
+                for (size_t i = 0; i < live.size(); ++i)
+                    live[i].source = uint16_t(1 + (i % 128) / 32);
+                std::stable_sort(live.begin(), live.end(), [](const Event& a, const Event& b) { return a.ts < b.ts; });
+            }
+            const double genMs = ms_since(t0);
+
+            t0 = std::chrono::steady_clock::now();
+            if (shape == "live")
+            {
+                app.benchLoad({});
+                constexpr size_t kFrames = 240;
+                const size_t per = (live.size() + kFrames - 1) / kFrames;
+                ViewerApp::BenchView v;
+                v.gpuBoxes = opt.gpuBoxes;
+                for (size_t i = 0; i < kFrames; ++i)
+                {
+                    // fit while the session is short, then follow the tail at 20x
+                    if (i >= kFrames / 4) { v.zoom = 20.f; v.offset = 1.0 - 1.0 / v.zoom; }
+                    steps.push_back({ i < kFrames / 4 ? "ingest-fit" : "ingest-tail", v, per });
+                }
+                for (Step& s : script_static(opt.gpuBoxes))
+                    steps.push_back({ s.phase, s.view, 0 });
+            }
+            else
+            {
+                app.benchLoad(std::move(events));
+                steps = script_static(opt.gpuBoxes);
+            }
+            const double loadMs = ms_since(t0);
+            std::printf("%s: generated in %.0f ms, loaded in %.0f ms\n", shape.c_str(), genMs, loadMs);
+
+            // first frame of the context (font atlas, window creation) is not part of any phase
+            if (shape == shapes.front())
+            {
+                int vtx = 0;
+                run_frame(app, ViewerApp::BenchView{}, vtx);
+            }
+
+            std::vector<std::pair<std::string, PhaseStats>> phases;
+            run_steps(app, steps, shape == "live" ? &live : nullptr, opt.zones, phases);
+            for (const auto& [phase, ps] : phases)
+            {
+                print_phase(phase, ps, opt.zones);
+                results[shape + "/" + phase] = {
+                    { "frames", ps.ms.size() },
+                    { "mean_ms", ps.mean() },
+                    { "p50_ms", ps.percentile(0.5) },
+                    { "p95_ms", ps.percentile(0.95) },
+                    { "vertices_max", ps.maxVertices() },
+                    { "allocs_per_frame", ps.allocsPerFrame() },
+                };
+            }
+        }
+    }
+    ImGui::DestroyContext();
+
+    if (!opt.json.empty())
+    {
+        std::ofstream f(opt.json, std::ios::binary);
+        f << results.dump(2) << "\n";
+        if (!f)
+        {
+            std::fprintf(stderr, "Unable to write %s\n", opt.json.c_str());
+            return 2;
+        }
+    }
+
+    // regression gate
+    if (!opt.baseline.empty())
+    {
+        std::ifstream f(opt.baseline, std::ios::binary);
+        nlohmann::json base = nlohmann::json::parse(f, nullptr, false);
+        if (base.is_discarded() || !base.is_object())
+        {
+            std::fprintf(stderr, "Unable to read baseline %s\n", opt.baseline.c_str());
+            return 2;
+        }
+        int regressions = 0;
+        // absolute slack: timer noise on sub-millisecond frames, a stray allocation
+        const auto check = [&](const std::string& key, const char* field, double slack) {
+            const double was = base[key].value(field, 0.0), now = results[key].value(field, 0.0);
+            if (now > was * (1.0 + opt.tolerance) + slack)
+            {
+                std::printf("REGRESSION %-24s %-16s %10.3f -> %10.3f\n", key.c_str(), field, was, now);
+                ++regressions;
+            }
+        };
+        for (auto it = results.begin(); it != results.end(); ++it)
+        {
+            if (!base.contains(it.key())) continue;
+            check(it.key(), "p95_ms", 0.05);
+            check(it.key(), "vertices_max", 0.0);
+            check(it.key(), "allocs_per_frame", 1.0);
+        }
+        std::printf("baseline %s: %d regression%s (tolerance %.0f %%)\n", opt.baseline.c_str(), regressions,
+            regressions == 1 ? "" : "s", opt.tolerance * 100.0);
+        return regressions ? 1 : 0;
+    }
+    return 0;
+}
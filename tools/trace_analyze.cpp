@@ -0,0 +1,10 @@
+// Headless batch analysis without GLFW / OpenGL (build servers, regression jobs):
+// same as `trace_viewer --headless`, see src/headless.hpp for the options and outputs.
+//
+// usage: trace_analyze [--out DIR] [--jobs N] [--top N] [--min-dur US] [--format json|csv|both] <file|dir>...
+#include "headless.hpp"
+
+int main(int argc, char** argv)
+{
+    return run_headless(argc - 1, argv + 1);
+}
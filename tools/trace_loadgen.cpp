@@ -0,0 +1,454 @@
+// Load generator for the live ingest path (loopback, no instrumented service needed).
+// Speaks the same protocol as trace_sender (OFFER / PING-PONG with clock stamps, framed
+// bin1 or JSON batches) with a configurable load:
+//   --rate N          mean events / s
+//   --shape S         constant | square (bursts at rate / duty during duty * period)
+//                     | ramp (0 -> 2 * rate over --duration, finds the saturation point)
+//                     | sine (rate +- rate around the mean over --period)
+//   --period S --duty F
+//   --payload N       bytes of "data" per event
+//   --cats N --names N  distinct categories / names (kind cardinality = cats * names)
+//   --loss P          drop a fraction P of the datagrams (injected loss)
+//   --duration S      stop S seconds after the first client (0 = run until Ctrl+C)
+//   --report FILE     what was sent, as JSON, to compare with the viewer ingest export
+// The run starts on the first PING; totals are printed every second and on exit.
+//
+// usage: trace_loadgen [--port 9000] [--name loadgen] [--rate 100000] [--shape constant]
+//                      [--period 1] [--duty 0.2] [--payload 16] [--cats 8] [--names 32]
+//                      [--loss 0] [--duration 0] [--batch 32768] [--datagram 61440]
+//                      [--json] [--report FILE]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX 1
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+using socket_t = SOCKET;
+using socklen_t = int;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+#endif
+
+#include "framing.hpp"
+#include "wire_binary.hpp"
+
+namespace
+{
+    enum class Shape { Constant, Square, Ramp, Sine };
+
+    /// @brief Options — class/struct documentation.
+    struct Options
+    {
+        uint16_t port = 9000;
+        std::string name = "loadgen";
+        double rate = 100000.0;        // mean events / s
+        Shape shape = Shape::Constant;
+        double period = 1.0;           // s (square / sine)
+        double duty = 0.2;             // square: fraction of the period at peak
+        size_t payload = 16;           // data bytes per event
+        unsigned cats = 8;
+        unsigned names = 32;
+        double loss = 0.0;             // injected datagram loss
+        double duration = 0.0;         // s, 0 = until interrupted
+        size_t batch = 32 * 1024;
+        size_t datagram = framing::kDefaultDatagram;
+        bool json = false;
+        std::string report;
+    };
+
+    /// @brief Totals — class/struct documentation.
+    struct Totals
+    {
+        uint64_t events = 0;
+        uint64_t metrics = 0;
+        uint64_t messages = 0;
+        uint64_t datagrams = 0;        // put on the wire
+        uint64_t bytes = 0;
+        uint64_t droppedDatagrams = 0; // injected
+        uint64_t lostMessages = 0;     // messages with at least one dropped fragment
+        uint64_t lostEvents = 0;       // events of those messages (never reach the viewer)
+    };
+
+    volatile std::sig_atomic_t g_stop = 0;
+    void on_signal(int) { g_stop = 1; }
+
+    uint64_t now_us()
+    {
+        using namespace std::chrono;
+        return uint64_t(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+    }
+
+    void set_nonblock(socket_t s)
+    {
+#ifdef _WIN32
+        u_long m = 1; ioctlsocket(s, FIONBIO, &m);
+#else
+        int fl = fcntl(s, F_GETFL, 0); if (fl < 0) fl = 0; fcntl(s, F_SETFL, fl | O_NONBLOCK);
+#endif
+    }
+
+    const char* shape_name(Shape s)
+    {
+        switch (s)
+        {
+        case Shape::Square: return "square";
+        case Shape::Ramp: return "ramp";
+        case Shape::Sine: return "sine";
+        default: return "constant";
+        }
+    }
+
+    bool parse_args(int argc, char** argv, Options& o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view a = argv[i];
+            auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+            const char* v = nullptr;
+            if (a == "--json") o.json = true;
+            else if (a == "--port" && (v = next())) o.port = uint16_t(std::atoi(v));
+            else if (a == "--name" && (v = next())) o.name = v;
+            else if (a == "--rate" && (v = next())) o.rate = std::atof(v);
+            else if (a == "--period" && (v = next())) o.period = std::max(0.001, std::atof(v));
+            else if (a == "--duty" && (v = next())) o.duty = std::clamp(std::atof(v), 0.01, 1.0);
+            else if (a == "--payload" && (v = next())) o.payload = size_t(std::atoll(v));
+            else if (a == "--cats" && (v = next())) o.cats = unsigned(std::max(1, std::atoi(v)));
+            else if (a == "--names" && (v = next())) o.names = unsigned(std::max(1, std::atoi(v)));
+            else if (a == "--loss" && (v = next())) o.loss = std::clamp(std::atof(v), 0.0, 1.0);
+            else if (a == "--duration" && (v = next())) o.duration = std::atof(v);
+            else if (a == "--batch" && (v = next())) o.batch = size_t(std::atoll(v));
+            else if (a == "--datagram" && (v = next())) o.datagram = size_t(std::atoll(v));
+            else if (a == "--report" && (v = next())) o.report = v;
+            else if (a == "--shape" && (v = next()))
+            {
+                const std::string_view s = v;
+                if (s == "constant") o.shape = Shape::Constant;
+                else if (s == "square") o.shape = Shape::Square;
+                else if (s == "ramp") o.shape = Shape::Ramp;
+                else if (s == "sine") o.shape = Shape::Sine;
+                else { std::fprintf(stderr, "unknown shape '%s'\n", v); return false; }
+            }
+            else
+            {
+                std::fprintf(stderr, "usage: trace_loadgen [--port N] [--name S] [--rate EV_PER_S] [--shape constant|square|ramp|sine]\n"
+                                     "                     [--period S] [--duty F] [--payload BYTES] [--cats N] [--names N] [--loss P]\n"
+                                     "                     [--duration S] [--batch BYTES] [--datagram BYTES] [--json] [--report FILE]\n");
+                return false;
+            }
+        }
+        if (o.shape == Shape::Ramp && o.duration <= 0.0)
+        {
+            std::fprintf(stderr, "--shape ramp needs --duration\n");
+            return false;
+        }
+        return true;
+    }
+
+    // instantaneous target rate (events / s) at t seconds into the run
+    double rate_at(const Options& o, double t)
+    {
+        switch (o.shape)
+        {
+        case Shape::Square: return std::fmod(t, o.period) < o.duty * o.period ? o.rate / o.duty : 0.0;
+        case Shape::Ramp: return 2.0 * o.rate * std::min(1.0, t / o.duration);
+        case Shape::Sine: return o.rate * (1.0 + std::sin(2.0 * 3.14159265358979 * t / o.period));
+        default: return o.rate;
+        }
+    }
+
+    void print_totals(const Totals& t, double seconds, double rate)
+    {
+        std::printf("%7.1fs  target %9.0f ev/s | sent %llu events (%.0f/s), %llu datagrams, %.1f MB | injected loss %llu datagrams, %llu events\n",
+            seconds, rate, (unsigned long long)t.events, seconds > 0.0 ? double(t.events) / seconds : 0.0, (unsigned long long)t.datagrams,
+            double(t.bytes) / (1024.0 * 1024.0), (unsigned long long)t.droppedDatagrams, (unsigned long long)t.lostEvents);
+        std::fflush(stdout);
+    }
+
+    bool write_report(const std::string& path, const Options& o, const Totals& t, double seconds, bool binary)
+    {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        std::fprintf(f,
+            "{\n"
+            "  \"generator\": \"trace_loadgen\",\n"
+            "  \"encoding\": \"%s\",\n"
+            "  \"shape\": \"%s\",\n"
+            "  \"rate\": %.1f,\n"
+            "  \"payload_bytes\": %zu,\n"
+            "  \"kinds\": %u,\n"
+            "  \"loss\": %.4f,\n"
+            "  \"seconds\": %.3f,\n"
+            "  \"events\": %llu,\n"
+            "  \"metrics\": %llu,\n"
+            "  \"messages\": %llu,\n"
+            "  \"datagrams\": %llu,\n"
+            "  \"bytes\": %llu,\n"
+            "  \"dropped_datagrams\": %llu,\n"
+            "  \"lost_messages\": %llu,\n"
+            "  \"lost_events\": %llu,\n"
+            "  \"delivered_events\": %llu,\n"
+            "  \"events_per_s\": %.1f\n"
+            "}\n",
+            binary ? "bin1" : "json", shape_name(o.shape), o.rate, o.payload, o.cats * o.names, o.loss, seconds,
+            (unsigned long long)t.events, (unsigned long long)t.metrics, (unsigned long long)t.messages,
+            (unsigned long long)t.datagrams, (unsigned long long)t.bytes, (unsigned long long)t.droppedDatagrams,
+            (unsigned long long)t.lostMessages, (unsigned long long)t.lostEvents,
+            (unsigned long long)(t.events - t.lostEvents), seconds > 0.0 ? double(t.events) / seconds : 0.0);
+        std::fclose(f);
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parse_args(argc, argv, opt))
+        return 1;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+#ifdef _WIN32
+    WSADATA w{};
+    if (WSAStartup(MAKEWORD(2, 2), &w) != 0) return 1;
+#endif
+    socket_t s = ::socket(AF_INET, SOCK_DGRAM, 0);
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char*)&yes, sizeof(yes));
+    int sndbuf = 8 << 20;
+    setsockopt(s, SOL_SOCKET, SO_SNDBUF, (char*)&sndbuf, sizeof(sndbuf));
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(opt.port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(s, (sockaddr*)&local, sizeof(local)) < 0)
+    {
+        std::perror("bind");
+        return 1;
+    }
+    set_nonblock(s);
+    std::printf("trace_loadgen '%s' on udp/%u: %s %.0f ev/s, %zu B payload, %u kinds, %.2f%% loss\n", opt.name.c_str(), opt.port,
+        shape_name(opt.shape), opt.rate, opt.payload, opt.cats * opt.names, opt.loss * 100.0);
+
+    std::mt19937_64 rng{ std::random_device{}() };
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    const uint32_t session = uint32_t(rng());
+
+    // kind table and payload, built once
+    std::vector<std::string> cats, names;
+    for (unsigned i = 0; i < opt.cats; ++i) cats.push_back("cat" + std::to_string(i));
+    for (unsigned i = 0; i < opt.names; ++i) names.push_back("op" + std::to_string(i));
+    static const char* kColors[] = { "", "#3B82F6", "#10B981", "#F59E0B", "#EF4444" };
+    std::string payload(opt.payload, 'x');
+    for (size_t i = 0; i < payload.size(); ++i) payload[i] = char('a' + i % 26);
+
+    bool haveClient = false, binary = false, running = false;
+    sockaddr_in client{};
+    uint64_t lastPingUs = 0;
+    uint32_t seq = 0;
+    Totals tot;
+
+    wire::Encoder enc{ session };
+    std::string json;
+    size_t pending = 0, pendingEvents = 0;
+    auto begin_batch = [&] {
+        pending = 0;
+        pendingEvents = 0;
+        if (binary) enc.begin();
+        else json = "[";
+    };
+    auto flush = [&] {
+        if (!pending) return;
+        std::string_view msg;
+        if (binary) msg = enc.finish();
+        else { json.back() = ']'; msg = json; }
+        bool lost = false;
+        framing::fragment(session, seq++, msg, opt.datagram, [&](const char* p, size_t n) {
+            if (opt.loss > 0.0 && uni(rng) < opt.loss)
+            {
+                ++tot.droppedDatagrams;
+                lost = true;
+                return;
+            }
+            sendto(s, p, (int)n, 0, (sockaddr*)&client, sizeof(client));
+            tot.bytes += n;
+            ++tot.datagrams;
+        });
+        ++tot.messages;
+        if (lost)
+        {
+            ++tot.lostMessages;
+            tot.lostEvents += pendingEvents;
+        }
+        begin_batch();
+    };
+    begin_batch();
+
+    using clock = std::chrono::steady_clock;
+    clock::time_point start{}, last = clock::now(), lastReport = last, lastFlush = last;
+    uint64_t lastMetricUs = 0;
+    double carry = 0.0, curRate = 0.0;
+    while (!g_stop)
+    {
+        // ---- control ----
+        char buf[2048];
+        sockaddr_in from{}; socklen_t fl = sizeof(from);
+        int r;
+        while ((r = recvfrom(s, buf, (int)sizeof(buf) - 1, 0, (sockaddr*)&from, &fl)) > 0)
+        {
+            const uint64_t rxUs = now_us();
+            buf[r] = '\0';
+            std::string_view m(buf, size_t(r));
+            if (m.starts_with("DISCOVER_DEMO"))
+            {
+                // --name is of any length
+                std::string offer = "OFFER port=" + std::to_string(opt.port) + " name=" + opt.name;
+                if (!opt.json) offer += " proto=bin1";
+                sendto(s, offer.data(), (int)offer.size(), 0, (sockaddr*)&from, fl);
+            }
+            else if (m.starts_with("PING"))
+            {
+                const bool wantBin = !opt.json && m.find(wire::kProtoTag) != std::string_view::npos;
+                if (!haveClient || wantBin != binary)
+                {
+                    flush();   // the batch was counted in tot.events, send it in the old encoding
+                    binary = wantBin;
+                    begin_batch();
+                    std::printf("client %s:%u (%s)\n", inet_ntoa(from.sin_addr), ntohs(from.sin_port), binary ? "bin1" : "json");
+                }
+                if (!running)
+                {
+                    running = true;
+                    start = last = lastReport = clock::now();
+                }
+                haveClient = true;
+                client = from;
+                lastPingUs = now_us();
+                unsigned ping = 0;
+                std::sscanf(buf + 4, "%u", &ping);
+                char pong[128];
+                const int n = std::snprintf(pong, sizeof(pong), "PONG %u%s t2=%llu t3=%llu", ping, binary ? " proto=bin1" : "",
+                    (unsigned long long)rxUs, (unsigned long long)now_us());
+                sendto(s, pong, n, 0, (sockaddr*)&from, fl);
+            }
+            fl = sizeof(from);
+        }
+        if (haveClient && now_us() - lastPingUs > 5'000'000)
+        {
+            std::printf("client timed out\n");
+            haveClient = false;
+        }
+
+        // ---- stream ----
+        const auto now = clock::now();
+        const double dt = std::chrono::duration<double>(now - last).count();
+        last = now;
+        const double elapsed = running ? std::chrono::duration<double>(now - start).count() : 0.0;
+        if (running && opt.duration > 0.0 && elapsed >= opt.duration)
+            break;
+        if (haveClient)
+        {
+            curRate = rate_at(opt, elapsed);
+            carry += dt * curRate;
+            const uint64_t t = now_us();
+            while (carry >= 1.0)
+            {
+                carry -= 1.0;
+                const uint64_t k = rng();
+                const size_t c = size_t(k % opt.cats), n = size_t((k >> 20) % opt.names);
+                const uint64_t dur = 1 + (k >> 40) % 2000;
+                const uint64_t ts = t - dur - (k >> 52) % 1000;
+                const char* color = kColors[c % 5];
+                if (binary)
+                    enc.event(names[n], cats[c], ts, dur, payload, color, 1, uint32_t(c));
+                else
+                {
+                    char head[192];
+                    std::snprintf(head, sizeof(head), "{\"type\":\"event\",\"name\":\"%s\",\"cat\":\"%s\",\"ts\":%llu,\"dur\":%llu,\"tid\":%u,\"color\":\"%s\",\"data\":\"",
+                        names[n].c_str(), cats[c].c_str(), (unsigned long long)ts, (unsigned long long)dur, unsigned(c), color);
+                    json += head;
+                    json += payload;
+                    json += "\"},";
+                }
+                ++pending;
+                ++pendingEvents;
+                ++tot.events;
+                if ((binary ? enc.size() : json.size()) >= opt.batch)
+                    flush();
+            }
+            if (t - lastMetricUs >= 100'000)
+            {
+                lastMetricUs = t;
+                const float cpu = float(10 + rng() % 60);
+                if (binary)
+                    enc.metric(t, cpu, cpu * 0.5f, (4ull << 30) + rng() % (1ull << 30), 16ull << 30);
+                else
+                {
+                    char m[192];
+                    std::snprintf(m, sizeof(m), "{\"type\":\"metric\",\"ts\":%llu,\"cpu\":%.1f,\"cpu_total\":%.1f,\"ram_used\":%llu,\"ram_total\":%llu},",
+                        (unsigned long long)t, cpu, cpu * 0.5f, (unsigned long long)((4ull << 30) + rng() % (1ull << 30)), (unsigned long long)(16ull << 30));
+                    json += m;
+                }
+                ++pending;
+                ++tot.metrics;
+            }
+            // partial batches leave every 10 ms
+            if (now - lastFlush >= std::chrono::milliseconds(10))
+            {
+                lastFlush = now;
+                flush();
+            }
+        }
+        else
+            carry = 0.0;
+        if (running && now - lastReport >= std::chrono::seconds(1))
+        {
+            lastReport = now;
+            print_totals(tot, elapsed, curRate);
+        }
+        // wake up on a PING right away (t2 stamp), otherwise pace the stream at ~1 ms
+        fd_set rd;
+        FD_ZERO(&rd);
+        FD_SET(s, &rd);
+        timeval tv{ 0, 1000 };
+        select((int)s + 1, &rd, nullptr, nullptr, &tv);
+    }
+
+    if (haveClient) flush();
+    const double seconds = running ? std::chrono::duration<double>(clock::now() - start).count() : 0.0;
+    std::printf("done\n");
+    print_totals(tot, seconds, curRate);
+    if (!opt.report.empty())
+    {
+        if (write_report(opt.report, opt, tot, seconds, binary)) std::printf("report: %s\n", opt.report.c_str());
+        else std::fprintf(stderr, "unable to write %s\n", opt.report.c_str());
+    }
+#ifdef _WIN32
+    closesocket(s);
+    WSACleanup();
+#else
+    close(s);
+#endif
+    return 0;
+}
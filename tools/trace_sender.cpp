@@ -0,0 +1,307 @@
+// Stand-in live producer for trace_viewer.
+// Answers the discovery broadcast (OFFER ... proto=bin1), the PING keepalive (PONG, with
+// the negotiated encoding and the t2/t3 clock stamps) and streams synthetic events + metrics
+// to the connected viewer, batched and framed (framing.hpp), as bin1 (wire_binary.hpp) or JSON.
+// --skew shifts this process clock (us) to exercise the viewer clock alignment.
+// --shm also publishes a shared memory ring (shm_ring.hpp); a viewer on the same host
+// maps it and the events stop going through UDP.
+//
+// usage: trace_sender [--port 9000] [--name demo] [--rate 20000] [--batch 32768]
+//                     [--datagram 61440] [--json] [--skew 0] [--shm]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX 1
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+using socket_t = SOCKET;
+using socklen_t = int;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+#endif
+
+#include "framing.hpp"
+#include "shm_ring.hpp"
+#include "wire_binary.hpp"
+
+namespace
+{
+    /// @brief Options — class/struct documentation.
+    struct Options
+    {
+        uint16_t port = 9000;
+        std::string name = "trace_sender";
+        double rate = 20000.0;         // events / s
+        size_t batch = 32 * 1024;      // message size before flush
+        size_t datagram = framing::kDefaultDatagram;
+        bool json = false;             // never switch to bin1
+        int64_t skew = 0;              // us added to every timestamp
+        bool shm = false;              // offer the shared memory ring
+    };
+
+    int64_t g_skew = 0;
+
+    uint64_t now_us()
+    {
+        using namespace std::chrono;
+        return uint64_t(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count() + g_skew);
+    }
+
+    void set_nonblock(socket_t s)
+    {
+#ifdef _WIN32
+        u_long m = 1; ioctlsocket(s, FIONBIO, &m);
+#else
+        int fl = fcntl(s, F_GETFL, 0); if (fl < 0) fl = 0; fcntl(s, F_SETFL, fl | O_NONBLOCK);
+#endif
+    }
+
+    bool parse_args(int argc, char** argv, Options& o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view a = argv[i];
+            auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+            const char* v = nullptr;
+            if (a == "--json") o.json = true;
+            else if (a == "--shm") o.shm = true;
+            else if (a == "--port" && (v = next())) o.port = uint16_t(std::atoi(v));
+            else if (a == "--name" && (v = next())) o.name = v;
+            else if (a == "--rate" && (v = next())) o.rate = std::atof(v);
+            else if (a == "--batch" && (v = next())) o.batch = size_t(std::atoll(v));
+            else if (a == "--datagram" && (v = next())) o.datagram = size_t(std::atoll(v));
+            else if (a == "--skew" && (v = next())) o.skew = std::atoll(v);
+            else
+            {
+                std::fprintf(stderr, "usage: trace_sender [--port N] [--name S] [--rate EV_PER_S] [--batch BYTES] [--datagram BYTES] [--json] [--skew US] [--shm]\n");
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parse_args(argc, argv, opt))
+        return 1;
+    g_skew = opt.skew;
+
+#ifdef _WIN32
+    WSADATA w{};
+    if (WSAStartup(MAKEWORD(2, 2), &w) != 0) return 1;
+#endif
+    socket_t s = ::socket(AF_INET, SOCK_DGRAM, 0);
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char*)&yes, sizeof(yes));
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(opt.port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(s, (sockaddr*)&local, sizeof(local)) < 0)
+    {
+        std::perror("bind");
+        return 1;
+    }
+    set_nonblock(s);
+    std::printf("trace_sender '%s' on udp/%u (%s)\n", opt.name.c_str(), opt.port, opt.json ? "json" : "bin1 when asked");
+
+    std::mt19937_64 rng{ std::random_device{}() };
+    const uint32_t session = uint32_t(rng());
+    static const char* kCats[] = { "net", "db", "render", "io", "job" };
+    static const char* kNames[] = { "recv", "send", "query", "commit", "draw", "present", "read", "write", "run", "wait" };
+    static const char* kColors[] = { "", "#3B82F6", "#10B981", "#F59E0B", "#EF4444" };
+
+    ShmRingProducer ring;
+    uint32_t ringNames[10], ringCats[5], ringColors[5], ringData = 0;
+    if (opt.shm)
+    {
+        std::string err;
+        if (!ring.create("/trace_sender_" + std::to_string(opt.port), session, shm::kDefaultCapacity, shm::kDefaultHeap, &err))
+            std::fprintf(stderr, "%s (UDP only)\n", err.c_str());
+        else
+        {
+            // the heap is bounded: only low cardinality strings go through the ring
+            for (int i = 0; i < 10; ++i) ringNames[i] = ring.intern(kNames[i]);
+            for (int i = 0; i < 5; ++i) { ringCats[i] = ring.intern(kCats[i]); ringColors[i] = ring.intern(kColors[i]); }
+            ringData = ring.intern("via=shm");
+            std::printf("shared memory ring %s\n", ring.name().c_str());
+        }
+    }
+
+    bool haveClient = false, binary = false, shmClient = false;
+    sockaddr_in client{};
+    uint64_t lastPingUs = 0;
+    uint32_t seq = 0;
+    uint64_t sentEvents = 0, sentBytes = 0, sentDatagrams = 0;
+
+    wire::Encoder enc{ session };
+    std::string json;
+    size_t pending = 0;
+    auto begin_batch = [&] {
+        pending = 0;
+        if (binary) enc.begin();
+        else json = "[";
+    };
+    auto flush = [&] {
+        if (!pending) return;
+        std::string_view msg;
+        if (binary) msg = enc.finish();
+        else { json.back() = ']'; msg = json; }
+        framing::fragment(session, seq++, msg, opt.datagram, [&](const char* p, size_t n) {
+            sendto(s, p, (int)n, 0, (sockaddr*)&client, sizeof(client));
+            sentBytes += n;
+            ++sentDatagrams;
+        });
+        begin_batch();
+    };
+    begin_batch();
+
+    auto last = std::chrono::steady_clock::now();
+    auto lastReport = last;
+    auto lastFlush = last;
+    uint64_t lastMetricUs = 0;
+    double carry = 0.0;
+    for (;;)
+    {
+        // ---- control ----
+        char buf[2048];
+        sockaddr_in from{}; socklen_t fl = sizeof(from);
+        int r;
+        while ((r = recvfrom(s, buf, (int)sizeof(buf) - 1, 0, (sockaddr*)&from, &fl)) > 0)
+        {
+            const uint64_t rxUs = now_us();
+            buf[r] = '\0';
+            std::string_view m(buf, size_t(r));
+            if (m.starts_with("DISCOVER_DEMO"))
+            {
+                // --name / the shm name are of any length
+                std::string offer = "OFFER port=" + std::to_string(opt.port) + " name=" + opt.name;
+                if (!opt.json) offer += " proto=bin1";
+                if (ring.open()) offer += " shm=" + ring.name();
+                sendto(s, offer.data(), (int)offer.size(), 0, (sockaddr*)&from, fl);
+            }
+            else if (m.starts_with("PING"))
+            {
+                const bool wantBin = !opt.json && m.find(wire::kProtoTag) != std::string_view::npos;
+                const bool wantShm = ring.open() && m.find("shm=1") != std::string_view::npos;
+                if (!haveClient || wantBin != binary || wantShm != shmClient)
+                {
+                    pending = 0;
+                    binary = wantBin;
+                    shmClient = wantShm;
+                    begin_batch();
+                    std::printf("client %s:%u (%s)\n", inet_ntoa(from.sin_addr), ntohs(from.sin_port), shmClient ? "shm" : binary ? "bin1" : "json");
+                }
+                haveClient = true;
+                client = from;
+                lastPingUs = now_us();
+                unsigned ping = 0;
+                std::sscanf(buf + 4, "%u", &ping);
+                char pong[128];
+                const int n = std::snprintf(pong, sizeof(pong), "PONG %u%s t2=%llu t3=%llu", ping, binary ? " proto=bin1" : "",
+                    (unsigned long long)rxUs, (unsigned long long)now_us());
+                sendto(s, pong, n, 0, (sockaddr*)&from, fl);
+            }
+            fl = sizeof(from);
+        }
+        if (haveClient && now_us() - lastPingUs > 5'000'000)
+        {
+            std::printf("client timed out\n");
+            haveClient = false;
+        }
+
+        // ---- stream ----
+        const auto now = std::chrono::steady_clock::now();
+        const double dt = std::chrono::duration<double>(now - last).count();
+        last = now;
+        if (haveClient)
+        {
+            carry += dt * opt.rate;
+            const uint64_t t = now_us();
+            const bool viaRing = shmClient && ring.consumerAttached(t - g_skew);
+            while (carry >= 1.0)
+            {
+                carry -= 1.0;
+                const size_t c = size_t(rng() % 5), n = size_t(rng() % 10);
+                const uint64_t dur = 5 + rng() % 2000;
+                const uint64_t ts = t - dur - rng() % 1000;
+                if (viaRing)
+                {
+                    ring.event(ringNames[n], ringCats[c], ts, dur, ringData, ringColors[c], 1, uint32_t(c));
+                    ++sentEvents;
+                    continue;
+                }
+                char data[48];
+                std::snprintf(data, sizeof(data), "iter=%llu", (unsigned long long)sentEvents);
+                if (binary)
+                    enc.event(kNames[n], kCats[c], ts, dur, data, kColors[c], 1, uint32_t(c));
+                else
+                {
+                    char ev[256];
+                    std::snprintf(ev, sizeof(ev), "{\"type\":\"event\",\"name\":\"%s\",\"cat\":\"%s\",\"ts\":%llu,\"dur\":%llu,\"data\":\"%s\",\"color\":\"%s\"},",
+                        kNames[n], kCats[c], (unsigned long long)ts, (unsigned long long)dur, data, kColors[c]);
+                    json += ev;
+                }
+                ++pending;
+                ++sentEvents;
+                if ((binary ? enc.size() : json.size()) >= opt.batch)
+                    flush();
+            }
+            if (t - lastMetricUs >= 100'000)
+            {
+                lastMetricUs = t;
+                const float cpu = float(10 + rng() % 60);
+                if (viaRing)
+                    ring.metric(t, cpu, cpu * 0.5f, (4ull << 30) + rng() % (1ull << 30), 16ull << 30);
+                else if (binary)
+                    enc.metric(t, cpu, cpu * 0.5f, (4ull << 30) + rng() % (1ull << 30), 16ull << 30);
+                else
+                {
+                    char m[192];
+                    std::snprintf(m, sizeof(m), "{\"type\":\"metric\",\"ts\":%llu,\"cpu\":%.1f,\"cpu_total\":%.1f,\"ram_used\":%llu,\"ram_total\":%llu},",
+                        (unsigned long long)t, cpu, cpu * 0.5f, (unsigned long long)((4ull << 30) + rng() % (1ull << 30)), (unsigned long long)(16ull << 30));
+                    json += m;
+                }
+                ++pending;
+            }
+            // partial batches leave every 10 ms
+            if (now - lastFlush >= std::chrono::milliseconds(10))
+            {
+                lastFlush = now;
+                flush();
+            }
+        }
+        if (now - lastReport >= std::chrono::seconds(5))
+        {
+            lastReport = now;
+            std::printf("%llu events, %llu datagrams, %.1f MB\n", (unsigned long long)sentEvents,
+                (unsigned long long)sentDatagrams, double(sentBytes) / (1024.0 * 1024.0));
+        }
+        // wake up on a PING right away (t2 stamp), otherwise pace the stream at ~1 ms
+        fd_set rd;
+        FD_ZERO(&rd);
+        FD_SET(s, &rd);
+        timeval tv{ 0, 1000 };
+        select((int)s + 1, &rd, nullptr, nullptr, &tv);
+    }
+}
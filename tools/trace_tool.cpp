@@ -0,0 +1,545 @@
+// Offline trace processing in bounded memory (files much larger than RAM):
+//   info    IN                  record counts, time range, ordering
+//   convert IN OUT              JSON <-> binary (trace_stream.hpp), format from --format or OUT extension
+//   slice   IN OUT --from --to  events overlapping [from, to), metrics inside it
+//   filter  IN OUT [filters]    see below
+//   merge   OUT IN...           k-way merge by timestamp
+// Every command but info accepts the time range and the filters:
+//   --cat S / --name S          keep these categories / names (repeatable)
+//   --min-dur US / --max-dur US
+//   --where EXPR                FIELD OP VALUE, OP in = != < <= > >= ~ (regex), repeatable (ANDed)
+//                               event fields: name cat data color ts dur end pid tid id
+//                               metric fields: ts cpu cpu_total ram_used ram_total
+//                               (a predicate on a field the record has not keeps the record)
+//   --no-events / --no-metrics
+// merge sorts each input through a reorder window (--window records, default 65536): inputs
+// only need to be roughly sorted; records later than the window are still written and counted.
+//
+// usage: trace_tool <command> [options] <files>...
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "kway_merge.hpp"
+#include "trace_stream.hpp"
+
+namespace
+{
+    using trace_stream::Format;
+    using trace_stream::Record;
+
+    constexpr size_t kBatch = 4096;
+
+    // =============== Predicates ===============
+    enum class Field { Name, Cat, Data, Color, Ts, Dur, End, Pid, Tid, Id, Cpu, CpuTotal, RamUsed, RamTotal };
+    enum class Op { Eq, Ne, Lt, Le, Gt, Ge, Match };
+
+    /// @brief Predicate — class/struct documentation.
+    struct Predicate
+    {
+        Field field = Field::Name;
+        Op op = Op::Eq;
+        std::string text;
+        uint64_t integer = 0;
+        double real = 0.0;
+        std::regex re;
+    };
+
+    bool is_text(Field f) { return f == Field::Name || f == Field::Cat || f == Field::Data || f == Field::Color; }
+    bool is_metric_field(Field f) { return f == Field::Cpu || f == Field::CpuTotal || f == Field::RamUsed || f == Field::RamTotal; }
+
+    bool parse_predicate(std::string_view expr, Predicate& p, std::string& err)
+    {
+        static constexpr std::pair<std::string_view, Op> kOps[] = {
+            { "!=", Op::Ne }, { "<=", Op::Le }, { ">=", Op::Ge }, { "=", Op::Eq }, { "<", Op::Lt }, { ">", Op::Gt }, { "~", Op::Match } };
+        static constexpr std::pair<std::string_view, Field> kFields[] = {
+            { "name", Field::Name }, { "cat", Field::Cat }, { "data", Field::Data }, { "color", Field::Color },
+            { "ts", Field::Ts }, { "dur", Field::Dur }, { "end", Field::End }, { "pid", Field::Pid }, { "tid", Field::Tid },
+            { "id", Field::Id }, { "cpu", Field::Cpu }, { "cpu_total", Field::CpuTotal }, { "ram_used", Field::RamUsed },
+            { "ram_total", Field::RamTotal } };
+
+        const size_t at = expr.find_first_of("!=<>~");
+        if (at == std::string_view::npos || at == 0)
+        {
+            err = "Expected FIELD OP VALUE: " + std::string(expr);
+            return false;
+        }
+        const std::string_view name = expr.substr(0, at);
+        auto f = std::find_if(std::begin(kFields), std::end(kFields), [&](const auto& k) { return k.first == name; });
+        if (f == std::end(kFields))
+        {
+            err = "Unknown field: " + std::string(name);
+            return false;
+        }
+        auto o = std::find_if(std::begin(kOps), std::end(kOps), [&](const auto& k) { return expr.substr(at).starts_with(k.first); });
+        if (o == std::end(kOps))
+        {
+            err = "Unknown operator in: " + std::string(expr);
+            return false;
+        }
+        p.field = f->second;
+        p.op = o->second;
+        p.text = std::string(expr.substr(at + o->first.size()));
+
+        if (is_text(p.field))
+        {
+            if (p.op != Op::Eq && p.op != Op::Ne && p.op != Op::Match)
+            {
+                err = "Only = != ~ apply to " + std::string(name);
+                return false;
+            }
+            if (p.op == Op::Match)
+            {
+                try { p.re = std::regex(p.text, std::regex::optimize); }
+                catch (const std::regex_error& e) { err = std::string("Bad regex: ") + e.what(); return false; }
+            }
+            return true;
+        }
+        if (p.op == Op::Match)
+        {
+            err = "~ only applies to name cat data color";
+            return false;
+        }
+        char* end = nullptr;
+        p.real = std::strtod(p.text.c_str(), &end);
+        if (p.text.empty() || *end)
+        {
+            err = "Expected a number in: " + std::string(expr);
+            return false;
+        }
+        p.integer = std::strtoull(p.text.c_str(), nullptr, 0);
+        return true;
+    }
+
+    template <class T>
+    bool compare(const T& a, Op op, const T& b)
+    {
+        switch (op)
+        {
+        case Op::Eq: return a == b;
+        case Op::Ne: return a != b;
+        case Op::Lt: return a < b;
+        case Op::Le: return a <= b;
+        case Op::Gt: return a > b;
+        case Op::Ge: return a >= b;
+        default:     return false;
+        }
+    }
+
+    bool test(const Predicate& p, const Record& r)
+    {
+        if (r.isMetric)
+        {
+            const Metric& m = r.metric;
+            switch (p.field)
+            {
+            case Field::Ts:       return compare(m.ts, p.op, p.integer);
+            case Field::Cpu:      return compare(m.cpu, p.op, p.real);
+            case Field::CpuTotal: return compare(m.cpu_total, p.op, p.real);
+            case Field::RamUsed:  return compare(m.ram_used, p.op, p.integer);
+            case Field::RamTotal: return compare(m.ram_total, p.op, p.integer);
+            default:              return true;
+            }
+        }
+        if (is_metric_field(p.field))
+            return true;
+
+        const Event& e = r.event;
+        const std::string* s = nullptr;
+        switch (p.field)
+        {
+        case Field::Name:  s = &e.name; break;
+        case Field::Cat:   s = &e.category; break;
+        case Field::Data:  s = &e.data; break;
+        case Field::Color: s = &e.color; break;
+        case Field::Ts:    return compare(e.ts, p.op, p.integer);
+        case Field::Dur:   return compare(e.dur, p.op, p.integer);
+        case Field::End:   return compare(e.ts + e.dur, p.op, p.integer);
+        case Field::Pid:   return compare(uint64_t(e.pid), p.op, p.integer);
+        case Field::Tid:   return compare(uint64_t(e.tid), p.op, p.integer);
+        case Field::Id:    return compare(e.id, p.op, p.integer);
+        default:           return true;
+        }
+        if (p.op == Op::Match)
+            return std::regex_search(*s, p.re);
+        return compare(*s, p.op, p.text);
+    }
+
+    // =============== Options ===============
+    /// @brief Options — class/struct documentation.
+    struct Options
+    {
+        std::string command;
+        std::vector<std::string> files;
+        std::optional<Format> format;
+        uint64_t from = 0;
+        uint64_t until = UINT64_MAX;
+        std::vector<std::string> cats;
+        std::vector<std::string> names;
+        uint64_t minDur = 0;
+        uint64_t maxDur = UINT64_MAX;
+        std::vector<Predicate> where;
+        bool events = true;
+        bool metrics = true;
+        size_t window = 1 << 16;
+    };
+
+    bool keep(const Options& o, const Record& r)
+    {
+        if (r.isMetric)
+        {
+            if (!o.metrics || r.metric.ts < o.from || r.metric.ts >= o.until)
+                return false;
+        }
+        else
+        {
+            const Event& e = r.event;
+            if (!o.events || e.ts >= o.until || (e.dur ? e.ts + e.dur <= o.from : e.ts < o.from))
+                return false;
+            if (e.dur < o.minDur || e.dur > o.maxDur)
+                return false;
+            if (!o.cats.empty() && std::find(o.cats.begin(), o.cats.end(), e.category) == o.cats.end())
+                return false;
+            if (!o.names.empty() && std::find(o.names.begin(), o.names.end(), e.name) == o.names.end())
+                return false;
+        }
+        for (const Predicate& p : o.where)
+            if (!test(p, r)) return false;
+        return true;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr,
+            "usage: trace_tool info IN\n"
+            "       trace_tool convert|slice|filter IN OUT [options]\n"
+            "       trace_tool merge OUT IN... [--window N] [options]\n"
+            "options: [--format json|bin] [--from US] [--to US] [--cat S]... [--name S]... [--min-dur US] [--max-dur US]\n"
+            "         [--where FIELD<op>VALUE]... [--no-events] [--no-metrics]\n");
+    }
+
+    bool parse_args(int argc, char** argv, Options& o)
+    {
+        if (argc < 2)
+            return false;
+        o.command = argv[1];
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string_view a = argv[i];
+            auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+            const char* v = nullptr;
+            if (a == "--no-events") o.events = false;
+            else if (a == "--no-metrics") o.metrics = false;
+            else if (a == "--format" && (v = next()))
+            {
+                const std::string_view f = v;
+                if (f == "json") o.format = Format::Json;
+                else if (f == "bin") o.format = Format::Binary;
+                else return false;
+            }
+            else if (a == "--from" && (v = next())) o.from = std::strtoull(v, nullptr, 10);
+            else if (a == "--to" && (v = next())) o.until = std::strtoull(v, nullptr, 10);
+            else if (a == "--cat" && (v = next())) o.cats.emplace_back(v);
+            else if (a == "--name" && (v = next())) o.names.emplace_back(v);
+            else if (a == "--min-dur" && (v = next())) o.minDur = std::strtoull(v, nullptr, 10);
+            else if (a == "--max-dur" && (v = next())) o.maxDur = std::strtoull(v, nullptr, 10);
+            else if (a == "--window" && (v = next())) o.window = std::max<size_t>(1, size_t(std::atoll(v)));
+            else if (a == "--where" && (v = next()))
+            {
+                Predicate p;
+                std::string err;
+                if (!parse_predicate(v, p, err))
+                {
+                    std::fprintf(stderr, "%s\n", err.c_str());
+                    return false;
+                }
+                o.where.push_back(std::move(p));
+            }
+            else if (!a.starts_with("--")) o.files.emplace_back(a);
+            else return false;
+        }
+        if (o.command == "info") return o.files.size() == 1;
+        if (o.command == "merge") return o.files.size() >= 2;
+        if (o.command == "convert" || o.command == "filter") return o.files.size() == 2;
+        if (o.command == "slice") return o.files.size() == 2 && (o.from != 0 || o.until != UINT64_MAX);
+        return false;
+    }
+
+    // ---------- Progress / summary ----------
+    /// @brief Totals — class/struct documentation.
+    struct Totals
+    {
+        uint64_t read = 0;
+        uint64_t written = 0;
+        uint64_t late = 0;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    };
+
+    uint64_t input_bytes(const std::vector<std::string>& files)
+    {
+        uint64_t n = 0;
+        std::error_code ec;
+        for (const std::string& f : files)
+        {
+            const auto sz = std::filesystem::file_size(f, ec);
+            if (!ec) n += sz;
+        }
+        return n;
+    }
+
+    void report(const Totals& t, const std::vector<std::string>& inputs)
+    {
+        const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t.t0).count();
+        const double mb = double(input_bytes(inputs)) / (1024.0 * 1024.0);
+        std::fprintf(stderr, "%llu records read, %llu written", (unsigned long long)t.read, (unsigned long long)t.written);
+        if (t.late)
+            std::fprintf(stderr, ", %llu out of the reorder window", (unsigned long long)t.late);
+        std::fprintf(stderr, " in %.2f s (%.1f MB/s)\n", s, s > 0 ? mb / s : 0.0);
+    }
+
+    std::unique_ptr<trace_stream::Writer> open_output(const Options& o, const std::string& path)
+    {
+        Format fmt = Format::Binary;
+        if (o.format) fmt = *o.format;
+        else if (!trace_stream::format_from_extension(path, fmt))
+        {
+            std::fprintf(stderr, "%s: unknown output format, use --format json|bin\n", path.c_str());
+            return nullptr;
+        }
+        std::string err;
+        auto w = trace_stream::open_writer(path, fmt, &err);
+        if (!w) std::fprintf(stderr, "%s\n", err.c_str());
+        return w;
+    }
+
+    std::unique_ptr<trace_stream::Reader> open_input(const std::string& path)
+    {
+        std::string err;
+        auto r = trace_stream::open_reader(path, &err);
+        if (!r) std::fprintf(stderr, "%s\n", err.c_str());
+        return r;
+    }
+
+    bool check_reader(const trace_stream::Reader& r, const std::string& path)
+    {
+        if (r.error().empty()) return true;
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), r.error().c_str());
+        return false;
+    }
+
+    // =============== Commands ===============
+    int cmd_info(const Options& o)
+    {
+        auto in = open_input(o.files[0]);
+        if (!in) return 1;
+        Totals t;
+        uint64_t events = 0, metrics = 0, unordered = 0, last = 0;
+        uint64_t tsMin = UINT64_MAX, tsMax = 0, durMax = 0;
+        std::vector<Record> batch;
+        while (in->read(batch, kBatch))
+        {
+            for (const Record& r : batch)
+            {
+                const uint64_t ts = r.ts();
+                const uint64_t end = r.isMetric ? ts : ts + r.event.dur;
+                if (r.isMetric) ++metrics;
+                else { ++events; durMax = std::max(durMax, r.event.dur); }
+                if (ts < last) ++unordered;
+                last = ts;
+                tsMin = std::min(tsMin, ts);
+                tsMax = std::max(tsMax, end);
+            }
+            t.read += batch.size();
+            batch.clear();
+        }
+        if (!check_reader(*in, o.files[0])) return 1;
+
+        std::printf("events     %llu\n", (unsigned long long)events);
+        std::printf("metrics    %llu\n", (unsigned long long)metrics);
+        if (t.read)
+        {
+            std::printf("ts         %llu .. %llu (%.3f s)\n", (unsigned long long)tsMin, (unsigned long long)tsMax, double(tsMax - tsMin) / 1e6);
+            std::printf("max dur    %llu us\n", (unsigned long long)durMax);
+            std::printf("unordered  %llu (records older than the previous one)\n", (unsigned long long)unordered);
+        }
+        report(t, o.files);
+        return 0;
+    }
+
+    // convert / slice / filter: one pass, input order preserved
+    int cmd_copy(const Options& o)
+    {
+        auto in = open_input(o.files[0]);
+        if (!in) return 1;
+        auto out = open_output(o, o.files[1]);
+        if (!out) return 1;
+        Totals t;
+        std::vector<Record> batch;
+        while (in->read(batch, kBatch))
+        {
+            t.read += batch.size();
+            for (const Record& r : batch)
+            {
+                if (!keep(o, r)) continue;
+                if (!out->write(r)) { std::fprintf(stderr, "%s: write error\n", o.files[1].c_str()); return 1; }
+                ++t.written;
+            }
+            batch.clear();
+        }
+        const bool ok = check_reader(*in, o.files[0]);
+        if (!out->finish()) { std::fprintf(stderr, "%s: write error\n", o.files[1].c_str()); return 1; }
+        report(t, { o.files[0] });
+        return ok ? 0 : 1;
+    }
+
+    // ---------- merge ----------
+    // One input sorted through a bounded min-heap (the reorder window).
+    class SortedInput
+    {
+    public:
+        SortedInput(std::unique_ptr<trace_stream::Reader> reader, const Options& o, Totals& t)
+            : _reader(std::move(reader)), _opt(o), _totals(t) {}
+
+        // Appends up to n records in ts order; false once drained.
+        bool pull(std::vector<Record>& out, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                fill_();
+                if (_heap.empty())
+                    return i > 0;
+                std::pop_heap(_heap.begin(), _heap.end(), later);
+                Record& r = _heap.back();
+                if (r.ts() < _last) ++_totals.late;
+                _last = std::max(_last, r.ts());
+                out.push_back(std::move(r));
+                _heap.pop_back();
+            }
+            return true;
+        }
+
+        const trace_stream::Reader& reader() const { return *_reader; }
+
+    private:
+        static bool later(const Record& a, const Record& b) { return a.ts() > b.ts(); }
+
+        void fill_()
+        {
+            while (!_eof && _heap.size() < _opt.window)
+            {
+                if (_pos == _batch.size())
+                {
+                    _batch.clear();
+                    _pos = 0;
+                    if (!_reader->read(_batch, kBatch)) { _eof = true; break; }
+                    _totals.read += _batch.size();
+                }
+                Record& r = _batch[_pos++];
+                if (!keep(_opt, r)) continue;
+                _heap.push_back(std::move(r));
+                std::push_heap(_heap.begin(), _heap.end(), later);
+            }
+        }
+
+    private:
+        std::unique_ptr<trace_stream::Reader> _reader;
+        const Options& _opt;
+        Totals& _totals;
+        std::vector<Record> _batch;
+        size_t _pos = 0;
+        std::vector<Record> _heap;
+        uint64_t _last = 0;
+        bool _eof = false;
+    };
+
+    // Watermark rounds: every input holds a sorted chunk; everything at or below the
+    // smallest chunk maximum is complete across inputs, so those prefixes are k-way merged
+    // and written, and the input(s) that set the watermark are refilled.
+    int cmd_merge(const Options& o)
+    {
+        const std::string& outPath = o.files[0];
+        const std::vector<std::string> inputs(o.files.begin() + 1, o.files.end());
+        auto out = open_output(o, outPath);
+        if (!out) return 1;
+
+        Totals t;
+        const size_t k = inputs.size();
+        std::vector<SortedInput> src;
+        src.reserve(k);
+        for (const std::string& path : inputs)
+        {
+            auto r = open_input(path);
+            if (!r) return 1;
+            src.emplace_back(std::move(r), o, t);
+        }
+
+        std::vector<std::vector<Record>> chunk(k), runs(k);
+        std::vector<size_t> head(k, 0);
+        std::vector<uint64_t> chunkMax(k, 0);
+        std::vector<bool> drained(k, false);
+        std::vector<Record> merged;
+
+        auto refill = [&](size_t i) {
+            chunk[i].erase(chunk[i].begin(), chunk[i].begin() + ptrdiff_t(head[i]));
+            head[i] = 0;
+            if (!chunk[i].empty() || drained[i]) return;
+            if (!src[i].pull(chunk[i], kBatch)) drained[i] = true;
+            chunkMax[i] = 0;
+            for (const Record& r : chunk[i]) chunkMax[i] = std::max(chunkMax[i], r.ts());
+        };
+        for (size_t i = 0; i < k; ++i) refill(i);
+
+        for (;;)
+        {
+            uint64_t watermark = UINT64_MAX;
+            bool any = false;
+            for (size_t i = 0; i < k; ++i)
+            {
+                if (head[i] < chunk[i].size()) any = true;
+                if (!drained[i]) watermark = std::min(watermark, chunkMax[i]);
+            }
+            if (!any) break;
+
+            for (size_t i = 0; i < k; ++i)
+            {
+                size_t& h = head[i];
+                while (h < chunk[i].size() && chunk[i][h].ts() <= watermark)
+                    runs[i].push_back(std::move(chunk[i][h++]));
+            }
+            merged.clear();
+            kway_merge(runs, merged, [](const Record& r) { return r.ts(); });
+            for (const Record& r : merged)
+            {
+                if (!out->write(r)) { std::fprintf(stderr, "%s: write error\n", outPath.c_str()); return 1; }
+            }
+            t.written += merged.size();
+            for (size_t i = 0; i < k; ++i) refill(i);
+        }
+
+        bool ok = true;
+        for (size_t i = 0; i < k; ++i) ok &= check_reader(src[i].reader(), inputs[i]);
+        if (!out->finish()) { std::fprintf(stderr, "%s: write error\n", outPath.c_str()); return 1; }
+        report(t, inputs);
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parse_args(argc, argv, opt))
+    {
+        usage();
+        return 2;
+    }
+    if (opt.command == "info") return cmd_info(opt);
+    if (opt.command == "merge") return cmd_merge(opt);
+    return cmd_copy(opt);
+}